@@ -0,0 +1,392 @@
+/*
+Twelve Snakes - on console benchmarks
+*/
+
+#include <jo/jo.h>
+#include "bench.h"
+#include "fmt.h"
+#include "slave.h"
+#include "textplane.h"
+#include "world.h"
+
+// screen helpers from main.c
+struct world;
+void pressStart(struct world* world);
+void clearScreen();
+
+// SH-2 free running timer. SGL owns its configuration so we only read it,
+// apart from clearing the overflow flag to see wraps.
+// FRC must be read high byte first, that latches the low byte.
+#define FRT_FTCSR (*(volatile Uint8*)0xFFFFFE11)
+#define FRT_FRC_H (*(volatile Uint8*)0xFFFFFE12)
+#define FRT_FRC_L (*(volatile Uint8*)0xFFFFFE13)
+#define FRT_TCR   (*(volatile Uint8*)0xFFFFFE16)
+#define FTCSR_OVF 0x02 // FRC went from 0xFFFF to 0, cleared by writing 0 after reading 1
+
+// number of calls timed between FRC reads, small enough that the 16-bit
+// counter can't wrap even at the fastest FRT clock
+#define BENCH_BATCH 8
+#define BENCH_ITERATIONS 256
+
+unsigned int benchReadTimer()
+{
+    unsigned int high = FRT_FRC_H;
+    unsigned int low = FRT_FRC_L;
+
+    return (high << 8) | low;
+}
+
+// CPU cycles per FRC tick, from the clock select bits
+unsigned int benchTimerDivider()
+{
+    switch(FRT_TCR & 3)
+    {
+        case 0:
+            return 8;
+        case 1:
+            return 32;
+        default:
+            return 128;
+    }
+}
+
+// the count is read before the flag is cleared, so a wrap in between is
+// left to the count rather than counted twice
+unsigned int benchStartTimer()
+{
+    unsigned int start = benchReadTimer();
+    Uint8 flags = FRT_FTCSR;
+
+    // writing 1 leaves the other flags as they are
+    FRT_FTCSR = flags & ~FTCSR_OVF;
+    return start;
+}
+
+unsigned int benchCyclesSince(unsigned int start)
+{
+    unsigned int end = benchReadTimer();
+    unsigned int ticks = (end - start) & 0xFFFF;
+
+    // wrapped and came round past start: the count misses a whole lap
+    if((FRT_FTCSR & FTCSR_OVF) != 0 && end >= start)
+    {
+        ticks += 0x10000;
+    }
+
+    return ticks * benchTimerDivider();
+}
+
+unsigned int benchCyclesPerCall(benchFunction function, int iterations)
+{
+    unsigned int ticks = 0;
+
+    for(int i = 0; i < iterations; i += BENCH_BATCH)
+    {
+        unsigned int start = benchReadTimer();
+
+        for(int j = 0; j < BENCH_BATCH; j++)
+        {
+            function(i + j);
+        }
+
+        ticks += (benchReadTimer() - start) & 0xFFFF;
+    }
+
+    return ticks * benchTimerDivider() / iterations;
+}
+
+//
+// Text formatting: the exact formats the HUD and score screen use,
+// sprintf versus the fmt writers
+//
+
+static char g_BenchLine[64];
+static const char g_BenchShape = (char)149;
+
+static void sprintfScoreBar(int i)
+{
+    sprintf(g_BenchLine, "%s %03i", "FFA", i % 1000);
+}
+
+static void fmtScoreBar(int i)
+{
+    char* p = fmtString(g_BenchLine, "FFA ");
+    fmtDecimal(p, i % 1000, 3, '0');
+}
+
+static void sprintfTimer(int i)
+{
+    sprintf(g_BenchLine, " %02i:%02i", i / 60, i % 60);
+}
+
+static void fmtTimer(int i)
+{
+    char* p = fmtString(g_BenchLine, " ");
+    fmtClock(p, i);
+}
+
+static void sprintfGlyph(int i)
+{
+    sprintf(g_BenchLine, "%c", g_BenchShape + (i & 7));
+}
+
+static void fmtGlyph(int i)
+{
+    fmtRepeat(g_BenchLine, g_BenchShape + (i & 7), 1);
+}
+
+static void sprintfSlowdown(int i)
+{
+    sprintf(g_BenchLine, "SD %1i", i % 10);
+}
+
+static void fmtSlowdown(int i)
+{
+    char* p = fmtString(g_BenchLine, "SD ");
+    fmtDecimal(p, i % 10, 1, ' ');
+}
+
+static void sprintfTopFour(int i)
+{
+    sprintf(g_BenchLine, "%c%c%c %03i", g_BenchShape, g_BenchShape, g_BenchShape, i - 99);
+}
+
+static void fmtTopFour(int i)
+{
+    char* p = fmtRepeat(g_BenchLine, g_BenchShape, 3);
+    p = fmtString(p, " ");
+    fmtDecimal(p, i - 99, 3, '0');
+}
+
+static void sprintfScoreRow(int i)
+{
+    sprintf(g_BenchLine, "%2i %c%c%c %3i %3i %3i %3i %3i %3i %3i", (i % 12) + 1, g_BenchShape, g_BenchShape, g_BenchShape,
+                                                                   i, i + 7, i / 2, i % 13, i % 3, i % 17, i - 50);
+}
+
+static void fmtScoreRow(int i)
+{
+    int columns[7] = {i, i + 7, i / 2, i % 13, i % 3, i % 17, i - 50};
+    char* p = fmtDecimal(g_BenchLine, (i % 12) + 1, 2, ' ');
+
+    p = fmtString(p, " ");
+    p = fmtRepeat(p, g_BenchShape, 3);
+    for(int j = 0; j < 7; j++)
+    {
+        p = fmtString(p, " ");
+        p = fmtDecimal(p, columns[j], 3, ' ');
+    }
+}
+
+//
+// Text plane: gameplay cell updates through slPrint(slLocate()) one at a
+// time versus queued with textPlanePut() and written by textPlaneFlush()
+//
+
+#define BENCH_SNAKES 12
+#define BENCH_ERASE_CELLS 48
+
+static char g_BenchSnake[2] = {(char)149, '\0'};
+
+// a gameplay tick with twelve snakes: every snake erases its tail and draws
+// its new head, then the food moves
+static void slPrintSnakeTick(int i)
+{
+    for(int p = 0; p < BENCH_SNAKES; p++)
+    {
+        int x = 2 + ((i + p) % 34);
+        int y = 7 + p;
+
+        slPrint(" ", slLocate(x, y));
+        slPrint(g_BenchSnake, slLocate(x + 1, y));
+    }
+
+    slPrint("*", slLocate(2 + (i % 36), 20));
+}
+
+static void queuedSnakeTick(int i)
+{
+    for(int p = 0; p < BENCH_SNAKES; p++)
+    {
+        int x = 2 + ((i + p) % 34);
+        int y = 7 + p;
+
+        textPlanePut(x, y, ' ');
+        textPlanePut(x + 1, y, g_BenchSnake[0]);
+    }
+
+    textPlanePut(2 + (i % 36), 20, '*');
+    textPlaneFlush();
+}
+
+// eraseSnake() on a dead snake
+static void slPrintErase(int i)
+{
+    for(int c = 0; c < BENCH_ERASE_CELLS; c++)
+    {
+        slPrint(" ", slLocate(2 + ((i + c) % 36), 7 + (c % 17)));
+    }
+}
+
+static void queuedErase(int i)
+{
+    for(int c = 0; c < BENCH_ERASE_CELLS; c++)
+    {
+        textPlanePut(2 + ((i + c) % 36), 7 + (c % 17), ' ');
+    }
+
+    textPlaneFlush();
+}
+
+//
+// Collisions: worldDetect() on the master versus handed to the slave SH-2
+// and waited for, on a board busy with snakes
+//
+
+#define BENCH_WORLD_TICKS 300
+
+static struct world g_BenchWorld;
+static struct collisions g_MasterCollisions;
+static struct collisions g_SlaveCollisions;
+
+// every player joins and turns every few ticks, a different way each
+static void benchWorldSetup()
+{
+    unsigned char controls[MAX_PLAYERS];
+
+    worldReset(&g_BenchWorld);
+    g_BenchWorld.options.gameType = GAME_FREE_FOR_ALL;
+    worldStart(&g_BenchWorld);
+
+    for(int tick = 0; tick < BENCH_WORLD_TICKS; tick++)
+    {
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            controls[i] = CONTROL_JOIN;
+            if((tick + i) % 5 == 0)
+            {
+                controls[i] |= CONTROL_TURN | ((tick / 5 + i) & CONTROL_DIR);
+            }
+        }
+
+        worldStep(&g_BenchWorld, controls);
+    }
+}
+
+static void masterDetect(int i)
+{
+    (void)i;
+    worldDetect(&g_BenchWorld, &g_MasterCollisions);
+}
+
+static void slaveDetect(int i)
+{
+    (void)i;
+    slaveStartDetect(&g_BenchWorld, &g_SlaveCollisions);
+    slaveWaitDetect(&g_BenchWorld, &g_SlaveCollisions);
+}
+
+struct bench_pair
+{
+    const char* name;
+    benchFunction baseline;
+    benchFunction candidate;
+};
+
+struct bench_result
+{
+    unsigned int baseline;
+    unsigned int candidate;
+};
+
+static const struct bench_pair g_FormatBenchmarks[] =
+{
+    {"%s %03i     ", sprintfScoreBar, fmtScoreBar},
+    {" %02i:%02i  ", sprintfTimer,    fmtTimer},
+    {"%c          ", sprintfGlyph,    fmtGlyph},
+    {"SD %1i      ", sprintfSlowdown, fmtSlowdown},
+    {"%c%c%c %03i ", sprintfTopFour,  fmtTopFour},
+    {"score row   ", sprintfScoreRow, fmtScoreRow},
+};
+
+static const struct bench_pair g_TextPlaneBenchmarks[] =
+{
+    {"12 snakes   ", slPrintSnakeTick, queuedSnakeTick},
+    {"erase 48    ", slPrintErase,     queuedErase},
+};
+
+static const struct bench_pair g_SlaveBenchmarks[] =
+{
+    {"collisions  ", masterDetect, slaveDetect},
+};
+
+#define NUM_FORMAT_BENCHMARKS (sizeof(g_FormatBenchmarks) / sizeof(g_FormatBenchmarks[0]))
+#define NUM_TEXT_PLANE_BENCHMARKS (sizeof(g_TextPlaneBenchmarks) / sizeof(g_TextPlaneBenchmarks[0]))
+#define NUM_SLAVE_BENCHMARKS (sizeof(g_SlaveBenchmarks) / sizeof(g_SlaveBenchmarks[0]))
+
+static void runPairs(const struct bench_pair* pairs, int numPairs, struct bench_result* results)
+{
+    for(int i = 0; i < numPairs; i++)
+    {
+        results[i].baseline = benchCyclesPerCall(pairs[i].baseline, BENCH_ITERATIONS);
+        results[i].candidate = benchCyclesPerCall(pairs[i].candidate, BENCH_ITERATIONS);
+    }
+}
+
+static int displayPairs(const char* title, const char* baselineName, const char* candidateName,
+                        const struct bench_pair* pairs, const struct bench_result* results, int numPairs, int row)
+{
+    char line[48];
+    char* p = NULL;
+
+    slPrint((char*)title, slLocate(2, row++));
+
+    p = fmtString(line, "             ");
+    p = fmtString(p, baselineName);
+    p = fmtString(p, " ");
+    fmtString(p, candidateName);
+    slPrint(line, slLocate(2, row++));
+
+    for(int i = 0; i < numPairs; i++)
+    {
+        p = fmtString(line, pairs[i].name);
+        p = fmtString(p, " ");
+        p = fmtDecimal(p, (int)results[i].baseline, 7, ' ');
+        p = fmtString(p, " ");
+        fmtDecimal(p, (int)results[i].candidate, 7, ' ');
+        slPrint(line, slLocate(2, row++));
+    }
+
+    return row;
+}
+
+void displayBenchmarks()
+{
+    struct bench_result formatResults[NUM_FORMAT_BENCHMARKS];
+    struct bench_result textPlaneResults[NUM_TEXT_PLANE_BENCHMARKS];
+    struct bench_result slaveResults[NUM_SLAVE_BENCHMARKS];
+    int slaveAgrees = 0;
+    int row = 8;
+
+    // the text plane cases draw over the playing field, run everything
+    // before showing the results
+    runPairs(g_FormatBenchmarks, NUM_FORMAT_BENCHMARKS, formatResults);
+    runPairs(g_TextPlaneBenchmarks, NUM_TEXT_PLANE_BENCHMARKS, textPlaneResults);
+
+    benchWorldSetup();
+    runPairs(g_SlaveBenchmarks, NUM_SLAVE_BENCHMARKS, slaveResults);
+    slaveAgrees = memcmp(&g_MasterCollisions, &g_SlaveCollisions, sizeof(g_MasterCollisions)) == 0;
+    worldReset(&g_BenchWorld); // frees the snakes
+    clearScreen();
+
+    row = displayPairs("Text formatting, cycles per call", "sprintf", "    fmt",
+                       g_FormatBenchmarks, formatResults, NUM_FORMAT_BENCHMARKS, row);
+    row = displayPairs("Text plane, cycles per frame", "slPrint", " queued",
+                       g_TextPlaneBenchmarks, textPlaneResults, NUM_TEXT_PLANE_BENCHMARKS, row + 1);
+    row = displayPairs("Slave SH-2, cycles per tick", " master", "  slave",
+                       g_SlaveBenchmarks, slaveResults, NUM_SLAVE_BENCHMARKS, row + 1);
+    slPrint(slaveAgrees == 1 ? "slave agrees with master" : "SLAVE DISAGREES WITH MASTER", slLocate(2, row));
+
+    pressStart(NULL);
+    clearScreen();
+}
@@ -0,0 +1,27 @@
+/*
+Twelve Snakes - on console benchmarks
+
+Hold L+R on player one's controller while the SSMTF logo is up to show the
+benchmark screen before the title. Timings come from the SH-2 free running
+timer (FRT) and are reported in CPU cycles per call, so the numbers do not
+depend on the video mode's clock.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+typedef void (*benchFunction)(int iteration);
+
+unsigned int benchReadTimer(); // FRT count, 16 bits, wraps after a frame or more
+unsigned int benchTimerDivider(); // CPU cycles per FRT count
+
+// times something that may run longer than the counter takes to wrap:
+// benchStartTimer() before it, benchCyclesSince() with what it returned
+// after. A wrap the count alone doesn't show is counted as one whole lap, so
+// a long run reads as at least as long as it was, never as short.
+unsigned int benchStartTimer();
+unsigned int benchCyclesSince(unsigned int start);
+unsigned int benchCyclesPerCall(benchFunction function, int iterations);
+void displayBenchmarks();
+
+#endif
@@ -0,0 +1,115 @@
+/*
+Twelve Snakes - the board as one bit per cell
+*/
+
+#include "bitboard.h"
+
+void bitboardInit(struct bitboard* bits)
+{
+    memset(bits, 0, sizeof(*bits));
+
+    for(int y = 0; y < BOARD_HEIGHT; y++)
+    {
+        bits->walls[y] = ~(bitrow)0;
+
+        if(y >= MIN_Y && y <= MAX_Y)
+        {
+            bits->walls[y] = ~ARENA_ROW;
+        }
+    }
+}
+
+void bitboardAddPit(struct bitboard* bits, int x, int y)
+{
+    BIT_CLEAR(bits->walls, x, y);
+    BIT_SET(bits->pits, x, y);
+}
+
+// Spreads the cells in reach along the runs of open cells they are in, both
+// ways. Each step doubles how far it reaches, so six steps cover a row.
+static bitrow fillRow(bitrow reach, bitrow open)
+{
+    bitrow up = reach & open;
+    bitrow down = up;
+    bitrow upOpen = open;
+    bitrow downOpen = open;
+
+    for(int shift = 1; shift < 64; shift <<= 1)
+    {
+        up |= upOpen & (up << shift);
+        upOpen &= upOpen << shift;
+
+        down |= downOpen & (down >> shift);
+        downOpen &= downOpen >> shift;
+    }
+
+    return up | down;
+}
+
+static int countBits(bitrow row)
+{
+    return __builtin_popcountll(row);
+}
+
+//
+// Fills row by row, sweeping down the arena and back up until nothing
+// changes. Each sweep carries the fill through every row it can go down (or
+// up) into, so it takes one pass per bend in the region, not one per cell.
+//
+int bitboardReachable(const struct bitboard* bits, int x, int y)
+{
+    bitrow open[BOARD_HEIGHT] = {0};
+    bitrow reach[BOARD_HEIGHT] = {0};
+    int changed = 1;
+    int count = 0;
+    int row = 0;
+
+    if(x < 0 || x >= BOARD_WIDTH || y < 1 || y >= BOARD_HEIGHT - 1)
+    {
+        return 0;
+    }
+
+    for(row = MIN_Y; row <= MAX_Y; row++)
+    {
+        open[row] = ARENA_ROW & ~(bits->bodies[row] | bits->suddenDeath[row]);
+    }
+
+    // the cell and the ones next to it, a head is on a body cell itself
+    reach[y] = (BIT_AT(x) | (BIT_AT(x) << 1) | (BIT_AT(x) >> 1)) & open[y];
+    reach[y - 1] = BIT_AT(x) & open[y - 1];
+    reach[y + 1] = BIT_AT(x) & open[y + 1];
+
+    while(changed == 1)
+    {
+        changed = 0;
+
+        for(row = MIN_Y; row <= MAX_Y; row++)
+        {
+            bitrow grown = fillRow(reach[row] | (reach[row - 1] & open[row]), open[row]);
+
+            if(grown != reach[row])
+            {
+                reach[row] = grown;
+                changed = 1;
+            }
+        }
+
+        for(row = MAX_Y; row >= MIN_Y; row--)
+        {
+            bitrow grown = fillRow(reach[row] | (reach[row + 1] & open[row]), open[row]);
+
+            if(grown != reach[row])
+            {
+                reach[row] = grown;
+                changed = 1;
+            }
+        }
+    }
+
+    for(row = MIN_Y; row <= MAX_Y; row++)
+    {
+        count += countBits(reach[row]);
+    }
+
+    return count;
+}
@@ -0,0 +1,49 @@
+/*
+Twelve Snakes - the board as one bit per cell
+
+Every row of the board fits in a 64-bit word, so asking whether a cell is a
+wall, a body, food or closed off by sudden death is a shift and a mask, and
+a flood fill moves a whole row of cells per word operation. world.c keeps
+these masks next to the owner board: the masks say whether anything is in a
+cell, the owner board is only read after a hit to find out whose it is.
+
+No Saturn dependencies. On the SH-2 a 64-bit row is a pair of registers.
+*/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "game.h"
+
+#if BOARD_WIDTH > 64
+#error "a board row has to fit in a bitrow"
+#endif
+
+typedef unsigned long long bitrow;
+
+#define BIT_AT(x) ((bitrow)1 << (x))
+#define BIT_TEST(rows, x, y) (((rows)[y] >> (x)) & 1)
+#define BIT_SET(rows, x, y) ((rows)[y] |= BIT_AT(x))
+#define BIT_CLEAR(rows, x, y) ((rows)[y] &= ~BIT_AT(x))
+
+// the arena's columns in a row
+#define ARENA_ROW ((BIT_AT(ARENA_WIDTH) - 1) << MIN_X)
+
+struct bitboard
+{
+    bitrow walls[BOARD_HEIGHT]; // every cell outside the arena except the pits
+    bitrow pits[BOARD_HEIGHT];
+    bitrow bodies[BOARD_HEIGHT]; // same cells as the owner board
+    bitrow food[BOARD_HEIGHT];
+    bitrow suddenDeath[BOARD_HEIGHT];
+};
+
+void bitboardInit(struct bitboard* bits); // walls all the way round, nothing else
+void bitboardAddPit(struct bitboard* bits, int x, int y); // opens the wall at x, y
+
+// free cells, in the arena and not a body or sudden death, connected to x, y.
+// x, y itself counts if it's free, so from a snake's head it's the room the
+// snake has left.
+int bitboardReachable(const struct bitboard* bits, int x, int y);
+
+#endif
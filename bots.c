@@ -0,0 +1,71 @@
+/*
+Twelve Snakes - CPU snakes
+*/
+
+#include <jo/jo.h>
+#include "bots.h"
+#include "search.h"
+#include "slave.h"
+
+// a cap for the SH-2, at low slowdowns the master stops the search first
+#define BOTS_ITERATIONS 48
+#define BOTS_DEPTH 6
+#define BOTS_NODES (BOTS_ITERATIONS + 1) // an iteration adds at most one node
+#define BOTS_TABLE 256
+
+static struct search g_BotSearch;
+static struct search_node g_BotNodes[BOTS_NODES];
+static struct search_entry g_BotTable[BOTS_TABLE];
+static unsigned char g_BotControls[MAX_PLAYERS];
+static int g_BotFirst = 0; // planned first this tick
+
+static int botsStopped(void* unused)
+{
+    (void)unused;
+
+    return slaveStopping();
+}
+
+void botsReset(struct world* world)
+{
+    (void)world;
+
+    // the bots' own random numbers, rand() belongs to the master
+    searchInit(&g_BotSearch, g_BotNodes, BOTS_NODES, (unsigned int)rand());
+    searchTable(&g_BotSearch, g_BotTable, BOTS_TABLE);
+    memset(g_BotControls, CONTROL_JOIN, sizeof(g_BotControls));
+    g_BotFirst = 0;
+}
+
+void botsPlan(void* arg)
+{
+    struct world* world = (struct world*)arg;
+    struct search_limits limits = {BOTS_ITERATIONS, BOTS_DEPTH, botsStopped, NULL};
+    int bots = world->options.bots;
+
+    if(bots == 0)
+    {
+        return;
+    }
+
+    searchLoad(&g_BotSearch.board, world);
+    for(int k = 0; k < bots; k++)
+    {
+        int player = MAX_PLAYERS - 1 - (g_BotFirst + k) % bots;
+
+        g_BotControls[player] = searchControl(&g_BotSearch, player, &limits);
+    }
+
+    g_BotFirst = (g_BotFirst + 1) % bots;
+}
+
+void botsControls(struct world* world, unsigned char* controls)
+{
+    // the slave wrote them
+    slaveCachePurge(g_BotControls, sizeof(g_BotControls));
+
+    for(int k = 0; k < world->options.bots; k++)
+    {
+        controls[MAX_PLAYERS - 1 - k] = g_BotControls[MAX_PLAYERS - 1 - k];
+    }
+}
@@ -0,0 +1,25 @@
+/*
+Twelve Snakes - CPU snakes
+
+Fills the last player slots with snakes that pick their moves with search.h.
+Each tick's moves are planned during the tick before it: botsPlan() runs on
+the slave SH-2 while the master draws and waits out the slowdown frames, and
+searches until the master stops it at the start of the next tick or the bots
+run out of iterations. Bots are planned in a different order every tick so
+the one planned last isn't always the one that gets stopped early.
+
+The bots decide a tick from the board before it, so they play the same
+whatever the other CPU was doing. They are off in link play, where the other
+console couldn't know what they were going to do.
+*/
+
+#ifndef BOTS_H
+#define BOTS_H
+
+struct world;
+
+void botsReset(struct world* world); // new match, after the options are picked
+void botsPlan(void* world); // a slaveJob, plans the next tick for world->options.bots bots
+void botsControls(struct world* world, unsigned char* controls); // the planned moves, once botsPlan() is done
+
+#endif
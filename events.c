@@ -0,0 +1,112 @@
+/*
+Twelve Snakes - per tick match events
+*/
+
+#include "events.h"
+
+// The producer writes the event and then publishes head. A reader copies the
+// event and then checks head again to see if the slot was reused meanwhile.
+// An SH-2 neither reorders memory accesses nor buffers writes, so keeping the
+// compiler from reordering is enough there. What it does have is a cache the
+// other CPU doesn't see: readers go through the cache-through mirror of the
+// ring, the way slave.c reads its handoff, so a reader on the slave never
+// sees its own stale copy. The caches write through, so the producer's
+// writes are in memory by then.
+#if defined(__sh__)
+#define EVENT_FENCE() __asm__ __volatile__("" ::: "memory")
+#define EVENT_MIRROR(ring) ((struct event_ring*)((unsigned long)(ring) | 0x20000000))
+#else
+#define EVENT_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define EVENT_MIRROR(ring) (ring)
+#endif
+
+struct event_ring g_Events;
+
+void eventsReset()
+{
+    // head keeps counting so readers from an earlier match stay valid
+    g_Events.tick = 0;
+}
+
+void eventsSetTick(unsigned int tick)
+{
+    eventRingSetTick(&g_Events, tick);
+}
+
+void emitEvent(int type, int player, int other, int x, int y)
+{
+    eventRingEmit(&g_Events, type, player, other, x, y);
+}
+
+void eventReaderInit(struct event_reader* reader)
+{
+    eventRingReaderInit(&g_Events, reader);
+}
+
+int eventRead(struct event_reader* reader, struct game_event* event)
+{
+    return eventRingRead(&g_Events, reader, event);
+}
+
+void eventRingSetTick(struct event_ring* ring, unsigned int tick)
+{
+    ring->tick = tick;
+}
+
+void eventRingEmit(struct event_ring* ring, int type, int player, int other, int x, int y)
+{
+    unsigned int head = ring->head;
+    struct game_event* event = &ring->events[head % EVENT_RING_SIZE];
+
+    event->tick = ring->tick;
+    event->type = (unsigned char)type;
+    event->player = (unsigned char)player;
+    event->other = (unsigned char)other;
+    event->x = (unsigned char)x;
+    event->y = (unsigned char)y;
+
+    EVENT_FENCE();
+    ring->head = head + 1;
+}
+
+void eventRingReaderInit(struct event_ring* ring, struct event_reader* reader)
+{
+    reader->next = EVENT_MIRROR(ring)->head;
+    reader->missed = 0;
+}
+
+int eventRingRead(struct event_ring* ring, struct event_reader* reader, struct game_event* event)
+{
+    unsigned int head = 0;
+
+    ring = EVENT_MIRROR(ring);
+    do
+    {
+        head = ring->head;
+        EVENT_FENCE();
+
+        if(reader->next == head)
+        {
+            return 0;
+        }
+
+        // lapped, skip to the oldest event that is safe to read. The slot
+        // of event head - EVENT_RING_SIZE is the one being written next.
+        if(head - reader->next >= EVENT_RING_SIZE)
+        {
+            reader->missed += head - reader->next - (EVENT_RING_SIZE - 1);
+            reader->next = head - (EVENT_RING_SIZE - 1);
+        }
+
+        *event = ring->events[reader->next % EVENT_RING_SIZE];
+        EVENT_FENCE();
+
+        // the producer didn't start reusing the slot during the copy
+        if(ring->head - reader->next < EVENT_RING_SIZE)
+        {
+            reader->next++;
+            return 1;
+        }
+
+    }while(1);
+}
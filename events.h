@@ -0,0 +1,72 @@
+/*
+Twelve Snakes - per tick match events
+
+The rules emit a fixed size record for everything that happens in a match
+into a ring. The game never waits on whoever is reading: each reader keeps
+its own position, and a reader that falls more than EVENT_RING_SIZE events
+behind skips ahead and counts what it missed.
+
+One producer (the game loop), any number of readers. Readers may run on
+another thread or CPU, the slave SH-2 included: on the Saturn they read the
+ring through the cache-through mirror. A read that races with the producer
+overwriting the same slot is detected and dropped instead of returned torn.
+
+No Saturn dependencies, the host tools read the same records.
+*/
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#define EVENT_RING_SIZE 256 // power of two
+
+#define EVENT_SPAWN             1 // player spawned at x, y
+#define EVENT_APPLE             2 // player ate the apple at x, y
+#define EVENT_KILL              3 // player ran into other
+#define EVENT_EATEN             4 // player ate other head on
+#define EVENT_DEATH             5 // player died with its head at x, y
+#define EVENT_SUDDEN_DEATH_CELL 6 // x, y closed off, player is EVENT_NO_PLAYER
+#define EVENT_MODE_END          7 // player is the leader, other the game type
+
+#define EVENT_NO_PLAYER 0xFF
+
+struct game_event
+{
+    unsigned int tick;
+    unsigned char type;
+    unsigned char player;
+    unsigned char other;
+    unsigned char x;
+    unsigned char y;
+    unsigned char reserved[3];
+};
+
+struct event_ring
+{
+    volatile unsigned int head; // events ever emitted, the next one goes at head % EVENT_RING_SIZE
+    unsigned int tick; // stamped on emitted events
+    struct game_event events[EVENT_RING_SIZE];
+};
+
+struct event_reader
+{
+    unsigned int next; // position of the next event to read
+    unsigned int missed; // events overwritten before this reader got to them
+};
+
+extern struct event_ring g_Events;
+
+void eventsReset(); // start of a match
+void eventsSetTick(unsigned int tick);
+void emitEvent(int type, int player, int other, int x, int y);
+
+void eventReaderInit(struct event_reader* reader); // reads from the next event emitted
+int eventRead(struct event_reader* reader, struct game_event* event); // 1 if an event was copied
+
+// the same on a ring of its own, for matches that don't emit into g_Events
+// (see struct world)
+void eventRingSetTick(struct event_ring* ring, unsigned int tick);
+void eventRingEmit(struct event_ring* ring, int type, int player, int other, int x, int y);
+void eventRingReaderInit(struct event_ring* ring, struct event_reader* reader);
+int eventRingRead(struct event_ring* ring, struct event_reader* reader, struct game_event* event);
+
+#endif
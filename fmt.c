@@ -0,0 +1,128 @@
+/*
+Twelve Snakes - fixed format text writers
+*/
+
+#include "fmt.h"
+
+// Divide by ten. The SH-2 has no single cycle divide and gcc calls out to a
+// slow library routine for "/", but everything the HUD shows fits in the range
+// where a multiply by the reciprocal is exact.
+#define DIV10_EXACT_LIMIT 81920u
+#define DIV60_EXACT_LIMIT 74939u
+
+static unsigned int divTen(unsigned int value)
+{
+    if(value < DIV10_EXACT_LIMIT)
+    {
+        return (value * 52429u) >> 19;
+    }
+
+    return value / 10;
+}
+
+static unsigned int divSixty(unsigned int value)
+{
+    if(value < DIV60_EXACT_LIMIT)
+    {
+        return (value * 34953u) >> 21;
+    }
+
+    return value / 60;
+}
+
+char* fmtDecimal(char* out, int value, int width, char pad)
+{
+    char digits[FMT_DECIMAL_MAX];
+    int numDigits = 0;
+    int negative = 0;
+    int length = 0;
+    unsigned int magnitude = 0;
+
+    if(value < 0)
+    {
+        negative = 1;
+        magnitude = 0u - (unsigned int)value;
+    }
+    else
+    {
+        magnitude = (unsigned int)value;
+    }
+
+    // digits come out least significant first
+    do
+    {
+        unsigned int quotient = divTen(magnitude);
+        digits[numDigits++] = (char)('0' + (magnitude - quotient * 10));
+        magnitude = quotient;
+    }while(magnitude != 0);
+
+    length = numDigits + negative;
+
+    // printf semantics: space padding goes before the sign, zeros after it
+    if(pad != '0')
+    {
+        for(; length < width; length++)
+        {
+            *out++ = pad;
+        }
+    }
+
+    if(negative == 1)
+    {
+        *out++ = '-';
+    }
+
+    if(pad == '0')
+    {
+        for(; length < width; length++)
+        {
+            *out++ = '0';
+        }
+    }
+
+    while(numDigits > 0)
+    {
+        *out++ = digits[--numDigits];
+    }
+
+    *out = '\0';
+    return out;
+}
+
+char* fmtClock(char* out, int seconds)
+{
+    int mins = 0;
+
+    if(seconds < 0)
+    {
+        seconds = 0;
+    }
+
+    mins = (int)divSixty((unsigned int)seconds);
+
+    out = fmtDecimal(out, mins, 2, '0');
+    *out++ = ':';
+    return fmtDecimal(out, seconds - (mins * 60), 2, '0');
+}
+
+char* fmtRepeat(char* out, char glyph, int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        *out++ = glyph;
+    }
+
+    *out = '\0';
+    return out;
+}
+
+char* fmtString(char* out, const char* str)
+{
+    while(*str != '\0')
+    {
+        *out++ = *str++;
+    }
+
+    *out = '\0';
+    return out;
+}
@@ -0,0 +1,26 @@
+/*
+Twelve Snakes - fixed format text writers
+
+Small replacements for the handful of sprintf formats the game uses. newlib's
+sprintf is very slow on the SH-2 and these are called several times a frame.
+
+Every writer appends to "out", NUL terminates, and returns a pointer to the
+terminator so calls can be chained to build up a line:
+
+    char* p = line;
+    p = fmtString(p, "FFA ");
+    p = fmtDecimal(p, score, 3, '0'); // "%03i"
+*/
+
+#ifndef FMT_H
+#define FMT_H
+
+// longest output of fmtDecimal(): sign, 10 digits and the terminator
+#define FMT_DECIMAL_MAX 12
+
+char* fmtDecimal(char* out, int value, int width, char pad); // "%0<width>i" or "%<width>i"
+char* fmtClock(char* out, int seconds); // "%02i:%02i" of minutes and seconds
+char* fmtRepeat(char* out, char glyph, int count); // glyph written count times
+char* fmtString(char* out, const char* str); // "%s"
+
+#endif
@@ -0,0 +1,176 @@
+/*
+Twelve Snakes - game state shared between the modules
+*/
+
+#ifndef GAME_H
+#define GAME_H
+
+// Player count and arena size are fixed at build time, set PLAYERS in the
+// makefile for a 2, 4, 12 or 24 player build, 24 being the default and the
+// only one link play works with. Every per player loop and grid then has a
+// constant size the compiler can unroll and index with constant strides.
+// Headless builds on the host can have up to 254 players.
+#ifndef MAX_PLAYERS
+#define MAX_PLAYERS 24 // two linked consoles
+#endif
+
+#if MAX_PLAYERS < 12
+#define LOCAL_PLAYERS MAX_PLAYERS
+#else
+#define LOCAL_PLAYERS 12 // players on this console, two multitaps
+#endif
+
+// put in front of per player loops. Builds with few players unroll them
+// completely, bigger ones would only grow the code.
+#ifndef UNROLL_PLAYERS_LIMIT
+#define UNROLL_PLAYERS_LIMIT 12
+#endif
+#if defined(__GNUC__) && __GNUC__ >= 8 && MAX_PLAYERS <= UNROLL_PLAYERS_LIMIT
+#define UNROLL_PLAYERS _Pragma("GCC unroll 12")
+#else
+#define UNROLL_PLAYERS
+#endif
+
+#define MIN_SCORE -99
+#define MAX_SCORE 999
+#define MAX_SLOWDOWN 9
+#define MIN_SLOWDOWN 0
+#define INITIAL_SLOWDOWN 5
+#define PORT_TWO 9
+#define DIR_UP 0
+#define DIR_DOWN 1
+#define DIR_RIGHT 2
+#define DIR_LEFT 3
+
+// the arena is the cells snakes move in, the walls go around it
+#ifndef MIN_Y
+#define MIN_Y 7
+#endif
+#ifndef MAX_Y
+#define MAX_Y 23
+#endif
+#ifndef MIN_X
+#define MIN_X 2
+#endif
+#ifndef MAX_X
+#define MAX_X 37
+#endif
+
+#if MIN_X < 2 || MIN_Y < 2 || MAX_X <= MIN_X || MAX_Y <= MIN_Y
+#error "the arena needs room for the walls and pits around it"
+#endif
+
+// 40x30 text screen: walls, pits and the score bar have to fit around it
+#if defined(__sh__) && (MAX_X > 37 || MIN_Y < 7 || MAX_Y > 23)
+#error "the arena doesn't fit on the screen"
+#endif
+
+#define ARENA_WIDTH (MAX_X - MIN_X + 1)
+#define ARENA_HEIGHT (MAX_Y - MIN_Y + 1)
+
+// no snake can grow longer than the arena holds, so growth owed beyond it
+// would never be paid off
+#define MAX_GROWTH (ARENA_WIDTH * ARENA_HEIGHT)
+
+#define MAX_SUDDEN_DEATH_X ARENA_WIDTH
+#define MAX_SUDDEN_DEATH_Y ARENA_HEIGHT
+
+// the arena plus the walls and pits around it, so snakes waiting in the pits
+// are on the board
+#define BOARD_WIDTH (MAX_X + 3)
+#define BOARD_HEIGHT (MAX_Y + 3)
+#define BOARD_EMPTY 0 // otherwise the player index plus one
+
+#define MAX_FOOD 8
+#define PLAYERS_PER_FOOD 3 // one more food item for every this many players
+#define FOOD_NONE 0xFF
+
+#define GAME_FREE_FOR_ALL     0
+#define GAME_SCORE_ATTACK     1
+#define GAME_BATTLE_ROYALE    2
+#define GAME_SURVIVOR         3
+#define GAME_KING_OF_THE_HILL 4
+#define NUM_GAME_TYPES        5
+
+#if defined(__sh__)
+// stdlib function prototypes to keep compiler happy
+void* memcpy(void *dst, const void *src, unsigned int len);
+int rand(void);
+void srand(unsigned int seed);
+void *malloc(unsigned int size);
+void free(void *ptr);
+void *memset(void *s, int c, unsigned int n);
+int strcmp(const char* s1, const char* s2);
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+struct location
+{
+    int x;
+    int y;
+    struct location* next;
+};
+
+struct food_item
+{
+    int x;
+    int y;
+};
+
+// every item on the field, packed at the front of items, and which item is
+// in each cell so a head finds the food it's on with one lookup
+struct food
+{
+    char shape[2]; // The shape of the food
+    int count;
+    struct food_item items[MAX_FOOD];
+    unsigned char cell[BOARD_HEIGHT][BOARD_WIDTH]; // index into items or FOOD_NONE
+};
+
+struct options
+{
+    int gameType;
+    int maxLives;
+    int maxScore;
+    int maxTime;
+    int slowdown; // factor used to adjust the speed of the game
+
+    int startTime; // what time in seconds the game was started
+    int elapsed; // seconds into the match, from the host's clock in link play
+    unsigned int tick; // ticks played this match
+    int linked; // lockstep with a second console, see link.h
+    int bots; // CPU snakes in the last player slots, see bots.h
+    int joinTimeStopped; // no longer allowed to join the game
+    int suddenDeath; // are we in sudden death mode for Battle Royale
+};
+
+struct sudden_death_grid
+{
+    int lastX;
+    int lastY;
+    int count;
+    int dir;
+    char grid[MAX_SUDDEN_DEATH_X][MAX_SUDDEN_DEATH_Y];
+};
+
+// Who a player is and their scores. Only touched when something happens to
+// the player, the state every tick needs is in struct snakes in world.h.
+struct snake
+{
+    int ID; // index into the array of players
+    char shape[2]; // the shape of the snake
+    int everActive; // has the player ever been active?
+
+    // variables for score
+    int numApples;
+    int numDeaths;
+    int numKills;
+    int numPlayersEaten;
+    int currLength;
+    int maxLength;
+    int score;
+};
+
+#endif
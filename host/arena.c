@@ -0,0 +1,163 @@
+/*
+Twelve Snakes - lookahead bots in every slot, deciding in parallel
+
+Runs a free for all with a search bot in each of the first bots player slots
+and works out all of their moves for a tick at once on a pool of threads.
+The world isn't touched while they decide: every decision loads the board
+from it and searches on the thread's own copy, then worldStep() plays the
+moves as it does for the pads.
+
+A decision's random numbers are seeded from the seed, the tick and the
+player, never from what ran before it on the same thread, so the match comes
+out the same for any number of threads. The last line prints the world's
+hash to check that.
+
+    arena [ticks] [threads] [seed] [bots]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../search.h"
+#include "pool.h"
+#include "timer.h"
+
+#define ARENA_ITERATIONS 48
+#define ARENA_DEPTH 6
+#define ARENA_NODES (ARENA_ITERATIONS + 1)
+#define ARENA_TABLE 256
+
+// one per thread
+struct arena_scratch
+{
+    struct search search;
+    struct search_node nodes[ARENA_NODES];
+    struct search_entry table[ARENA_TABLE];
+    unsigned int loaded; // tick + 1 the board was loaded for, 0 for none
+};
+
+// what every decision of a tick reads
+struct arena_tick
+{
+    const struct world* world;
+    unsigned int tick;
+    unsigned int seed;
+    unsigned char* controls;
+};
+
+static unsigned int decisionSeed(unsigned int seed, unsigned int tick, int player)
+{
+    unsigned int x = seed * 0x9E3779B1u ^ tick * 0x85EBCA77u ^ (unsigned int)player * 0xC2B2AE3Du;
+
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+
+    return x != 0 ? x : 1;
+}
+
+static void decide(void* context, int player, void* scratch)
+{
+    const struct arena_tick* tick = (const struct arena_tick*)context;
+    struct arena_scratch* arena = (struct arena_scratch*)scratch;
+    struct search_limits limits = {ARENA_ITERATIONS, ARENA_DEPTH, NULL, NULL};
+
+    if(tick->world->snakes->active[player] == 0)
+    {
+        tick->controls[player] = CONTROL_JOIN;
+        return;
+    }
+
+    if(arena->search.nodes == NULL)
+    {
+        searchInit(&arena->search, arena->nodes, ARENA_NODES, 1);
+        searchTable(&arena->search, arena->table, ARENA_TABLE);
+    }
+
+    // every snake on this thread this tick searches from the same board
+    if(arena->loaded != tick->tick + 1)
+    {
+        searchLoad(&arena->search.board, tick->world);
+        arena->loaded = tick->tick + 1;
+    }
+
+    arena->search.random = decisionSeed(tick->seed, tick->tick, player);
+    tick->controls[player] = searchControl(&arena->search, player, &limits);
+}
+
+int main(int argc, char** argv)
+{
+    static struct world world;
+    unsigned int ticks = argc > 1 ? (unsigned int)atoi(argv[1]) : 200;
+    int threads = argc > 2 ? atoi(argv[2]) : 1;
+    unsigned int seed = argc > 3 ? (unsigned int)atoi(argv[3]) : 1;
+    int bots = argc > 4 ? atoi(argv[4]) : MAX_PLAYERS;
+    unsigned char controls[MAX_PLAYERS];
+    unsigned char alive[MAX_PLAYERS];
+    struct arena_tick context;
+    struct pool* pool = NULL;
+    unsigned int rollouts = 0;
+    unsigned int deaths = 0;
+    double start = 0;
+    double elapsed = 0;
+
+    bots = bots < MAX_PLAYERS ? bots : MAX_PLAYERS;
+
+    pool = poolCreate(threads, sizeof(struct arena_scratch));
+    if(pool == NULL)
+    {
+        printf("couldn't start %d threads\n", threads);
+        return 1;
+    }
+
+    worldInit();
+    srand(seed);
+    worldReset(&world);
+    world.options.gameType = GAME_FREE_FOR_ALL;
+    world.options.slowdown = INITIAL_SLOWDOWN;
+    worldStart(&world);
+
+    context.world = &world;
+    context.seed = seed;
+    context.controls = controls;
+
+    start = seconds();
+    for(unsigned int tick = 0; tick < ticks; tick++)
+    {
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            controls[i] = CONTROL_NONE;
+        }
+
+        context.tick = tick;
+        poolRun(pool, decide, &context, bots);
+
+        for(int i = 0; i < bots; i++)
+        {
+            alive[i] = world.snakes->active[i];
+        }
+
+        worldStep(&world, controls);
+
+        for(int i = 0; i < bots; i++)
+        {
+            deaths += alive[i] == 1 && world.snakes->active[i] == 0;
+        }
+    }
+    elapsed = seconds() - start;
+
+    for(int i = 0; i < pool->threads; i++)
+    {
+        rollouts += ((struct arena_scratch*)pool->scratch[i])->search.rollouts;
+    }
+
+    printf("%d bots of %d players on %d threads, %u ticks: %.1f ticks per second, %.0f rollouts per second\n",
+           bots, MAX_PLAYERS, threads, ticks, elapsed > 0 ? ticks / elapsed : 0,
+           elapsed > 0 ? rollouts / elapsed : 0);
+    printf("%.1f deaths per 1000 ticks a bot, world hash %016llx\n",
+           bots > 0 ? deaths * 1000.0 / ((double)ticks * bots) : 0, world.hash);
+
+    poolDestroy(pool);
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*
+Twelve Snakes - board lookups, list walks versus the owner board and bitboard
+
+Plays a few hundred ticks of a free for all with random snakes to get a
+busy board, then times the questions the rules ask about cells three
+ways: walking every snake's segment list like the rules used to, looking up
+the owner board, and testing the bitboard masks. Reachable area is a cell by
+cell breadth first search against the bit-parallel flood fill, and the two
+have to agree.
+
+    boardbench [calls] [seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../world.h"
+#include "timer.h"
+
+#define NUM_CELLS 1024
+#define SETUP_TICKS 400
+
+static volatile int g_Sink;
+
+//
+// The three ways to ask
+//
+
+static int listBody(struct world* world, int x, int y)
+{
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        for(struct location* temp = world->snakes->head[i]; temp != NULL; temp = temp->next)
+        {
+            if(temp->x == x && temp->y == y)
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int boardBody(struct world* world, int x, int y)
+{
+    return world->board[y][x] != BOARD_EMPTY;
+}
+
+static int bitsBody(struct world* world, int x, int y)
+{
+    return BIT_TEST(world->bits.bodies, x, y) != 0;
+}
+
+static int listSafeFood(struct world* world, int x, int y)
+{
+    if(listBody(world, x, y) == 1)
+    {
+        return 0;
+    }
+
+    for(int i = 0; i < world->food.count; i++)
+    {
+        if(world->food.items[i].x == x && world->food.items[i].y == y)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int boardSafeFood(struct world* world, int x, int y)
+{
+    return world->board[y][x] == BOARD_EMPTY && world->food.cell[y][x] == FOOD_NONE;
+}
+
+static int bitsSafeFood(struct world* world, int x, int y)
+{
+    return ((world->bits.bodies[y] | world->bits.food[y]) & BIT_AT(x)) == 0;
+}
+
+// breadth first from the cells next to x, y, asking occupied about every cell
+static int searchReachable(struct world* world, int x, int y, int (*occupied)(struct world* world, int x, int y))
+{
+    static const int STEP_X[4] = {0, 0, 1, -1};
+    static const int STEP_Y[4] = {-1, 1, 0, 0};
+    static unsigned char seen[BOARD_HEIGHT][BOARD_WIDTH];
+    static unsigned char queue[BOARD_WIDTH * BOARD_HEIGHT][2];
+    int head = 0;
+    int tail = 0;
+
+    memset(seen, 0, sizeof(seen));
+
+    queue[tail][0] = x;
+    queue[tail][1] = y;
+    tail++;
+    seen[y][x] = 1;
+
+    while(head < tail)
+    {
+        int cx = queue[head][0];
+        int cy = queue[head][1];
+
+        head++;
+        for(int d = 0; d < 4; d++)
+        {
+            int nx = cx + STEP_X[d];
+            int ny = cy + STEP_Y[d];
+
+            if(nx < MIN_X || nx > MAX_X || ny < MIN_Y || ny > MAX_Y || seen[ny][nx] == 1)
+            {
+                continue;
+            }
+
+            if(occupied(world, nx, ny) == 1 || world->deathGrid.grid[nx - MIN_X][ny - MIN_Y] != 0)
+            {
+                continue;
+            }
+
+            seen[ny][nx] = 1;
+            queue[tail][0] = nx;
+            queue[tail][1] = ny;
+            tail++;
+        }
+    }
+
+    // the start doesn't count unless it's free itself
+    return tail - 1 + (occupied(world, x, y) == 0);
+}
+
+static int listReachable(struct world* world, int x, int y)
+{
+    return searchReachable(world, x, y, listBody);
+}
+
+static int boardReachable(struct world* world, int x, int y)
+{
+    return searchReachable(world, x, y, boardBody);
+}
+
+static int bitsReachable(struct world* world, int x, int y)
+{
+    return bitboardReachable(&world->bits, x, y);
+}
+
+//
+// Timing
+//
+
+typedef int (*cellQuery)(struct world* world, int x, int y);
+
+static double timeQuery(struct world* world, cellQuery query, const unsigned char (*cells)[2], int numCells, int calls)
+{
+    double start = seconds();
+    int sum = 0;
+
+    for(int i = 0; i < calls; i++)
+    {
+        sum += query(world, cells[i % numCells][0], cells[i % numCells][1]);
+    }
+
+    g_Sink = sum;
+    return (seconds() - start) * 1e9 / calls;
+}
+
+static void compare(const char* name, struct world* world, cellQuery* queries,
+                    const unsigned char (*cells)[2], int numCells, int calls)
+{
+    printf("%-16s", name);
+    for(int i = 0; i < 3; i++)
+    {
+        printf(" %10.1f", timeQuery(world, queries[i], cells, numCells, calls));
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    static struct world world;
+    static unsigned char cells[NUM_CELLS][2];
+    static unsigned char heads[MAX_PLAYERS][2];
+    unsigned char controls[MAX_PLAYERS];
+    int calls = argc > 1 ? atoi(argv[1]) : 200000;
+    unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+    int numHeads = 0;
+    int segments = 0;
+    cellQuery body[3] = {listBody, boardBody, bitsBody};
+    cellQuery food[3] = {listSafeFood, boardSafeFood, bitsSafeFood};
+    cellQuery reach[3] = {listReachable, boardReachable, bitsReachable};
+
+    srand(seed);
+    worldInit();
+    worldReset(&world);
+    world.options.gameType = GAME_FREE_FOR_ALL;
+    worldStart(&world);
+
+    // random snakes, joining whenever they're dead
+    for(int tick = 0; tick < SETUP_TICKS; tick++)
+    {
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            controls[i] = CONTROL_JOIN;
+            if(rand() % 6 == 0)
+            {
+                controls[i] |= CONTROL_TURN | (rand() % 4);
+            }
+        }
+
+        worldStep(&world, controls);
+    }
+
+    for(int i = 0; i < NUM_CELLS; i++)
+    {
+        cells[i][0] = MIN_X + rand() % ARENA_WIDTH;
+        cells[i][1] = MIN_Y + rand() % ARENA_HEIGHT;
+
+        if(listBody(&world, cells[i][0], cells[i][1]) != bitsBody(&world, cells[i][0], cells[i][1]) ||
+           listSafeFood(&world, cells[i][0], cells[i][1]) != bitsSafeFood(&world, cells[i][0], cells[i][1]))
+        {
+            printf("bitboard disagrees with the lists at %d,%d\n", cells[i][0], cells[i][1]);
+            return 1;
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(world.snakes->active[i] == 0)
+        {
+            continue;
+        }
+
+        heads[numHeads][0] = world.snakes->head[i]->x;
+        heads[numHeads][1] = world.snakes->head[i]->y;
+        numHeads++;
+
+        if(listReachable(&world, world.snakes->head[i]->x, world.snakes->head[i]->y) != worldReachable(&world, i))
+        {
+            printf("flood fill disagrees with the search for player %d\n", i);
+            return 1;
+        }
+
+        for(struct location* temp = world.snakes->head[i]; temp != NULL; temp = temp->next)
+        {
+            segments++;
+        }
+    }
+
+    printf("%d snakes, %d segments, %d food, ns per call\n", numHeads, segments, world.food.count);
+    printf("%-16s %10s %10s %10s\n", "", "list walk", "board", "bitboard");
+    compare("body", &world, body, cells, NUM_CELLS, calls);
+    compare("safe food", &world, food, cells, NUM_CELLS, calls);
+    if(numHeads > 0)
+    {
+        compare("reachable", &world, reach, heads, numHeads, calls / 100);
+    }
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*
+Twelve Snakes - a queue of screen cell changes between two threads
+*/
+
+#include <string.h>
+#include "cellqueue.h"
+
+void cellQueueInit(struct cell_queue* queue)
+{
+    memset(queue, 0, sizeof(*queue));
+}
+
+int cellQueuePush(struct cell_queue* queue, int x, int y, char glyph)
+{
+    unsigned int head = queue->head;
+    struct cell_delta* cell = NULL;
+
+    if(head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) == CELL_QUEUE_SIZE)
+    {
+        return 0;
+    }
+
+    cell = &queue->cells[head % CELL_QUEUE_SIZE];
+    cell->x = (unsigned char)x;
+    cell->y = (unsigned char)y;
+    cell->glyph = glyph;
+
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void cellQueueClose(struct cell_queue* queue)
+{
+    __atomic_store_n(&queue->closed, 1, __ATOMIC_RELEASE);
+}
+
+int cellQueuePop(struct cell_queue* queue, struct cell_delta* out, int max)
+{
+    unsigned int tail = queue->tail;
+    unsigned int available = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) - tail;
+    int count = available < (unsigned int)max ? (int)available : max;
+
+    for(int i = 0; i < count; i++)
+    {
+        out[i] = queue->cells[(tail + i) % CELL_QUEUE_SIZE];
+    }
+
+    __atomic_store_n(&queue->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+int cellQueueClosed(struct cell_queue* queue)
+{
+    // closed is read first, so no push can land after the emptiness check
+    return __atomic_load_n(&queue->closed, __ATOMIC_ACQUIRE) == 1 &&
+           __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == queue->tail;
+}
@@ -0,0 +1,44 @@
+/*
+Twelve Snakes - a queue of screen cell changes between two threads
+
+One thread pushes the cells it draws, another pops them, with no lock:
+the producer only writes head and the consumer only writes tail, each
+published with release and read with acquire ordering, the way events.c
+publishes its head. A full queue makes the push fail rather than overwrite,
+the producer decides whether to wait.
+*/
+
+#ifndef CELLQUEUE_H
+#define CELLQUEUE_H
+
+#define CELL_QUEUE_SIZE 4096 // power of two
+
+struct cell_delta
+{
+    unsigned char x;
+    unsigned char y;
+    char glyph;
+    unsigned char reserved;
+};
+
+struct cell_queue
+{
+    unsigned int head; // cells ever pushed, written by the producer
+    unsigned char padding[60]; // keeps head and tail on their own cache lines
+    unsigned int tail; // cells ever popped, written by the consumer
+    unsigned char padding2[60];
+    int closed; // the producer is done, set after its last push
+    struct cell_delta cells[CELL_QUEUE_SIZE];
+};
+
+void cellQueueInit(struct cell_queue* queue);
+
+// producer
+int cellQueuePush(struct cell_queue* queue, int x, int y, char glyph); // 0 if full
+void cellQueueClose(struct cell_queue* queue);
+
+// consumer, pops up to max cells, returns how many
+int cellQueuePop(struct cell_queue* queue, struct cell_delta* out, int max);
+int cellQueueClosed(struct cell_queue* queue); // closed and empty
+
+#endif
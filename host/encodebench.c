@@ -0,0 +1,229 @@
+/*
+Twelve Snakes - how fast the observation encoder runs
+
+Plays a batch of gym.h matches for a while, then encodes every player's
+view of every match. The first matches are checked against a cell by cell
+encoding that asks the owner board and the food and sudden death boards
+about each cell of each crop.
+
+    encodebench [envs] [passes] [seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "encoder.h"
+#include "gym.h"
+#include "timer.h"
+
+#define SETUP_STEPS 200
+#define CHECKED_ENVS 64
+
+// what crop cell ox, oy (from the centre, up is forward) is on the board
+static void cropToBoard(int dir, int ox, int oy, int* dx, int* dy)
+{
+    switch(dir)
+    {
+        case DIR_UP:
+            *dx = ox;
+            *dy = oy;
+            break;
+        case DIR_DOWN:
+            *dx = -ox;
+            *dy = -oy;
+            break;
+        case DIR_RIGHT:
+            *dx = -oy;
+            *dy = ox;
+            break;
+        default:
+            *dx = oy;
+            *dy = -ox;
+            break;
+    }
+}
+
+static int cellPlane(const struct world* world, int player, int x, int y, int plane)
+{
+    if(x < 0 || x >= BOARD_WIDTH || y < 0 || y >= BOARD_HEIGHT)
+    {
+        return plane == ENCODER_WALLS;
+    }
+
+    switch(plane)
+    {
+        case ENCODER_OWN_BODY:
+            return world->board[y][x] == player + 1;
+        case ENCODER_OTHER_BODIES:
+            return world->board[y][x] != BOARD_EMPTY && world->board[y][x] != player + 1;
+        case ENCODER_HEADS:
+            for(int i = 0; i < MAX_PLAYERS; i++)
+            {
+                if(world->snakes->active[i] == 1 && world->snakes->head[i]->x == x && world->snakes->head[i]->y == y)
+                {
+                    return 1;
+                }
+            }
+            return 0;
+        case ENCODER_FOOD:
+            return world->food.cell[y][x] != FOOD_NONE;
+        case ENCODER_WALLS:
+            return BIT_TEST(world->bits.walls, x, y) != 0;
+        case ENCODER_PITS:
+            return BIT_TEST(world->bits.pits, x, y) != 0;
+        default:
+            return x >= MIN_X && x <= MAX_X && y >= MIN_Y && y <= MAX_Y &&
+                   world->deathGrid.grid[x - MIN_X][y - MIN_Y] != 0;
+    }
+}
+
+static int checkWorld(const struct world* world, const encoderPlane* planes)
+{
+    uint8_t cells[ENCODER_SIZE * ENCODER_SIZE];
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        for(int plane = 0; plane < ENCODER_PLANES; plane++)
+        {
+            encoderUnpack(planes[i * ENCODER_PLANES + plane], cells);
+
+            for(int r = 0; r < ENCODER_SIZE; r++)
+            {
+                for(int c = 0; c < ENCODER_SIZE; c++)
+                {
+                    int expected = 0;
+                    int dx = 0;
+                    int dy = 0;
+
+                    if(world->snakes->active[i] == 1)
+                    {
+                        cropToBoard(world->snakes->dir[i], c - ENCODER_CENTRE, r - ENCODER_CENTRE, &dx, &dy);
+                        expected = cellPlane(world, i, world->snakes->head[i]->x + dx, world->snakes->head[i]->y + dy, plane);
+                    }
+
+                    if(cells[r * ENCODER_SIZE + c] != expected)
+                    {
+                        printf("player %d plane %d row %d column %d is %d, should be %d\n",
+                               i, plane, r, c, cells[r * ENCODER_SIZE + c], expected);
+                        return 0;
+                    }
+                }
+            }
+        }
+    }
+
+    return 1;
+}
+
+// a batch of matches that have been going for a while
+static struct gym* busyGym(int numEnvs, int gameType, unsigned int seed)
+{
+    struct gym_config config;
+    struct gym* gym = NULL;
+    unsigned char* actions = calloc((size_t)numEnvs * GYM_AGENTS, 1);
+
+    gymDefaultConfig(&config);
+    config.gameType = gameType;
+    config.maxTicks = SETUP_STEPS * 2;
+    if(gameType == GAME_BATTLE_ROYALE)
+    {
+        config.maxTicks = SETUP_STEPS / 2; // in sudden death by the end
+    }
+    config.seed = seed;
+
+    gym = gymCreate(numEnvs, &config);
+    if(gym == NULL || actions == NULL)
+    {
+        gymDestroy(gym);
+        free(actions);
+        return NULL;
+    }
+
+    for(int step = 0; step < SETUP_STEPS; step++)
+    {
+        for(size_t i = 0; i < (size_t)numEnvs * GYM_AGENTS; i++)
+        {
+            actions[i] = rand() % 6 == 0 ? GYM_TURN(rand() % 4) : GYM_STRAIGHT;
+        }
+
+        gymStep(gym, actions);
+    }
+
+    free(actions);
+    return gym;
+}
+
+static int checkGym(struct gym* gym, encoderPlane* planes)
+{
+    for(int env = 0; env < gym->numEnvs && env < CHECKED_ENVS; env++)
+    {
+        encodeWorld(&gym->worlds[env], planes);
+        if(checkWorld(&gym->worlds[env], planes) == 0)
+        {
+            printf("encoding of match %d is wrong\n", env);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    struct gym* gym = NULL;
+    encoderPlane* planes = NULL;
+    int numEnvs = argc > 1 ? atoi(argv[1]) : 4096;
+    int passes = argc > 2 ? atoi(argv[2]) : 20;
+    unsigned int seed = argc > 3 ? (unsigned int)atoi(argv[3]) : 1;
+    int views = 0;
+    double start = 0;
+    double elapsed = 0;
+
+    planes = malloc((size_t)numEnvs * MAX_PLAYERS * ENCODER_PLANES * sizeof(encoderPlane));
+    if(planes == NULL)
+    {
+        printf("out of memory for %d environments\n", numEnvs);
+        return 1;
+    }
+
+    // sudden death to check too
+    gym = busyGym(CHECKED_ENVS, GAME_BATTLE_ROYALE, seed);
+    if(gym == NULL || checkGym(gym, planes) == 0)
+    {
+        return 1;
+    }
+    gymDestroy(gym);
+
+    // the most snakes on the board
+    gym = busyGym(numEnvs, GAME_FREE_FOR_ALL, seed);
+    if(gym == NULL || checkGym(gym, planes) == 0)
+    {
+        return 1;
+    }
+
+    for(int env = 0; env < numEnvs; env++)
+    {
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            views += gym->worlds[env].snakes->active[i];
+        }
+    }
+
+    start = seconds();
+    for(int pass = 0; pass < passes; pass++)
+    {
+        for(int env = 0; env < numEnvs; env++)
+        {
+            encodeWorld(&gym->worlds[env], &planes[(size_t)env * MAX_PLAYERS * ENCODER_PLANES]);
+        }
+    }
+    elapsed = seconds() - start;
+
+    printf("%d matches, %d snakes playing, %d planes of %dx%d each\n", numEnvs, views, ENCODER_PLANES,
+           ENCODER_SIZE, ENCODER_SIZE);
+    printf("%.0f matches per second, %.0f views per second\n", (double)numEnvs * passes / elapsed,
+           (double)views * passes / elapsed);
+
+    free(planes);
+    gymDestroy(gym);
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+Twelve Snakes - what each player sees, as bit planes
+*/
+
+#include "encoder.h"
+
+#define CROP_MASK ((1 << ENCODER_SIZE) - 1)
+#define ROW_PAD 8
+
+// the ENCODER_SIZE cells of a board row centred on column x. Cells left of
+// the board read as fill, the ones right of it are whatever the row has
+// past the board, which is wall in the walls rows and nothing elsewhere.
+static uint16_t cropRow(bitrow row, int x, int fill)
+{
+    bitrow padded = (row << ROW_PAD) | (bitrow)(fill & 0xFF);
+
+    return (uint16_t)((padded >> (x + ROW_PAD - ENCODER_CENTRE)) & CROP_MASK);
+}
+
+// bit c goes to bit ENCODER_SIZE - 1 - c
+static uint16_t reverseRow(uint16_t row)
+{
+    row = (uint16_t)(((row & 0x5555) << 1) | ((row >> 1) & 0x5555));
+    row = (uint16_t)(((row & 0x3333) << 2) | ((row >> 2) & 0x3333));
+    row = (uint16_t)(((row & 0x0F0F) << 4) | ((row >> 4) & 0x0F0F));
+    row = (uint16_t)((row << 8) | (row >> 8));
+
+    return row >> (16 - ENCODER_SIZE);
+}
+
+// Swaps the blocks either side of the diagonal, 8 x 8 first and down to
+// single bits, so row r bit c ends up in row c bit r
+static void transpose(uint16_t* rows)
+{
+    uint16_t mask = 0x00FF;
+
+    for(int j = 8; j != 0; j >>= 1, mask ^= (uint16_t)(mask << j))
+    {
+        for(int k = 0; k < ENCODER_ROWS; k = (k + j + 1) & ~j)
+        {
+            uint16_t swap = ((rows[k] >> j) ^ rows[k + j]) & mask;
+
+            rows[k] ^= (uint16_t)(swap << j);
+            rows[k + j] ^= swap;
+        }
+    }
+}
+
+//
+// Turns a crop read with the board's up at the top so that dir is at the
+// top instead. The centre stays put because reverseRow() and the row
+// order both mirror around ENCODER_CENTRE.
+//
+static void turn(uint16_t* rows, int dir)
+{
+    uint16_t turned[ENCODER_ROWS] = {0};
+
+    switch(dir)
+    {
+        case DIR_UP:
+            return;
+
+        case DIR_DOWN:
+            for(int r = 0; r < ENCODER_SIZE; r++)
+            {
+                turned[r] = reverseRow(rows[ENCODER_SIZE - 1 - r]);
+            }
+            break;
+
+        case DIR_RIGHT:
+            transpose(rows);
+            for(int r = 0; r < ENCODER_SIZE; r++)
+            {
+                turned[r] = rows[ENCODER_SIZE - 1 - r];
+            }
+            break;
+
+        case DIR_LEFT:
+            transpose(rows);
+            for(int r = 0; r < ENCODER_SIZE; r++)
+            {
+                turned[r] = reverseRow(rows[r]);
+            }
+            break;
+    }
+
+    memcpy(rows, turned, sizeof(turned));
+}
+
+void encodeWorld(const struct world* world, encoderPlane* planes)
+{
+    const struct bitboard* bits = &world->bits;
+    bitrow owned[MAX_PLAYERS + 1][BOARD_HEIGHT]; // by the board's owner, player + 1
+    bitrow heads[BOARD_HEIGHT] = {0};
+
+    memset(owned, 0, sizeof(owned));
+    memset(planes, 0, (size_t)MAX_PLAYERS * ENCODER_PLANES * sizeof(encoderPlane));
+
+    // split the bodies by owner, one step per segment
+    for(int y = 0; y < BOARD_HEIGHT; y++)
+    {
+        for(bitrow cells = bits->bodies[y]; cells != 0; cells &= cells - 1)
+        {
+            int x = __builtin_ctzll(cells);
+
+            owned[world->board[y][x]][y] |= BIT_AT(x);
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(world->snakes->active[i] == 1)
+        {
+            BIT_SET(heads, world->snakes->head[i]->x, world->snakes->head[i]->y);
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        encoderPlane* view = &planes[i * ENCODER_PLANES];
+        int x = 0;
+        int top = 0;
+
+        if(world->snakes->active[i] == 0)
+        {
+            continue;
+        }
+
+        x = world->snakes->head[i]->x;
+        top = world->snakes->head[i]->y - ENCODER_CENTRE;
+
+        for(int r = 0; r < ENCODER_SIZE; r++)
+        {
+            int y = top + r;
+
+            if(y < 0 || y >= BOARD_HEIGHT)
+            {
+                view[ENCODER_WALLS][r] = CROP_MASK;
+                continue;
+            }
+
+            view[ENCODER_OWN_BODY][r] = cropRow(owned[i + 1][y], x, 0);
+            view[ENCODER_OTHER_BODIES][r] = cropRow(bits->bodies[y] & ~owned[i + 1][y], x, 0);
+            view[ENCODER_HEADS][r] = cropRow(heads[y], x, 0);
+            view[ENCODER_FOOD][r] = cropRow(bits->food[y], x, 0);
+            view[ENCODER_WALLS][r] = cropRow(bits->walls[y], x, 0xFF);
+            view[ENCODER_PITS][r] = cropRow(bits->pits[y], x, 0);
+            view[ENCODER_SUDDEN_DEATH][r] = cropRow(bits->suddenDeath[y], x, 0);
+        }
+
+        for(int plane = 0; plane < ENCODER_PLANES; plane++)
+        {
+            turn(view[plane], world->snakes->dir[i]);
+        }
+    }
+}
+
+void encoderUnpack(const encoderPlane plane, uint8_t* cells)
+{
+    for(int r = 0; r < ENCODER_SIZE; r++)
+    {
+        for(int c = 0; c < ENCODER_SIZE; c++)
+        {
+            cells[r * ENCODER_SIZE + c] = (plane[r] >> c) & 1;
+        }
+    }
+}
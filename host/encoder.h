@@ -0,0 +1,50 @@
+/*
+Twelve Snakes - what each player sees, as bit planes
+
+Turns a world into a fixed size view per player for bots and analytics: a
+15 x 15 crop of the board centred on the player's head and turned so the
+way the snake is going is up. Each plane of the crop is 15 rows of 15 bits,
+bit c of row r is crop column c, and the head is at row 7, column 7. The
+cell in front of the head is always row 6, column 7.
+
+Everything is built from the world's bitboard and owner board a row at a
+time: a crop row is a shift and a mask of a board row and turning a crop is
+a bit matrix transpose, so there is no test per cell. Cells off the board
+are walls.
+
+    planes[(env * MAX_PLAYERS + player) * ENCODER_PLANES + plane][row]
+*/
+
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include <stdint.h>
+#include "../world.h"
+
+#if BOARD_WIDTH > 48
+#error "the encoder pads a board row by 8 bits on the left inside a bitrow"
+#endif
+
+#define ENCODER_SIZE 15
+#define ENCODER_CENTRE 7
+#define ENCODER_ROWS 16 // a plane's rows, the last is always 0
+
+#define ENCODER_OWN_BODY     0 // the player's own segments, head included
+#define ENCODER_OTHER_BODIES 1
+#define ENCODER_HEADS        2 // every head, the player's own at the centre
+#define ENCODER_FOOD         3
+#define ENCODER_WALLS        4 // walls and everything off the board
+#define ENCODER_PITS         5
+#define ENCODER_SUDDEN_DEATH 6
+#define ENCODER_PLANES       7
+
+typedef uint16_t encoderPlane[ENCODER_ROWS];
+
+// writes the MAX_PLAYERS * ENCODER_PLANES planes of one world, players that
+// aren't playing get empty planes
+void encodeWorld(const struct world* world, encoderPlane* planes);
+
+// one plane as ENCODER_SIZE * ENCODER_SIZE bytes of 0 and 1, row by row
+void encoderUnpack(const encoderPlane plane, uint8_t* cells);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+Twelve Snakes - checks that a snake grows every apple it eats in a row
+
+Plays one snake out of its pit and lays a row of apples in front of it, so
+it eats one every tick, then keeps it going until it has grown them all.
+Every tick the segments on the board plus the growth still owed have
+to add up to currLength, the growth owed can't go negative or past
+MAX_GROWTH, and the hash has to match hashing the world from scratch.
+
+    growcheck [apples]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../world.h"
+
+static struct world g_World;
+
+static int segments(const struct world* world, int player)
+{
+    int count = 0;
+
+    for(const struct location* segment = world->snakes->head[player]; segment != NULL; segment = segment->next)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+// an apple at x, y the way placeFood() lays one
+static void layApple(struct world* world, int x, int y)
+{
+    struct food* theFood = &world->food;
+    struct food_item* item = &theFood->items[theFood->count];
+
+    item->x = (unsigned char)x;
+    item->y = (unsigned char)y;
+    theFood->cell[y][x] = theFood->count;
+    theFood->count++;
+    BIT_SET(world->bits.food, x, y);
+    world->hash ^= worldHashKey(HASH_FOOD, 0, y * BOARD_WIDTH + x);
+}
+
+// one tick of player 0 going straight, 0 if it went wrong
+static int step(struct world* world, int tick)
+{
+    unsigned char controls[MAX_PLAYERS] = {0};
+    int owed = 0;
+
+    worldStep(world, controls);
+    owed = world->snakes->pendingGrowth[0];
+
+    if(world->snakes->active[0] == 0)
+    {
+        printf("tick %d: the snake died\n", tick);
+        return 0;
+    }
+
+    if(owed < 0 || owed > MAX_GROWTH)
+    {
+        printf("tick %d: %d segments of growth owed\n", tick, owed);
+        return 0;
+    }
+
+    if(world->players[0].currLength < MAX_SCORE && segments(world, 0) + owed != world->players[0].currLength)
+    {
+        printf("tick %d: %d segments and %d owed, but %d long\n", tick, segments(world, 0), owed,
+               world->players[0].currLength);
+        return 0;
+    }
+
+    if(world->hash != worldRehash(world))
+    {
+        printf("tick %d: the hash is wrong\n", tick);
+        return 0;
+    }
+
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    struct world* world = &g_World;
+    unsigned char controls[MAX_PLAYERS] = {0};
+    int apples = argc > 1 ? atoi(argv[1]) : MAX_FOOD - 2;
+    int tick = 0;
+    int x = 0;
+    int y = 0;
+
+    if(apples < 1 || apples > MAX_FOOD - 2 || apples > ARENA_WIDTH / 2)
+    {
+        printf("apples is 1 to %d\n", MAX_FOOD - 2);
+        return 1;
+    }
+
+    srand(1);
+    worldInit();
+    worldReset(world);
+    world->options.gameType = GAME_FREE_FOR_ALL;
+    world->options.slowdown = INITIAL_SLOWDOWN;
+    worldStart(world);
+
+    // player 0 starts in the left wall heading right
+    controls[0] = CONTROL_JOIN;
+    worldStep(world, controls);
+    while(world->snakes->head[0]->x < MIN_X + 1)
+    {
+        if(step(world, tick++) == 0)
+        {
+            return 1;
+        }
+    }
+
+    // a row of apples, minus any food already in the way
+    x = world->snakes->head[0]->x;
+    y = world->snakes->head[0]->y;
+    for(int i = 1; i <= apples; i++)
+    {
+        if(world->food.cell[y][x + i] == FOOD_NONE)
+        {
+            layApple(world, x + i, y);
+        }
+    }
+
+    for(int i = 0; i < apples; i++)
+    {
+        if(step(world, tick++) == 0)
+        {
+            return 1;
+        }
+    }
+
+    if(world->players[0].numApples < apples)
+    {
+        printf("ate %d of %d apples in a row\n", world->players[0].numApples, apples);
+        return 1;
+    }
+
+    while(world->snakes->pendingGrowth[0] > 0)
+    {
+        if(step(world, tick++) == 0)
+        {
+            return 1;
+        }
+    }
+    printf("%d apples in a row: %d segments long, all of it grown\n", world->players[0].numApples,
+           segments(world, 0));
+
+    worldReset(world);
+    return 0;
+}
@@ -0,0 +1,318 @@
+/*
+Twelve Snakes - batched environments for training bots on Linux
+*/
+
+#include <stdlib.h>
+#include "../events.h"
+#include "gym.h"
+#include "results.h"
+
+// matches whose heads are checked with one kernel call
+#define GYM_CHECK_ENVS 64
+
+void gymDefaultConfig(struct gym_config* config)
+{
+    memset(config, 0, sizeof(*config));
+    config->gameType = GAME_FREE_FOR_ALL;
+    config->maxLives = 3;
+    config->maxScore = 50;
+    config->maxTicks = 1000;
+    config->joinTicks = 100;
+    config->seed = 1;
+}
+
+// match env's first random number, from the seed and nothing else
+static unsigned int envSeed(unsigned int seed, int env)
+{
+    unsigned int state = seed * 0x9E3779B9u ^ (unsigned int)env * 0x85EBCA6Bu;
+
+    state ^= state >> 16;
+    state *= 0x7FEB352Du;
+    state ^= state >> 15;
+    state *= 0x846CA68Bu;
+    state ^= state >> 16;
+
+    // xorshift never leaves 0
+    return state != 0 ? state : 1;
+}
+
+struct gym* gymCreate(int numEnvs, const struct gym_config* config)
+{
+    struct gym* gym = calloc(1, sizeof(*gym));
+
+    if(gym == NULL)
+    {
+        return NULL;
+    }
+
+    gym->numEnvs = numEnvs;
+    gym->config = *config;
+    gym->worlds = calloc(numEnvs, sizeof(struct world));
+    gym->snakes = calloc(numEnvs, sizeof(struct snakes));
+    gym->random = calloc(numEnvs, sizeof(unsigned int));
+    gym->events = calloc(numEnvs, sizeof(struct event_ring));
+    gym->rewards = calloc((size_t)numEnvs * GYM_AGENTS, sizeof(float));
+    gym->dones = calloc(numEnvs, sizeof(unsigned char));
+    gym->finalScores = calloc((size_t)numEnvs * GYM_AGENTS, sizeof(int));
+    gym->scores = calloc((size_t)numEnvs * GYM_AGENTS, sizeof(int));
+    gym->observations = calloc((size_t)numEnvs * GYM_OBS_ROWS, sizeof(bitrow));
+
+    if(gym->worlds == NULL || gym->snakes == NULL || gym->random == NULL || gym->events == NULL ||
+       gym->scores == NULL || gym->rewards == NULL || gym->dones == NULL || gym->finalScores == NULL ||
+       gym->observations == NULL || headcheckCreate(&gym->heads, GYM_CHECK_ENVS) == 0)
+    {
+        gymDestroy(gym);
+        return NULL;
+    }
+
+    gym->kernel = headcheckBest();
+    worldInit();
+    for(int env = 0; env < numEnvs; env++)
+    {
+        gym->worlds[env].snakes = &gym->snakes[env];
+        gym->worlds[env].random = &gym->random[env];
+        gym->worlds[env].events = &gym->events[env];
+        gym->random[env] = envSeed(config->seed, config->firstEnv + env);
+    }
+    gymReset(gym);
+
+    return gym;
+}
+
+void gymDestroy(struct gym* gym)
+{
+    if(gym == NULL)
+    {
+        return;
+    }
+
+    if(gym->worlds != NULL)
+    {
+        // frees the snakes
+        for(int env = 0; env < gym->numEnvs; env++)
+        {
+            worldReset(&gym->worlds[env]);
+        }
+    }
+
+    free(gym->worlds);
+    free(gym->snakes);
+    free(gym->random);
+    free(gym->events);
+    free(gym->rewards);
+    free(gym->dones);
+    free(gym->finalScores);
+    free(gym->scores);
+    free(gym->observations);
+    headcheckDestroy(&gym->heads);
+    free(gym);
+}
+
+void gymStartMatch(const struct gym_config* config, struct world* world)
+{
+    worldReset(world);
+    world->options.gameType = config->gameType;
+    world->options.maxLives = config->maxLives;
+    world->options.maxScore = config->maxScore;
+    world->options.slowdown = INITIAL_SLOWDOWN;
+    worldStart(world);
+}
+
+// the same end conditions as displayScoreBar(), counted in ticks
+static int matchOver(const struct gym_config* config, struct world* world)
+{
+    struct options* gameOptions = &world->options;
+    int leader = 0;
+
+    switch(gameOptions->gameType)
+    {
+        case GAME_SCORE_ATTACK:
+            leader = worldLeader(world);
+            if(leader != EVENT_NO_PLAYER && world->players[leader].score >= gameOptions->maxScore)
+            {
+                return 1;
+            }
+            break;
+
+        case GAME_BATTLE_ROYALE:
+            if(gameOptions->tick < (unsigned int)config->joinTicks)
+            {
+                return 0;
+            }
+
+            // sudden death closing the whole arena ends it too
+            return worldPlayersRemaining(world) <= 1 ||
+                   world->deathGrid.count >= ARENA_WIDTH * ARENA_HEIGHT;
+    }
+
+    return gameOptions->tick >= (unsigned int)config->maxTicks;
+}
+
+static void observe(struct gym* gym, int env)
+{
+    struct world* world = &gym->worlds[env];
+    bitrow* planes = &gym->observations[(size_t)env * GYM_OBS_ROWS];
+    bitrow* heads = &planes[GYM_PLANE_HEADS * BOARD_HEIGHT];
+
+    memcpy(&planes[GYM_PLANE_WALLS * BOARD_HEIGHT], world->bits.walls, sizeof(world->bits.walls));
+    memcpy(&planes[GYM_PLANE_PITS * BOARD_HEIGHT], world->bits.pits, sizeof(world->bits.pits));
+    memcpy(&planes[GYM_PLANE_BODIES * BOARD_HEIGHT], world->bits.bodies, sizeof(world->bits.bodies));
+    memcpy(&planes[GYM_PLANE_FOOD * BOARD_HEIGHT], world->bits.food, sizeof(world->bits.food));
+    memcpy(&planes[GYM_PLANE_SUDDEN_DEATH * BOARD_HEIGHT], world->bits.suddenDeath, sizeof(world->bits.suddenDeath));
+
+    memset(heads, 0, BOARD_HEIGHT * sizeof(bitrow));
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(world->snakes->active[i] == 1)
+        {
+            BIT_SET(heads, world->snakes->head[i]->x, world->snakes->head[i]->y);
+        }
+    }
+}
+
+void gymReset(struct gym* gym)
+{
+    for(int env = 0; env < gym->numEnvs; env++)
+    {
+        gymStartMatch(&gym->config, &gym->worlds[env]);
+        gym->dones[env] = 0;
+        observe(gym, env);
+    }
+
+    memset(gym->rewards, 0, (size_t)gym->numEnvs * GYM_AGENTS * sizeof(float));
+    memset(gym->finalScores, 0, (size_t)gym->numEnvs * GYM_AGENTS * sizeof(int));
+}
+
+// Battle Royale's timer running out starts sudden death
+static void checkTimer(const struct gym_config* config, struct world* world)
+{
+    if(world->options.gameType == GAME_BATTLE_ROYALE && world->options.tick >= (unsigned int)config->maxTicks)
+    {
+        world->options.suddenDeath = 1;
+    }
+}
+
+int gymStepMatch(const struct gym_config* config, struct world* world, const unsigned char* controls)
+{
+    checkTimer(config, world);
+    worldStep(world, controls);
+    return matchOver(config, world);
+}
+
+// a dead agent always joins again
+static void toControls(const unsigned char* actions, unsigned char* controls)
+{
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        controls[i] = CONTROL_JOIN;
+
+        if(actions[i] > GYM_STRAIGHT && actions[i] < GYM_NUM_ACTIONS)
+        {
+            controls[i] |= CONTROL_TURN | (actions[i] - 1);
+        }
+    }
+}
+
+// the outputs of a match that has finished its tick
+static void endStep(struct gym* gym, int env)
+{
+    struct world* world = &gym->worlds[env];
+    const int* scores = &gym->scores[(size_t)env * GYM_AGENTS];
+    float* rewards = &gym->rewards[(size_t)env * GYM_AGENTS];
+    int* finalScores = &gym->finalScores[(size_t)env * GYM_AGENTS];
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        rewards[i] = (float)(world->players[i].score - scores[i]);
+        finalScores[i] = 0;
+    }
+
+    if(gym->dones[env] == 1)
+    {
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            finalScores[i] = world->players[i].score;
+        }
+
+        if(gym->results != NULL)
+        {
+            resultsAddMatch(gym->results, world, gym->config.seed, gym->matchesEnded);
+        }
+        gym->matchesEnded++;
+
+        gymStartMatch(&gym->config, world);
+    }
+
+    observe(gym, env);
+}
+
+// moves every match from first on, or plays it out without the batch check
+static void moveMatches(struct gym* gym, const unsigned char* actions, int first, int count)
+{
+    unsigned char controls[MAX_PLAYERS];
+
+    for(int env = first; env < first + count; env++)
+    {
+        struct world* world = &gym->worlds[env];
+        int* scores = &gym->scores[(size_t)env * GYM_AGENTS];
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            scores[i] = world->players[i].score;
+        }
+        toControls(&actions[(size_t)env * GYM_AGENTS], controls);
+
+        if(gym->kernel == NULL)
+        {
+            gym->dones[env] = (unsigned char)gymStepMatch(&gym->config, world, controls);
+            endStep(gym, env);
+            continue;
+        }
+
+        checkTimer(&gym->config, world);
+        worldMove(world, controls);
+        headcheckLoad(&gym->heads, env - first, world);
+    }
+}
+
+// checks the heads of the matches moveMatches() moved, then each one
+// settles the heads that were flagged
+static void settleMatches(struct gym* gym, int first, int count)
+{
+    struct headcheck_batch* batch = &gym->heads;
+    unsigned char flags[MAX_PLAYERS];
+
+    gym->kernel(batch);
+    for(int env = first; env < first + count; env++)
+    {
+        struct world* world = &gym->worlds[env];
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            flags[i] = (unsigned char)batch->flags[i * batch->stride + env - first];
+        }
+
+        worldDetectChecked(world, &world->collisions, flags);
+        worldSettle(world);
+        gym->dones[env] = (unsigned char)matchOver(&gym->config, world);
+        endStep(gym, env);
+    }
+}
+
+void gymStep(struct gym* gym, const unsigned char* actions)
+{
+    // a group of matches at a time, so they are still in the cache when
+    // they settle
+    for(int first = 0; first < gym->numEnvs; first += GYM_CHECK_ENVS)
+    {
+        int count = gym->numEnvs - first < GYM_CHECK_ENVS ? gym->numEnvs - first : GYM_CHECK_ENVS;
+
+        // a short last group leaves the last group's heads in the lanes
+        // it doesn't use, which only give flags nobody reads
+        moveMatches(gym, actions, first, count);
+        if(gym->kernel != NULL)
+        {
+            settleMatches(gym, first, count);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*
+Twelve Snakes - batched environments for training bots on Linux
+
+Steps a batch of independent matches with one call, using the same world.c
+rules as the Saturn. Every player slot is an agent: each step takes one
+action per agent, and gives back a reward per agent, a done flag per match
+and the board of every match as bit planes. A match that is done starts over
+in the same step, the way vectorised gym environments do, so the
+observation is already the new match's first board.
+
+Everything a step reads or writes for the whole batch is in flat arrays,
+indexed env * GYM_AGENTS + agent for the agents and env * GYM_OBS_ROWS +
+plane * BOARD_HEIGHT + row for the planes. The state of every snake that
+each tick reads, struct snakes in world.h, is kept for the whole batch in
+one array indexed by env, apart from the boards in struct world.
+
+A step goes a group of matches at a time: it moves their snakes, checks
+all of their heads with one headcheck.h kernel call and then lets each
+match settle who dies and eats.
+
+Each match has its own random numbers and its own event ring, seeded from
+the config's seed and the match's number, so match k plays the same way
+whatever else is in the batch. Matches are numbered from firstEnv, which
+lets a batch be split across processes and still play the same matches.
+Build with -DMAX_PLAYERS=12 for the Saturn's twelve agents a match.
+*/
+
+#ifndef GYM_H
+#define GYM_H
+
+#include "../world.h"
+#include "headcheck.h"
+
+struct results_writer;
+
+#define GYM_AGENTS MAX_PLAYERS
+
+// actions, anything else is treated as GYM_STRAIGHT. A dead agent joins
+// again as soon as the mode lets it.
+#define GYM_STRAIGHT 0
+#define GYM_TURN(dir) (1 + (dir)) // DIR_* from game.h
+#define GYM_NUM_ACTIONS 5
+
+// bit planes, one bitrow per board row, bit x is column x
+#define GYM_PLANE_WALLS  0 // outside the arena, pits excluded
+#define GYM_PLANE_PITS   1
+#define GYM_PLANE_BODIES 2 // every segment, heads included
+#define GYM_PLANE_HEADS  3
+#define GYM_PLANE_FOOD   4
+#define GYM_PLANE_SUDDEN_DEATH 5
+#define GYM_NUM_PLANES   6
+#define GYM_OBS_ROWS (GYM_NUM_PLANES * BOARD_HEIGHT)
+
+struct gym_config
+{
+    int gameType; // GAME_*
+    int maxLives; // Battle Royale
+    int maxScore; // Score Attack
+    int maxTicks; // the match ends here, Battle Royale goes to sudden death instead
+    int joinTicks; // Battle Royale can't end before this, so everyone gets to join
+    unsigned int seed;
+    int firstEnv; // the number of the batch's first match
+};
+
+struct gym
+{
+    int numEnvs;
+    struct gym_config config;
+    struct world* worlds; // numEnvs of them
+    struct snakes* snakes; // numEnvs of them, the worlds' snakes point here
+    unsigned int* random; // numEnvs xorshift states, one per match
+    struct event_ring* events; // numEnvs rings, each match emits into its own
+    int* scores; // each agent's score before the step, for the rewards
+
+    // checks every match's heads at once between moving and settling, see
+    // headcheck.h. gymCreate() picks headcheckBest(), AVX2 if the CPU has
+    // it. NULL steps each match with worldStep() instead.
+    headcheckKernel kernel;
+    struct headcheck_batch heads;
+
+    // outputs of the last gymReset() or gymStep()
+    float* rewards; // change in each agent's score
+    unsigned char* dones; // the match ended and has started over
+    int* finalScores; // each agent's score when its match ended, 0 otherwise
+    bitrow* observations;
+
+    struct results_writer* results; // matches that end are written to it if set, see results.h
+    unsigned int matchesEnded;
+};
+
+void gymDefaultConfig(struct gym_config* config); // free for all, 1000 ticks
+struct gym* gymCreate(int numEnvs, const struct gym_config* config); // NULL if out of memory
+void gymDestroy(struct gym* gym);
+
+void gymReset(struct gym* gym); // starts every match over
+void gymStep(struct gym* gym, const unsigned char* actions); // numEnvs * GYM_AGENTS actions
+
+// one match by the config's rules, for tools that play matches on their own
+void gymStartMatch(const struct gym_config* config, struct world* world);
+int gymStepMatch(const struct gym_config* config, struct world* world, const unsigned char* controls); // 1 once it's over
+
+#endif
@@ -0,0 +1,115 @@
+/*
+Twelve Snakes - how fast a batch of environments steps
+
+Steps a batch of gym.h environments with random actions and prints the
+agent steps per second, the number of agents times the number of matches
+times the steps, and how many matches were played to the end. Given a
+file, the matches that end are written to it with results.h.
+
+    gymbench [envs] [steps] [gameType] [seed] [results]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "gym.h"
+#include "results.h"
+#include "timer.h"
+
+// mostly straight on, so snakes live long enough to make a busy board
+static unsigned char randomAction(unsigned int* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    if((*state & 7) != 0)
+    {
+        return GYM_STRAIGHT;
+    }
+
+    return GYM_TURN((*state >> 3) & 3);
+}
+
+int main(int argc, char** argv)
+{
+    struct gym_config config;
+    struct gym* gym = NULL;
+    unsigned char* actions = NULL;
+    int numEnvs = argc > 1 ? atoi(argv[1]) : 4096;
+    int steps = argc > 2 ? atoi(argv[2]) : 200;
+    unsigned int state = 0;
+    unsigned long matches = 0;
+    double rewards = 0;
+    double start = 0;
+    double elapsed = 0;
+
+    gymDefaultConfig(&config);
+    if(argc > 3)
+    {
+        config.gameType = atoi(argv[3]);
+    }
+    if(argc > 4)
+    {
+        config.seed = (unsigned int)atoi(argv[4]);
+    }
+    state = config.seed | 1;
+
+    gym = gymCreate(numEnvs, &config);
+    actions = malloc((size_t)numEnvs * GYM_AGENTS);
+    if(gym == NULL || actions == NULL)
+    {
+        printf("out of memory for %d environments\n", numEnvs);
+        return 1;
+    }
+
+    if(argc > 5)
+    {
+        gym->results = resultsCreate(argv[5]);
+        if(gym->results == NULL)
+        {
+            printf("can't write %s\n", argv[5]);
+            return 1;
+        }
+    }
+
+    start = seconds();
+    for(int step = 0; step < steps; step++)
+    {
+        for(size_t i = 0; i < (size_t)numEnvs * GYM_AGENTS; i++)
+        {
+            actions[i] = randomAction(&state);
+        }
+
+        gymStep(gym, actions);
+
+        for(int env = 0; env < numEnvs; env++)
+        {
+            matches += gym->dones[env];
+        }
+        for(size_t i = 0; i < (size_t)numEnvs * GYM_AGENTS; i++)
+        {
+            rewards += gym->rewards[i];
+        }
+    }
+    elapsed = seconds() - start;
+
+    printf("%d envs x %d agents x %d steps: %lu matches ended, %.0f total reward\n",
+           numEnvs, GYM_AGENTS, steps, matches, rewards);
+    printf("%.0f agent steps per second\n", elapsed > 0 ? (double)numEnvs * GYM_AGENTS * steps / elapsed : 0);
+
+    if(gym->results != NULL)
+    {
+        unsigned long long rows = gym->results->totalRows + gym->results->rows;
+
+        if(resultsClose(gym->results) == 0)
+        {
+            printf("writing %s failed\n", argv[5]);
+            return 1;
+        }
+        printf("%llu result rows written to %s\n", rows, argv[5]);
+    }
+
+    gymDestroy(gym);
+    free(actions);
+    return 0;
+}
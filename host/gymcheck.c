@@ -0,0 +1,257 @@
+/*
+Twelve Snakes - checks that a match plays the same in any size of batch
+
+Steps a batch of gym.h matches and, next to it, match k on its own in a
+batch of one numbered from k, for a few k. Every agent's action depends on
+its match, its slot and the step only, so match k gets the same actions in
+both. Every step both have to give the same rewards, done flags, final
+scores, observations, state hash and events.
+
+The batch checks its heads with headcheckBest(). The same batch is also
+stepped with the scalar and SSE2 kernels and with worldStep() alone, and
+every match of those has to give the same kills, deaths and everything
+above too.
+
+    gymcheck [envs] [steps] [gameType] [seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../events.h"
+#include "gym.h"
+
+#define CHECKED_ENVS 4
+#define CHECKED_KERNELS 3
+
+// mostly straight on, from nothing but where the agent is
+static unsigned char action(int env, int agent, int step)
+{
+    unsigned int state = (unsigned int)env * 0x9E3779B9u ^ (unsigned int)agent * 0x85EBCA6Bu ^
+                         (unsigned int)step * 0xC2B2AE35u;
+
+    state ^= state >> 16;
+    state *= 0x7FEB352Du;
+    state ^= state >> 15;
+
+    if((state & 7) != 0)
+    {
+        return GYM_STRAIGHT;
+    }
+
+    return GYM_TURN((state >> 3) & 3);
+}
+
+static void fillActions(unsigned char* actions, int firstEnv, int numEnvs, int step)
+{
+    for(int env = 0; env < numEnvs; env++)
+    {
+        for(int i = 0; i < GYM_AGENTS; i++)
+        {
+            actions[env * GYM_AGENTS + i] = action(firstEnv + env, i, step);
+        }
+    }
+}
+
+// 1 if every player killed, ate and died as often in both
+static int sameKills(const struct world* world, const struct world* otherWorld)
+{
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(world->players[i].numKills != otherWorld->players[i].numKills ||
+           world->players[i].numPlayersEaten != otherWorld->players[i].numPlayersEaten ||
+           world->players[i].numDeaths != otherWorld->players[i].numDeaths)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// 0 and a message if match env of batch isn't what match otherEnv of other is
+static int same(const struct gym* batch, int env, const struct gym* other, int otherEnv, const char* how, int step)
+{
+    size_t agents = (size_t)env * GYM_AGENTS;
+    size_t otherAgents = (size_t)otherEnv * GYM_AGENTS;
+    const struct world* world = &batch->worlds[env];
+    const struct world* otherWorld = &other->worlds[otherEnv];
+    const char* what = NULL;
+
+    if(sameKills(world, otherWorld) == 0)
+    {
+        what = "kills and deaths";
+    }
+    else if(memcmp(&batch->rewards[agents], &other->rewards[otherAgents], GYM_AGENTS * sizeof(float)) != 0)
+    {
+        what = "rewards";
+    }
+    else if(batch->dones[env] != other->dones[otherEnv])
+    {
+        what = "done flags";
+    }
+    else if(memcmp(&batch->finalScores[agents], &other->finalScores[otherAgents], GYM_AGENTS * sizeof(int)) != 0)
+    {
+        what = "final scores";
+    }
+    else if(memcmp(&batch->observations[(size_t)env * GYM_OBS_ROWS], &other->observations[(size_t)otherEnv * GYM_OBS_ROWS],
+                   GYM_OBS_ROWS * sizeof(bitrow)) != 0)
+    {
+        what = "observations";
+    }
+    else if(world->hash != otherWorld->hash)
+    {
+        what = "hashes";
+    }
+    else if(memcmp(&batch->events[env], &other->events[otherEnv], sizeof(struct event_ring)) != 0)
+    {
+        what = "events";
+    }
+
+    if(what != NULL)
+    {
+        printf("step %d: match %d has different %s %s\n", step, env, what, how);
+        return 0;
+    }
+
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    static const char* const KERNEL_NAMES[CHECKED_KERNELS] =
+    {
+        "with the scalar kernel than with headcheckBest()",
+        "with the SSE2 kernel than with headcheckBest()",
+        "with worldStep() than with headcheckBest()",
+    };
+    headcheckKernel kernels[CHECKED_KERNELS] = {headcheckScalar, headcheckSSE2, NULL};
+    struct gym_config config;
+    struct gym* batch = NULL;
+    struct gym* alone[CHECKED_ENVS] = {NULL};
+    struct gym* others[CHECKED_KERNELS] = {NULL};
+    struct event_reader* readers = NULL;
+    struct game_event event;
+    int checked[CHECKED_ENVS] = {0};
+    unsigned char* actions = NULL;
+    unsigned char aloneActions[GYM_AGENTS];
+    char aloneHow[64];
+    int numEnvs = argc > 1 ? atoi(argv[1]) : 64;
+    int steps = argc > 2 ? atoi(argv[2]) : 2000;
+    unsigned long kills = 0;
+
+    if(numEnvs < 1)
+    {
+        printf("envs is at least 1\n");
+        return 1;
+    }
+
+    gymDefaultConfig(&config);
+    config.maxTicks = 300; // so matches end and start over during the check
+    if(argc > 3)
+    {
+        config.gameType = atoi(argv[3]);
+    }
+    if(argc > 4)
+    {
+        config.seed = (unsigned int)atoi(argv[4]);
+    }
+    snprintf(aloneHow, sizeof(aloneHow), "alone than in a batch of %d", numEnvs);
+
+    // the first, second, middle and last match
+    checked[0] = 0;
+    checked[1] = numEnvs > 1 ? 1 : 0;
+    checked[2] = numEnvs / 2;
+    checked[3] = numEnvs - 1;
+
+    batch = gymCreate(numEnvs, &config);
+    actions = malloc((size_t)numEnvs * GYM_AGENTS);
+    readers = calloc(numEnvs, sizeof(struct event_reader));
+    if(batch == NULL || actions == NULL || readers == NULL)
+    {
+        printf("out of memory for %d environments\n", numEnvs);
+        return 1;
+    }
+
+    for(int env = 0; env < numEnvs; env++)
+    {
+        eventRingReaderInit(&batch->events[env], &readers[env]);
+    }
+
+    for(int c = 0; c < CHECKED_ENVS; c++)
+    {
+        struct gym_config single = config;
+
+        single.firstEnv = checked[c];
+        alone[c] = gymCreate(1, &single);
+        if(alone[c] == NULL || same(batch, checked[c], alone[c], 0, aloneHow, 0) == 0)
+        {
+            return 1;
+        }
+    }
+
+    for(int k = 0; k < CHECKED_KERNELS; k++)
+    {
+        others[k] = gymCreate(numEnvs, &config);
+        if(others[k] == NULL)
+        {
+            printf("out of memory for %d environments\n", numEnvs);
+            return 1;
+        }
+        others[k]->kernel = kernels[k];
+    }
+
+    for(int step = 1; step <= steps; step++)
+    {
+        fillActions(actions, 0, numEnvs, step);
+        gymStep(batch, actions);
+
+        for(int c = 0; c < CHECKED_ENVS; c++)
+        {
+            fillActions(aloneActions, checked[c], 1, step);
+            gymStep(alone[c], aloneActions);
+
+            if(same(batch, checked[c], alone[c], 0, aloneHow, step) == 0)
+            {
+                return 1;
+            }
+        }
+
+        for(int k = 0; k < CHECKED_KERNELS; k++)
+        {
+            gymStep(others[k], actions);
+
+            for(int env = 0; env < numEnvs; env++)
+            {
+                if(same(batch, env, others[k], env, KERNEL_NAMES[k], step) == 0)
+                {
+                    return 1;
+                }
+            }
+        }
+
+        // so it's known the kills being compared happen
+        for(int env = 0; env < numEnvs; env++)
+        {
+            while(eventRingRead(&batch->events[env], &readers[env], &event) == 1)
+            {
+                kills += event.type == EVENT_KILL || event.type == EVENT_EATEN;
+            }
+        }
+    }
+
+    printf("%d steps of %d matches, %lu kills and %u ended: the same alone and in the batch, "
+           "and the same with every kernel and without\n", steps, numEnvs, kills, batch->matchesEnded);
+
+    for(int c = 0; c < CHECKED_ENVS; c++)
+    {
+        gymDestroy(alone[c]);
+    }
+    for(int k = 0; k < CHECKED_KERNELS; k++)
+    {
+        gymDestroy(others[k]);
+    }
+    gymDestroy(batch);
+    free(actions);
+    free(readers);
+    return 0;
+}
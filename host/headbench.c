@@ -0,0 +1,195 @@
+/*
+Twelve Snakes - the batched head checks, scalar against SSE2 and AVX2
+
+Plays a batch of gym.h matches for a while to get busy boards, loads the
+cells the heads move to next and the food into a headcheck_batch and times
+each kernel over it. The vector kernels have to give exactly the scalar
+kernel's flags, and the scalar kernel has to agree with the boards.
+
+    headbench [envs] [passes] [seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "gym.h"
+#include "headcheck.h"
+#include "timer.h"
+
+#define SETUP_STEPS 200
+
+static const int DIR_DX[4] = {0, 0, 1, -1};
+static const int DIR_DY[4] = {-1, 1, 0, 0};
+
+// where player i's head goes if it keeps going, 0 if it leaves the board
+static int nextCell(struct world* world, int i, int* x, int* y)
+{
+    if(world->snakes->active[i] == 0)
+    {
+        return 0;
+    }
+
+    *x = world->snakes->head[i]->x + DIR_DX[world->snakes->dir[i]];
+    *y = world->snakes->head[i]->y + DIR_DY[world->snakes->dir[i]];
+
+    return *x >= 0 && *x < BOARD_WIDTH && *y >= 0 && *y < BOARD_HEIGHT;
+}
+
+static void loadNextHeads(struct headcheck_batch* batch, int env, struct world* world)
+{
+    int x = 0;
+    int y = 0;
+
+    headcheckLoad(batch, env, world);
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        batch->heads[i * batch->stride + env] = HEADCHECK_NO_HEAD + i;
+        if(nextCell(world, i, &x, &y) == 1)
+        {
+            batch->heads[i * batch->stride + env] = HEADCHECK_CELL(x, y);
+        }
+    }
+}
+
+static int checkAgainstBoard(struct gym* gym, struct headcheck_batch* batch)
+{
+    for(int env = 0; env < gym->numEnvs; env++)
+    {
+        struct world* world = &gym->worlds[env];
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            uint16_t flags = batch->flags[i * batch->stride + env];
+            int onFood = 0;
+            int meets = 0;
+            int x = 0;
+            int y = 0;
+            int outside = 0;
+
+            if(nextCell(world, i, &x, &y) == 0)
+            {
+                continue;
+            }
+
+            outside = x < MIN_X || x > MAX_X || y < MIN_Y || y > MAX_Y;
+            onFood = world->food.cell[y][x] != FOOD_NONE;
+            for(int j = 0; j < MAX_PLAYERS; j++)
+            {
+                int otherX = 0;
+                int otherY = 0;
+
+                if(j != i && nextCell(world, j, &otherX, &otherY) == 1 && otherX == x && otherY == y)
+                {
+                    meets = 1;
+                }
+            }
+
+            if(((flags & HEADCHECK_FOOD) != 0) != onFood || ((flags & HEADCHECK_HEAD) != 0) != meets ||
+               ((flags & HEADCHECK_OUTSIDE) != 0) != outside)
+            {
+                printf("scalar kernel disagrees with the board, match %d player %d\n", env, i);
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static double timeKernel(headcheckKernel kernel, struct headcheck_batch* batch, int passes)
+{
+    double start = seconds();
+
+    for(int i = 0; i < passes; i++)
+    {
+        kernel(batch);
+    }
+
+    return seconds() - start;
+}
+
+int main(int argc, char** argv)
+{
+    static const char* NAMES[3] = {"scalar", "SSE2", "AVX2"};
+    headcheckKernel kernels[3] = {headcheckScalar, headcheckSSE2, headcheckAVX2};
+    struct gym_config config;
+    struct headcheck_batch batch;
+    struct gym* gym = NULL;
+    uint16_t* expected = NULL;
+    unsigned char* actions = NULL;
+    int numEnvs = argc > 1 ? atoi(argv[1]) : 4096;
+    int passes = argc > 2 ? atoi(argv[2]) : 200;
+    int numKernels = 2;
+    size_t numFlags = 0;
+    double baseline = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+    if(__builtin_cpu_supports("avx2"))
+    {
+        numKernels = 3;
+    }
+#endif
+
+    gymDefaultConfig(&config);
+    if(argc > 3)
+    {
+        config.seed = (unsigned int)atoi(argv[3]);
+    }
+
+    gym = gymCreate(numEnvs, &config);
+    actions = calloc((size_t)numEnvs * GYM_AGENTS, 1);
+    if(gym == NULL || actions == NULL || headcheckCreate(&batch, numEnvs) == 0)
+    {
+        printf("out of memory for %d environments\n", numEnvs);
+        return 1;
+    }
+
+    for(int step = 0; step < SETUP_STEPS; step++)
+    {
+        for(size_t i = 0; i < (size_t)numEnvs * GYM_AGENTS; i++)
+        {
+            actions[i] = rand() % 6 == 0 ? GYM_TURN(rand() % 4) : GYM_STRAIGHT;
+        }
+
+        gymStep(gym, actions);
+    }
+
+    for(int env = 0; env < numEnvs; env++)
+    {
+        loadNextHeads(&batch, env, &gym->worlds[env]);
+    }
+
+    numFlags = (size_t)MAX_PLAYERS * batch.stride;
+    expected = malloc(numFlags * sizeof(uint16_t));
+    headcheckScalar(&batch);
+    memcpy(expected, batch.flags, numFlags * sizeof(uint16_t));
+    if(checkAgainstBoard(gym, &batch) == 0)
+    {
+        return 1;
+    }
+
+    printf("%d matches x %d players, million heads checked per second\n", numEnvs, MAX_PLAYERS);
+    for(int k = 0; k < numKernels; k++)
+    {
+        double elapsed = timeKernel(kernels[k], &batch, passes);
+
+        if(memcmp(expected, batch.flags, numFlags * sizeof(uint16_t)) != 0)
+        {
+            printf("%s disagrees with scalar\n", NAMES[k]);
+            return 1;
+        }
+
+        if(k == 0)
+        {
+            baseline = elapsed;
+        }
+
+        printf("%-8s %10.1f  %5.1fx\n", NAMES[k], (double)numEnvs * MAX_PLAYERS * passes / elapsed / 1e6,
+               baseline / elapsed);
+    }
+
+    free(expected);
+    free(actions);
+    headcheckDestroy(&batch);
+    gymDestroy(gym);
+    return 0;
+}
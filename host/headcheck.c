@@ -0,0 +1,300 @@
+/*
+Twelve Snakes - head checks for a whole batch of matches at once
+*/
+
+#include <stdlib.h>
+#include "headcheck.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HEADCHECK_X86 1
+#else
+#define HEADCHECK_X86 0
+#endif
+
+// aligned for the AVX2 loads
+static uint16_t* allocLanes(size_t count)
+{
+    void* lanes = NULL;
+
+    if(posix_memalign(&lanes, 32, count * sizeof(uint16_t)) != 0)
+    {
+        return NULL;
+    }
+
+    return lanes;
+}
+
+int headcheckCreate(struct headcheck_batch* batch, int numEnvs)
+{
+    int stride = (numEnvs + HEADCHECK_LANES - 1) / HEADCHECK_LANES * HEADCHECK_LANES;
+
+    memset(batch, 0, sizeof(*batch));
+    batch->numEnvs = numEnvs;
+    batch->stride = stride;
+
+    batch->heads = allocLanes((size_t)MAX_PLAYERS * stride);
+    batch->food = allocLanes((size_t)MAX_FOOD * stride);
+    batch->flags = allocLanes((size_t)MAX_PLAYERS * stride);
+
+    if(batch->heads == NULL || batch->food == NULL || batch->flags == NULL)
+    {
+        headcheckDestroy(batch);
+        return 0;
+    }
+
+    // the padding matches have nobody playing and no food
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        for(int env = 0; env < stride; env++)
+        {
+            batch->heads[i * stride + env] = HEADCHECK_NO_HEAD + i;
+        }
+    }
+
+    for(int i = 0; i < MAX_FOOD * stride; i++)
+    {
+        batch->food[i] = HEADCHECK_NO_FOOD;
+    }
+
+    memset(batch->flags, 0, (size_t)MAX_PLAYERS * stride * sizeof(uint16_t));
+    return 1;
+}
+
+void headcheckDestroy(struct headcheck_batch* batch)
+{
+    free(batch->heads);
+    free(batch->food);
+    free(batch->flags);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void headcheckLoad(struct headcheck_batch* batch, int env, const struct world* world)
+{
+    int stride = batch->stride;
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        const struct location* head = world->snakes->head[i];
+
+        batch->heads[i * stride + env] = HEADCHECK_NO_HEAD + i;
+        if(world->snakes->active[i] == 0)
+        {
+            continue;
+        }
+
+        // only a snake that left a pit the wrong way gets off the board
+        batch->heads[i * stride + env] = HEADCHECK_OFF_BOARD;
+        if(head->x >= 0 && head->x < BOARD_WIDTH && head->y >= 0 && head->y < BOARD_HEIGHT)
+        {
+            batch->heads[i * stride + env] = HEADCHECK_CELL(head->x, head->y);
+        }
+    }
+
+    for(int i = 0; i < MAX_FOOD; i++)
+    {
+        batch->food[i * stride + env] = HEADCHECK_NO_FOOD;
+        if(i < world->food.count)
+        {
+            batch->food[i * stride + env] = HEADCHECK_CELL(world->food.items[i].x, world->food.items[i].y);
+        }
+    }
+}
+
+//
+// Scalar, one head at a time. The vector kernels have to match it exactly.
+//
+
+void headcheckScalar(struct headcheck_batch* batch)
+{
+    int stride = batch->stride;
+
+    for(int env = 0; env < stride; env++)
+    {
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            uint16_t cell = batch->heads[i * stride + env];
+            uint16_t flags = 0;
+            int x = cell & 63;
+            int y = cell >> 6;
+
+            if((cell >> 12) == 0 && (x < MIN_X || x > MAX_X || y < MIN_Y || y > MAX_Y))
+            {
+                flags |= HEADCHECK_OUTSIDE;
+            }
+
+            for(int j = 0; j < MAX_PLAYERS; j++)
+            {
+                if(j != i && batch->heads[j * stride + env] == cell)
+                {
+                    flags |= HEADCHECK_HEAD;
+                }
+            }
+
+            for(int f = 0; f < MAX_FOOD; f++)
+            {
+                if(batch->food[f * stride + env] == cell)
+                {
+                    flags |= HEADCHECK_FOOD;
+                }
+            }
+
+            batch->flags[i * stride + env] = flags;
+        }
+    }
+}
+
+#if HEADCHECK_X86
+
+//
+// The vector kernels are the same steps written once per register width:
+// bounds from the cell's x and y, every pair of players compared once and
+// the result ORed into both, then every head against every food item.
+// The lanes are 16 bits and hold numbers below 0x8000 or sentinels, so
+// the signed compares are safe for the bounds.
+//
+
+void headcheckSSE2(struct headcheck_batch* batch)
+{
+    int stride = batch->stride;
+    __m128i minX = _mm_set1_epi16(MIN_X);
+    __m128i maxX = _mm_set1_epi16(MAX_X);
+    __m128i minY = _mm_set1_epi16(MIN_Y);
+    __m128i maxY = _mm_set1_epi16(MAX_Y);
+    __m128i columns = _mm_set1_epi16(63);
+    __m128i zero = _mm_setzero_si128();
+
+    for(int env = 0; env < stride; env += 8)
+    {
+        __m128i heads[MAX_PLAYERS];
+        __m128i meets[MAX_PLAYERS];
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            heads[i] = _mm_load_si128((const __m128i*)&batch->heads[i * stride + env]);
+            meets[i] = zero;
+        }
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            for(int j = i + 1; j < MAX_PLAYERS; j++)
+            {
+                __m128i same = _mm_cmpeq_epi16(heads[i], heads[j]);
+
+                meets[i] = _mm_or_si128(meets[i], same);
+                meets[j] = _mm_or_si128(meets[j], same);
+            }
+        }
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            __m128i x = _mm_and_si128(heads[i], columns);
+            __m128i y = _mm_srli_epi16(heads[i], 6);
+            __m128i playing = _mm_cmpeq_epi16(_mm_srli_epi16(heads[i], 12), zero);
+            __m128i outside = _mm_or_si128(_mm_or_si128(_mm_cmpgt_epi16(minX, x), _mm_cmpgt_epi16(x, maxX)),
+                                           _mm_or_si128(_mm_cmpgt_epi16(minY, y), _mm_cmpgt_epi16(y, maxY)));
+            __m128i eats = zero;
+            __m128i flags;
+
+            for(int f = 0; f < MAX_FOOD; f++)
+            {
+                __m128i food = _mm_load_si128((const __m128i*)&batch->food[f * stride + env]);
+
+                eats = _mm_or_si128(eats, _mm_cmpeq_epi16(heads[i], food));
+            }
+
+            flags = _mm_and_si128(_mm_and_si128(outside, playing), _mm_set1_epi16(HEADCHECK_OUTSIDE));
+            flags = _mm_or_si128(flags, _mm_and_si128(meets[i], _mm_set1_epi16(HEADCHECK_HEAD)));
+            flags = _mm_or_si128(flags, _mm_and_si128(eats, _mm_set1_epi16(HEADCHECK_FOOD)));
+            _mm_store_si128((__m128i*)&batch->flags[i * stride + env], flags);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void headcheckAVX2(struct headcheck_batch* batch)
+{
+    int stride = batch->stride;
+    __m256i minX = _mm256_set1_epi16(MIN_X);
+    __m256i maxX = _mm256_set1_epi16(MAX_X);
+    __m256i minY = _mm256_set1_epi16(MIN_Y);
+    __m256i maxY = _mm256_set1_epi16(MAX_Y);
+    __m256i columns = _mm256_set1_epi16(63);
+    __m256i zero = _mm256_setzero_si256();
+
+    for(int env = 0; env < stride; env += 16)
+    {
+        __m256i heads[MAX_PLAYERS];
+        __m256i meets[MAX_PLAYERS];
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            heads[i] = _mm256_load_si256((const __m256i*)&batch->heads[i * stride + env]);
+            meets[i] = zero;
+        }
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            for(int j = i + 1; j < MAX_PLAYERS; j++)
+            {
+                __m256i same = _mm256_cmpeq_epi16(heads[i], heads[j]);
+
+                meets[i] = _mm256_or_si256(meets[i], same);
+                meets[j] = _mm256_or_si256(meets[j], same);
+            }
+        }
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            __m256i x = _mm256_and_si256(heads[i], columns);
+            __m256i y = _mm256_srli_epi16(heads[i], 6);
+            __m256i playing = _mm256_cmpeq_epi16(_mm256_srli_epi16(heads[i], 12), zero);
+            __m256i outside = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi16(minX, x), _mm256_cmpgt_epi16(x, maxX)),
+                                              _mm256_or_si256(_mm256_cmpgt_epi16(minY, y), _mm256_cmpgt_epi16(y, maxY)));
+            __m256i eats = zero;
+            __m256i flags;
+
+            for(int f = 0; f < MAX_FOOD; f++)
+            {
+                __m256i food = _mm256_load_si256((const __m256i*)&batch->food[f * stride + env]);
+
+                eats = _mm256_or_si256(eats, _mm256_cmpeq_epi16(heads[i], food));
+            }
+
+            flags = _mm256_and_si256(_mm256_and_si256(outside, playing), _mm256_set1_epi16(HEADCHECK_OUTSIDE));
+            flags = _mm256_or_si256(flags, _mm256_and_si256(meets[i], _mm256_set1_epi16(HEADCHECK_HEAD)));
+            flags = _mm256_or_si256(flags, _mm256_and_si256(eats, _mm256_set1_epi16(HEADCHECK_FOOD)));
+            _mm256_store_si256((__m256i*)&batch->flags[i * stride + env], flags);
+        }
+    }
+}
+
+headcheckKernel headcheckBest()
+{
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return headcheckAVX2;
+    }
+
+    return headcheckSSE2;
+}
+
+#else
+
+// no vector kernels for this CPU yet
+void headcheckSSE2(struct headcheck_batch* batch)
+{
+    headcheckScalar(batch);
+}
+
+void headcheckAVX2(struct headcheck_batch* batch)
+{
+    headcheckScalar(batch);
+}
+
+headcheckKernel headcheckBest()
+{
+    return headcheckScalar;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+Twelve Snakes - head checks for a whole batch of matches at once
+
+With a batch of matches the questions asked about every head are the same
+comparison over and over: is it outside the arena, is another head in the
+same cell, is it on food. Laid out with one match per lane, player i's
+heads of every match are one array, so each question is a vertical compare
+of two arrays with no shuffling between lanes, 8 matches per SSE2 register
+and 16 per AVX2 register.
+
+A cell is y * 64 + x, which fits the 16-bit lanes because a board row fits
+in a bitrow. Players that aren't playing get HEADCHECK_NO_HEAD + player,
+unused food HEADCHECK_NO_FOOD, so neither ever matches anything, and heads
+that left the board HEADCHECK_OFF_BOARD, which is outside. What comes
+out is a flag per head: a head outside the arena may still be in a pit,
+and two heads in one cell still need the lengths to settle, so the rules
+only look further at the heads that are flagged.
+
+gymStep() moves every match's snakes, checks all of their heads with one
+kernel call and hands each match its flags for worldDetectChecked(), so a
+match only tests walls, pits and head buckets for the heads flagged. The
+flags are the HEAD_* of world.h.
+*/
+
+#ifndef HEADCHECK_H
+#define HEADCHECK_H
+
+#include <stdint.h>
+#include "../world.h"
+
+#define HEADCHECK_CELL(x, y) ((uint16_t)(((y) << 6) | (x)))
+#define HEADCHECK_NO_HEAD 0xF000
+#define HEADCHECK_OFF_BOARD HEADCHECK_CELL(63, 63)
+#define HEADCHECK_NO_FOOD 0xFFFF
+
+// flags per head, the HEAD_* worldDetectChecked() takes
+#define HEADCHECK_OUTSIDE HEAD_OUTSIDE // outside the arena walls
+#define HEADCHECK_HEAD    HEAD_MEETS // another head is in the same cell
+#define HEADCHECK_FOOD    HEAD_ON_FOOD // on food
+
+// matches are padded to a multiple of this, so every kernel works on whole
+// registers
+#define HEADCHECK_LANES 16
+
+struct headcheck_batch
+{
+    int numEnvs;
+    int stride; // numEnvs rounded up to HEADCHECK_LANES
+    uint16_t* heads; // MAX_PLAYERS rows of stride cells
+    uint16_t* food; // MAX_FOOD rows of stride cells
+    uint16_t* flags; // MAX_PLAYERS rows of stride HEADCHECK_* flags
+};
+
+typedef void (*headcheckKernel)(struct headcheck_batch* batch);
+
+int headcheckCreate(struct headcheck_batch* batch, int numEnvs); // 0 if out of memory
+void headcheckDestroy(struct headcheck_batch* batch);
+void headcheckLoad(struct headcheck_batch* batch, int env, const struct world* world); // the heads and food of one match
+
+void headcheckScalar(struct headcheck_batch* batch);
+void headcheckSSE2(struct headcheck_batch* batch);
+void headcheckAVX2(struct headcheck_batch* batch); // only on CPUs that have it, see headcheckBest()
+
+headcheckKernel headcheckBest(); // the fastest kernel this CPU runs
+
+#endif
@@ -0,0 +1,139 @@
+/*
+Twelve Snakes - headless matches on Linux
+
+Runs a free for all with simple bots in the player slots, using the
+same world.c rules as the Saturn but without drawing anything. Built with
+more players than fit on two consoles to check that spawn points, pits and
+glyphs come out right for any player count.
+
+    headless [ticks] [seed] [bots]
+
+bots is how many of the player slots play, all of them by default. Prints the
+spawn table, what happened during the match and the ticks played per second.
+`make bench` runs the 2, 4, 12 and 32 player builds against this 64 player
+one with the same number of bots, to see what building for a fixed player
+count buys.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../events.h"
+#include "../world.h"
+#include "timer.h"
+
+static const int DIR_DX[4] = {0, 0, 1, -1};
+static const int DIR_DY[4] = {-1, 1, 0, 0};
+
+static int cellIsFree(struct world* world, int x, int y)
+{
+    if(x < MIN_X || x > MAX_X || y < MIN_Y || y > MAX_Y)
+    {
+        return 0;
+    }
+
+    return world->board[y][x] == BOARD_EMPTY;
+}
+
+// Joins when dead. Otherwise keeps going until something is in the way or it
+// feels like turning, then takes the first free direction starting from a
+// random one.
+static unsigned char botControl(struct world* world, int bot)
+{
+    struct location* head = world->snakes->head[bot];
+    int dir = world->snakes->dir[bot];
+    int start = 0;
+
+    if(world->snakes->active[bot] == 0)
+    {
+        return CONTROL_JOIN;
+    }
+
+    // still in the pit, turning now would hit the wall
+    if(head->x < MIN_X || head->x > MAX_X || head->y < MIN_Y || head->y > MAX_Y)
+    {
+        return CONTROL_NONE;
+    }
+
+    if(cellIsFree(world, head->x + DIR_DX[dir], head->y + DIR_DY[dir]) == 1 && rand() % 8 != 0)
+    {
+        return CONTROL_NONE;
+    }
+
+    start = rand() % 4;
+    for(int i = 0; i < 4; i++)
+    {
+        int next = (start + i) % 4;
+
+        if(next == (dir ^ 1))
+        {
+            continue;
+        }
+
+        if(cellIsFree(world, head->x + DIR_DX[next], head->y + DIR_DY[next]) == 1)
+        {
+            return CONTROL_TURN | next;
+        }
+    }
+
+    return CONTROL_NONE;
+}
+
+int main(int argc, char** argv)
+{
+    static struct world world;
+    unsigned int ticks = argc > 1 ? (unsigned int)atoi(argv[1]) : 10000;
+    unsigned int seed = argc > 2 ? (unsigned int)atoi(argv[2]) : 1;
+    int bots = argc > 3 ? atoi(argv[3]) : MAX_PLAYERS;
+    unsigned char controls[MAX_PLAYERS];
+    unsigned int counts[EVENT_MODE_END + 1] = {0};
+    struct event_reader reader;
+    struct game_event event;
+    double start = 0;
+    double elapsed = 0;
+
+    worldInit();
+
+    printf("%d players, spawn points:\n", MAX_PLAYERS);
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        const struct spawn_point* spawn = &g_Spawns[i];
+
+        printf("  %3d  %2d,%2d  dir %d%s\n", i, spawn->x, spawn->y, spawn->dir, spawn->pit == 1 ? "  pit" : "");
+    }
+
+    srand(seed);
+    worldReset(&world);
+    eventsReset();
+    eventReaderInit(&reader);
+    world.options.gameType = GAME_FREE_FOR_ALL;
+    world.options.slowdown = INITIAL_SLOWDOWN;
+    worldStart(&world);
+
+    start = seconds();
+    for(unsigned int tick = 0; tick < ticks; tick++)
+    {
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            controls[i] = i < bots ? botControl(&world, i) : CONTROL_NONE;
+        }
+
+        worldStep(&world, controls);
+
+        while(eventRead(&reader, &event) == 1)
+        {
+            if(event.type <= EVENT_MODE_END)
+            {
+                counts[event.type]++;
+            }
+        }
+    }
+    elapsed = seconds() - start;
+
+    printf("%u ticks: %u spawns, %u deaths, %u kills, %u eaten, %u apples, %u events missed\n",
+           ticks, counts[EVENT_SPAWN], counts[EVENT_DEATH], counts[EVENT_KILL],
+           counts[EVENT_EATEN], counts[EVENT_APPLE], reader.missed);
+    printf("%d of %d players: %.0f ticks per second\n", bots < MAX_PLAYERS ? bots : MAX_PLAYERS, MAX_PLAYERS,
+           elapsed > 0 ? ticks / elapsed : 0);
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+Twelve Snakes - link transport over a pair of POSIX file descriptors
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "link_pipe.h"
+
+// xorshift, so a lossy run is repeatable
+static unsigned int lossRandom(struct link_pipe* pipe)
+{
+    unsigned int x = pipe->lossState;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pipe->lossState = x;
+    return x;
+}
+
+static int pipeSend(void* context, const unsigned char* data, int size)
+{
+    struct link_pipe* pipe = (struct link_pipe*)context;
+    ssize_t written = 0;
+
+    if(pipe->lossOneIn == 0)
+    {
+        written = write(pipe->writeFd, data, (size_t)size);
+    }
+    else
+    {
+        // byte at a time so single bytes can be dropped or flipped
+        for(int i = 0; i < size; i++)
+        {
+            unsigned char byte = data[i];
+            unsigned int roll = lossRandom(pipe) % (pipe->lossOneIn * 2);
+            ssize_t result = 0;
+
+            if(roll == 0)
+            {
+                written++;
+                continue; // dropped
+            }
+            if(roll == 1)
+            {
+                byte ^= 0x10; // corrupted
+            }
+
+            result = write(pipe->writeFd, &byte, 1);
+            if(result != 1)
+            {
+                break;
+            }
+            written++;
+        }
+
+        if(written == 0 && size > 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            return -1;
+        }
+        return (int)written;
+    }
+
+    if(written < 0)
+    {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    return (int)written;
+}
+
+static int pipeReceive(void* context, unsigned char* data, int size)
+{
+    struct link_pipe* pipe = (struct link_pipe*)context;
+    ssize_t result = 0;
+
+    if(size <= 0)
+    {
+        return 0;
+    }
+
+    result = read(pipe->readFd, data, (size_t)size);
+    if(result < 0)
+    {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    if(result == 0)
+    {
+        return -1; // the other end closed
+    }
+
+    return (int)result;
+}
+
+void linkPipeTransport(struct link_transport* transport, struct link_pipe* pipe, int readFd, int writeFd)
+{
+    pipe->readFd = readFd;
+    pipe->writeFd = writeFd;
+    if(pipe->lossState == 0)
+    {
+        pipe->lossState = 0x2545F491u ^ (unsigned int)writeFd;
+    }
+
+    fcntl(readFd, F_SETFL, fcntl(readFd, F_GETFL) | O_NONBLOCK);
+    fcntl(writeFd, F_SETFL, fcntl(writeFd, F_GETFL) | O_NONBLOCK);
+
+    transport->context = pipe;
+    transport->send = pipeSend;
+    transport->receive = pipeReceive;
+}
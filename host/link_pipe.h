@@ -0,0 +1,24 @@
+/*
+Twelve Snakes - link transport over a pair of POSIX file descriptors
+
+Used to run the lockstep protocol between two processes on Linux in place of
+the Saturn link cable. Any pipe, FIFO or socket pair works.
+*/
+
+#ifndef LINK_PIPE_H
+#define LINK_PIPE_H
+
+#include "../link.h"
+
+struct link_pipe
+{
+    int readFd;
+    int writeFd;
+    unsigned int lossOneIn; // drop or corrupt about one byte in this many, 0 for none
+    unsigned int lossState;
+};
+
+// puts both descriptors in non-blocking mode
+void linkPipeTransport(struct link_transport* transport, struct link_pipe* pipe, int readFd, int writeFd);
+
+#endif
@@ -0,0 +1,230 @@
+/*
+Twelve Snakes - lockstep link soak run on Linux
+
+Forks a host and a guest that talk the link protocol over two pipes, the same
+way two Saturns would over the link cable. Each side plays its ticks with made
+up pad inputs, pumping the link during the slowdown frames like jo_main()
+does, and hashes the combined inputs it plays every tick. Lockstep holds if
+both sides end with the same hash. The running hash goes with every tick
+like the world hash does on the Saturn.
+
+    linkloop [ticks] [slowdown] [lossOneIn] [desyncAt]
+
+lossOneIn drops or corrupts roughly one byte in that many to exercise resends.
+desyncAt makes the guest's hash go wrong in that tick, counting from 0. Both
+sides should then report being out of sync at tick desyncAt + 1, counting
+from 1 like the Saturn does.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "link_pipe.h"
+
+#define FRAME_MICROSECONDS 200
+
+struct run_result
+{
+    unsigned int hash;
+    unsigned int played;
+    unsigned int stalledFrames;
+    int desyncTick; // -1 if the hashes agreed
+};
+
+static void sleepFrame()
+{
+    struct timespec frame = {0, FRAME_MICROSECONDS * 1000};
+
+    nanosleep(&frame, NULL);
+}
+
+static unsigned int hashInputs(unsigned int hash, const unsigned short* pads, int elapsed)
+{
+    for(int i = 0; i < 2 * LINK_PLAYERS_PER_CONSOLE; i++)
+    {
+        hash = (hash ^ pads[i]) * 16777619u;
+    }
+
+    return (hash ^ (unsigned int)elapsed) * 16777619u;
+}
+
+static void runSide(int side, int readFd, int writeFd, unsigned int ticks, int slowdown,
+                    unsigned int lossOneIn, int desyncAt, struct run_result* result)
+{
+    struct link link;
+    struct link_pipe pipe = {0};
+    struct link_transport transport;
+    struct link_start start = {0, 3, 25, 180, slowdown, 12345};
+    unsigned short localPads[LINK_PLAYERS_PER_CONSOLE];
+    unsigned short pads[2 * LINK_PLAYERS_PER_CONSOLE];
+    unsigned int padState = 0x9E3779B9u * (unsigned int)(side + 1);
+    int elapsed = 0;
+
+    result->hash = 2166136261u;
+    result->played = 0;
+    result->stalledFrames = 0;
+    result->desyncTick = -1;
+
+    pipe.lossOneIn = lossOneIn;
+    linkPipeTransport(&transport, &pipe, readFd, writeFd);
+    linkInit(&link, &transport, side);
+
+    if(side == LINK_SIDE_HOST)
+    {
+        linkHost(&link, &start);
+    }
+
+    // handshake
+    while(link.state == LINK_WAITING)
+    {
+        linkPoll(&link);
+        sleepFrame();
+    }
+
+    for(unsigned int tick = 0; tick < ticks && link.state != LINK_LOST; tick++)
+    {
+        // sample "pads" for LINK_INPUT_DELAY ticks from now
+        for(int i = 0; i < LINK_PLAYERS_PER_CONSOLE; i++)
+        {
+            padState = padState * 1103515245u + 12345u;
+            localPads[i] = (unsigned short)(padState >> 16);
+        }
+
+        while(linkSubmit(&link, localPads, (int)(tick / 10), result->hash) == 0 && link.state != LINK_LOST)
+        {
+            linkPoll(&link);
+            sleepFrame();
+            result->stalledFrames++;
+        }
+
+        // only stall if the slowdown frames weren't enough
+        while(linkReady(&link, tick) == 0 && linkPoll(&link) != LINK_LOST)
+        {
+            sleepFrame();
+            result->stalledFrames++;
+        }
+
+        if(link.state == LINK_LOST)
+        {
+            break;
+        }
+
+        linkInputs(&link, tick, pads, &elapsed);
+        result->hash = hashInputs(result->hash, pads, elapsed);
+        result->played++;
+
+        if(side == LINK_SIDE_GUEST && (int)tick == desyncAt)
+        {
+            result->hash ^= 1;
+        }
+
+        if(link.desynced == 1 && result->desyncTick < 0)
+        {
+            result->desyncTick = (int)link.desyncTick;
+        }
+
+        // the tick's own frame plus the slowdown frames
+        for(int frame = 0; frame <= slowdown; frame++)
+        {
+            linkPoll(&link);
+            sleepFrame();
+        }
+    }
+
+    // keep acknowledging until the peer has caught up, then leave. The peer
+    // may already have gone, that's fine once every tick was played.
+    for(int frame = 0; frame < 200 && link.state != LINK_LOST; frame++)
+    {
+        linkPoll(&link);
+        sleepFrame();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int ticks = argc > 1 ? (unsigned int)atoi(argv[1]) : 2000;
+    int slowdown = argc > 2 ? atoi(argv[2]) : 5;
+    unsigned int lossOneIn = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+    int desyncAt = argc > 4 ? atoi(argv[4]) : -1;
+    int hostToGuest[2];
+    int guestToHost[2];
+    int results[2];
+    struct run_result sides[2];
+    pid_t guest = 0;
+
+    if(pipe(hostToGuest) != 0 || pipe(guestToHost) != 0 || pipe(results) != 0)
+    {
+        perror("pipe");
+        return 2;
+    }
+
+    guest = fork();
+    if(guest < 0)
+    {
+        perror("fork");
+        return 2;
+    }
+
+    if(guest == 0)
+    {
+        struct run_result result;
+
+        close(hostToGuest[1]);
+        close(guestToHost[0]);
+        close(results[0]);
+
+        runSide(LINK_SIDE_GUEST, hostToGuest[0], guestToHost[1], ticks, slowdown, lossOneIn, desyncAt, &result);
+        if(write(results[1], &result, sizeof(result)) != sizeof(result))
+        {
+            return 2;
+        }
+        return 0;
+    }
+
+    close(hostToGuest[0]);
+    close(guestToHost[1]);
+    close(results[1]);
+
+    runSide(LINK_SIDE_HOST, guestToHost[0], hostToGuest[1], ticks, slowdown, lossOneIn, desyncAt, &sides[LINK_SIDE_HOST]);
+
+    if(read(results[0], &sides[LINK_SIDE_GUEST], sizeof(struct run_result)) != sizeof(struct run_result))
+    {
+        fprintf(stderr, "guest exited without a result\n");
+        return 2;
+    }
+    waitpid(guest, NULL, 0);
+
+    printf("ticks %u slowdown %d loss 1/%u\n", ticks, slowdown, lossOneIn);
+    printf("host  hash %08x played %u stalled frames %u\n", sides[LINK_SIDE_HOST].hash,
+           sides[LINK_SIDE_HOST].played, sides[LINK_SIDE_HOST].stalledFrames);
+    printf("guest hash %08x played %u stalled frames %u\n", sides[LINK_SIDE_GUEST].hash,
+           sides[LINK_SIDE_GUEST].played, sides[LINK_SIDE_GUEST].stalledFrames);
+
+    if(desyncAt >= 0)
+    {
+        printf("host  out of sync at tick %d\n", sides[LINK_SIDE_HOST].desyncTick);
+        printf("guest out of sync at tick %d\n", sides[LINK_SIDE_GUEST].desyncTick);
+
+        if(sides[LINK_SIDE_HOST].desyncTick != desyncAt + 1 || sides[LINK_SIDE_GUEST].desyncTick != desyncAt + 1)
+        {
+            printf("desync detection FAILED\n");
+            return 1;
+        }
+
+        printf("desync detected ok\n");
+        return 0;
+    }
+
+    if(sides[LINK_SIDE_HOST].played != ticks || sides[LINK_SIDE_GUEST].played != ticks ||
+       sides[LINK_SIDE_HOST].hash != sides[LINK_SIDE_GUEST].hash ||
+       sides[LINK_SIDE_HOST].desyncTick >= 0 || sides[LINK_SIDE_GUEST].desyncTick >= 0)
+    {
+        printf("lockstep FAILED\n");
+        return 1;
+    }
+
+    printf("lockstep ok\n");
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+Twelve Snakes - a pool of worker threads on Linux
+*/
+
+#include <stdlib.h>
+#include "pool.h"
+
+struct pool_worker
+{
+    struct pool* pool;
+    void* scratch;
+};
+
+// runs jobs until none are left, returns how many this thread ran
+static int runJobs(struct pool* pool, poolJob job, void* context, int count, void* scratch)
+{
+    int ran = 0;
+
+    for(;;)
+    {
+        int index = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+
+        if(index >= count)
+        {
+            return ran;
+        }
+
+        job(context, index, scratch);
+        ran++;
+    }
+}
+
+static void* workerMain(void* arg)
+{
+    struct pool_worker* worker = (struct pool_worker*)arg;
+    struct pool* pool = worker->pool;
+    unsigned int seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for(;;)
+    {
+        poolJob job = NULL;
+        void* context = NULL;
+        int count = 0;
+        int ran = 0;
+
+        while(pool->batch == seen && pool->stop == 0)
+        {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+
+        if(pool->stop == 1)
+        {
+            break;
+        }
+
+        // woken for a batch that poolRun() already returned from: its job,
+        // context and count may be about to change under the next one
+        seen = pool->batch;
+        if(pool->ended == seen)
+        {
+            continue;
+        }
+
+        // poolRun() doesn't return, and so doesn't start another batch,
+        // until every worker that joined this one has left it
+        job = pool->job;
+        context = pool->context;
+        count = pool->count;
+        pool->active++;
+        pthread_mutex_unlock(&pool->lock);
+
+        ran = runJobs(pool, job, context, count, worker->scratch);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->done += ran;
+        pool->active--;
+        if(pool->done >= pool->count && pool->active == 0)
+        {
+            pthread_cond_signal(&pool->finished);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    free(worker);
+    return NULL;
+}
+
+struct pool* poolCreate(int threads, size_t scratchSize)
+{
+    struct pool* pool = NULL;
+
+    if(threads < 1)
+    {
+        return NULL;
+    }
+
+    pool = calloc(1, sizeof(*pool));
+    if(pool == NULL)
+    {
+        return NULL;
+    }
+
+    pool->workers = calloc((size_t)threads, sizeof(pthread_t));
+    pool->scratch = calloc((size_t)threads, sizeof(void*));
+    if(pool->workers == NULL || pool->scratch == NULL)
+    {
+        free(pool->workers);
+        free(pool->scratch);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+    pool->threads = threads;
+
+    for(int i = 0; i < threads; i++)
+    {
+        pool->scratch[i] = calloc(1, scratchSize > 0 ? scratchSize : 1);
+        if(pool->scratch[i] == NULL)
+        {
+            poolDestroy(pool);
+            return NULL;
+        }
+    }
+
+    // thread 0 is whoever calls poolRun()
+    for(int i = 1; i < threads; i++)
+    {
+        struct pool_worker* worker = malloc(sizeof(*worker));
+
+        if(worker == NULL)
+        {
+            poolDestroy(pool);
+            return NULL;
+        }
+
+        worker->pool = pool;
+        worker->scratch = pool->scratch[i];
+        if(pthread_create(&pool->workers[pool->running], NULL, workerMain, worker) != 0)
+        {
+            free(worker);
+            poolDestroy(pool);
+            return NULL;
+        }
+        pool->running++;
+    }
+
+    return pool;
+}
+
+void poolDestroy(struct pool* pool)
+{
+    if(pool == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(int i = 0; i < pool->running; i++)
+    {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+
+    for(int i = 0; i < pool->threads; i++)
+    {
+        free(pool->scratch[i]);
+    }
+
+    free(pool->scratch);
+    free(pool->workers);
+    free(pool);
+}
+
+void poolRun(struct pool* pool, poolJob job, void* context, int count)
+{
+    int ran = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->context = context;
+    pool->count = count;
+    pool->next = 0;
+    pool->done = 0;
+    pool->batch++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    ran = runJobs(pool, job, context, count, pool->scratch[0]);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->done += ran;
+    while(pool->done < pool->count || pool->active > 0)
+    {
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pool->ended = pool->batch;
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,53 @@
+/*
+Twelve Snakes - a pool of worker threads on Linux
+
+Runs count independent jobs, job(context, index, scratch), across a fixed
+set of threads that are started once and then wait for work. The thread
+calling poolRun() works too and returns once every job is done.
+
+Each thread has its own scratch memory, allocated once when the pool is
+made, for whatever a job needs that is too big for the stack: a job gets the
+scratch of whichever thread runs it and may leave anything in it for the
+next job on that thread. Which thread gets which index is up to timing, so
+for results that don't depend on the number of threads a job has to write
+only its own index's output and treat scratch as a cache of things it could
+work out again.
+*/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+typedef void (*poolJob)(void* context, int index, void* scratch);
+
+struct pool
+{
+    int threads; // the caller included
+    int running; // workers started, up to threads - 1
+    pthread_t* workers;
+    void** scratch; // one per thread, the caller's first
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake; // a new batch, or stop
+    pthread_cond_t finished; // the last job of the batch is done
+    unsigned int batch; // counts the batches, workers wait for it to change
+    unsigned int ended; // the last batch poolRun() returned from, nobody joins it after
+    int stop;
+
+    // the current batch
+    poolJob job;
+    void* context;
+    int count;
+    int next; // index of the next job to hand out, taken atomically
+    int done; // jobs finished, under lock
+    int active; // workers still taking jobs from it, under lock
+};
+
+struct pool* poolCreate(int threads, size_t scratchSize); // NULL if out of memory or threads
+void poolDestroy(struct pool* pool);
+
+void poolRun(struct pool* pool, poolJob job, void* context, int count);
+
+#endif
@@ -0,0 +1,249 @@
+/*
+Twelve Snakes - match replays on Linux
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "replay.h"
+
+//
+// recording
+//
+
+void replayBegin(struct replay_recorder* recorder, const struct gym_config* config, unsigned int seed)
+{
+    struct replay_header* header = &recorder->header;
+
+    memset(header, 0, sizeof(*header));
+    header->magic = REPLAY_MAGIC;
+    header->version = REPLAY_VERSION;
+    header->players = MAX_PLAYERS;
+    header->seed = seed;
+    header->gameType = config->gameType;
+    header->maxLives = config->maxLives;
+    header->maxScore = config->maxScore;
+    header->maxTicks = config->maxTicks;
+    header->joinTicks = config->joinTicks;
+    recorder->failed = 0;
+
+    srand(seed);
+    eventsReset();
+    eventReaderInit(&recorder->reader);
+}
+
+// everything emitted since the last call
+static void drainEvents(struct replay_recorder* recorder)
+{
+    struct replay_header* header = &recorder->header;
+    struct game_event event;
+
+    while(eventRead(&recorder->reader, &event) == 1)
+    {
+        if(header->eventCount == recorder->eventCapacity)
+        {
+            size_t capacity = recorder->eventCapacity > 0 ? recorder->eventCapacity * 2 : 1024;
+            struct game_event* events = realloc(recorder->events, capacity * sizeof(*events));
+
+            if(events == NULL)
+            {
+                recorder->failed = 1;
+                return;
+            }
+
+            recorder->events = events;
+            recorder->eventCapacity = capacity;
+        }
+
+        recorder->events[header->eventCount++] = event;
+    }
+
+    header->missed = recorder->reader.missed;
+}
+
+void replayTick(struct replay_recorder* recorder, const struct world* world, const unsigned char* controls)
+{
+    struct replay_header* header = &recorder->header;
+    unsigned char* tick = NULL;
+    unsigned int hash = (unsigned int)world->hash;
+
+    drainEvents(recorder);
+
+    if(header->ticks == recorder->inputCapacity)
+    {
+        size_t capacity = recorder->inputCapacity > 0 ? recorder->inputCapacity * 2 : 1024;
+        unsigned char* inputs = realloc(recorder->inputs, capacity * REPLAY_TICK_SIZE(MAX_PLAYERS));
+
+        if(inputs == NULL)
+        {
+            recorder->failed = 1;
+            return;
+        }
+
+        recorder->inputs = inputs;
+        recorder->inputCapacity = capacity;
+    }
+
+    tick = &recorder->inputs[(size_t)header->ticks * REPLAY_TICK_SIZE(MAX_PLAYERS)];
+    memcpy(tick, controls, MAX_PLAYERS);
+    memcpy(tick + MAX_PLAYERS, &hash, sizeof(hash));
+    header->ticks++;
+}
+
+int replayEnd(struct replay_recorder* recorder, struct world* world, const char* path)
+{
+    struct replay_header* header = &recorder->header;
+    FILE* file = NULL;
+    int ok = 1;
+
+    // as main.c does when a match ends
+    header->winner = (unsigned char)worldLeader(world);
+    emitEvent(EVENT_MODE_END, header->winner, world->options.gameType, 0, 0);
+    drainEvents(recorder);
+
+    header->winnerScore = header->winner != EVENT_NO_PLAYER ? world->players[header->winner].score : 0;
+    header->hash = world->hash;
+    header->eventOffset = sizeof(*header);
+    header->inputOffset = header->eventOffset + header->eventCount * sizeof(struct game_event);
+
+    if(recorder->failed == 1)
+    {
+        return 0;
+    }
+
+    file = fopen(path, "wb");
+    if(file == NULL)
+    {
+        return 0;
+    }
+
+    ok &= fwrite(header, sizeof(*header), 1, file) == 1;
+    ok &= fwrite(recorder->events, sizeof(struct game_event), header->eventCount, file) == header->eventCount;
+    ok &= fwrite(recorder->inputs, REPLAY_TICK_SIZE(MAX_PLAYERS), header->ticks, file) == header->ticks;
+    ok &= fclose(file) == 0;
+
+    return ok;
+}
+
+void replayFree(struct replay_recorder* recorder)
+{
+    free(recorder->events);
+    free(recorder->inputs);
+    memset(recorder, 0, sizeof(*recorder));
+}
+
+//
+// reading
+//
+
+const struct replay_header* replayHeader(const void* data, size_t size)
+{
+    const struct replay_header* header = (const struct replay_header*)data;
+
+    if(size < sizeof(*header) || header->magic != REPLAY_MAGIC || header->version != REPLAY_VERSION ||
+       header->eventOffset < sizeof(*header) ||
+       header->inputOffset != header->eventOffset + (size_t)header->eventCount * sizeof(struct game_event) ||
+       size < header->inputOffset + (size_t)header->ticks * REPLAY_TICK_SIZE(header->players))
+    {
+        return NULL;
+    }
+
+    return header;
+}
+
+const struct game_event* replayEvents(const struct replay_header* header)
+{
+    return (const struct game_event*)((const unsigned char*)header + header->eventOffset);
+}
+
+const unsigned char* replayControls(const struct replay_header* header, unsigned int tick)
+{
+    return (const unsigned char*)header + header->inputOffset + (size_t)tick * REPLAY_TICK_SIZE(header->players);
+}
+
+unsigned int replayTickHash(const struct replay_header* header, unsigned int tick)
+{
+    unsigned int hash = 0;
+
+    // the ticks are players + 4 bytes, so the hash needn't be aligned
+    memcpy(&hash, replayControls(header, tick) + header->players, sizeof(hash));
+    return hash;
+}
+
+void replaySummarize(const struct replay_header* header, struct replay_entry* entry)
+{
+    const struct game_event* events = replayEvents(header);
+
+    memset(entry, 0, sizeof(*entry));
+    entry->seed = header->seed;
+    entry->ticks = header->ticks;
+    entry->gameType = (unsigned char)header->gameType;
+    entry->winner = header->winner;
+    entry->players = header->players;
+    entry->maxLives = (unsigned short)header->maxLives;
+    entry->maxScore = (unsigned short)header->maxScore;
+    entry->maxTicks = (unsigned int)header->maxTicks;
+    entry->winnerScore = header->winnerScore;
+    entry->suddenDeathTick = REPLAY_NO_TICK;
+
+    // events come in tick order, so the first closed cell starts sudden death
+    for(unsigned int i = 0; i < header->eventCount; i++)
+    {
+        const struct game_event* event = &events[i];
+
+        if(event->type >= REPLAY_EVENT_TYPES)
+        {
+            continue;
+        }
+
+        entry->counts[event->type]++;
+        if(event->type == EVENT_SUDDEN_DEATH_CELL && entry->suddenDeathTick == REPLAY_NO_TICK)
+        {
+            entry->suddenDeathTick = event->tick;
+        }
+
+        if(entry->suddenDeathTick != REPLAY_NO_TICK)
+        {
+            entry->suddenDeathKills += event->type == EVENT_KILL;
+            entry->suddenDeathEaten += event->type == EVENT_EATEN;
+        }
+    }
+}
+
+unsigned int replayCheck(const struct replay_header* header)
+{
+    static struct world world;
+    struct gym_config config;
+
+    if(header->players != MAX_PLAYERS)
+    {
+        return REPLAY_INCOMPATIBLE;
+    }
+
+    gymDefaultConfig(&config);
+    config.gameType = header->gameType;
+    config.maxLives = header->maxLives;
+    config.maxScore = header->maxScore;
+    config.maxTicks = header->maxTicks;
+    config.joinTicks = header->joinTicks;
+    config.seed = header->seed;
+
+    srand(header->seed);
+    eventsReset();
+    gymStartMatch(&config, &world);
+    for(unsigned int tick = 0; tick < header->ticks; tick++)
+    {
+        gymStepMatch(&config, &world, replayControls(header, tick));
+        if((unsigned int)world.hash != replayTickHash(header, tick))
+        {
+            return tick;
+        }
+    }
+
+    if(world.hash != header->hash || worldLeader(&world) != header->winner)
+    {
+        return header->ticks;
+    }
+
+    return REPLAY_NO_TICK;
+}
@@ -0,0 +1,112 @@
+/*
+Twelve Snakes - match replays on Linux
+
+A replay is one file per match: a fixed header, then every event the match
+emitted as the struct game_event records from events.h, then every tick's
+CONTROL_* bytes, MAX_PLAYERS of them, and its hash. Numbers are in the byte order
+of the machine that wrote the file, the magic reads backwards on the other
+one.
+
+The header says how the match was set up and how it came out, and the
+events say what happened in it, so sorting and searching a corpus never has
+to play a match again: replaySummarize() works from a mapped file in place,
+reading the events straight out of the mapping. The inputs, the seed and the
+gym.h rules the match was played by are there to play it again when the
+world itself is wanted. Each tick's inputs are followed by the low 32 bits
+of world->hash after that tick, as link play sends them, so replayCheck()
+can say which tick a match first plays out differently on.
+
+The recorder keeps a match in memory and writes it in one go at the end.
+*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include "../events.h"
+#include "gym.h"
+
+#define REPLAY_MAGIC 0x50525354 // "TSRP"
+#define REPLAY_VERSION 2
+#define REPLAY_EVENT_TYPES 8 // EVENT_* are 1 to 7
+#define REPLAY_NAME_SIZE 48
+#define REPLAY_NO_TICK 0xFFFFFFFF
+#define REPLAY_INCOMPATIBLE 0xFFFFFFFE // replayCheck(): played by a build with another player count
+#define REPLAY_TICK_SIZE(players) ((players) + 4) // the controls, then the hash
+
+struct replay_header
+{
+    unsigned int magic;
+    unsigned short version;
+    unsigned short players; // MAX_PLAYERS of the build that played it
+    unsigned int seed; // srand() before the match started
+    unsigned int ticks; // played
+    unsigned int eventCount;
+    unsigned int missed; // events the ring dropped before the recorder read them
+    unsigned int eventOffset; // from the start of the file
+    unsigned int inputOffset;
+    unsigned long long hash; // world->hash after the last tick
+
+    // the struct gym_config it was played by
+    int gameType;
+    int maxLives;
+    int maxScore;
+    int maxTicks;
+    int joinTicks;
+
+    unsigned char winner; // worldLeader() at the end, EVENT_NO_PLAYER if nobody
+    unsigned char reserved[3];
+    int winnerScore;
+};
+
+// what an index keeps of a replay, all from its header and events
+struct replay_entry
+{
+    unsigned int seed;
+    unsigned int ticks;
+    unsigned char gameType;
+    unsigned char winner;
+    unsigned short players;
+    unsigned short maxLives;
+    unsigned short maxScore;
+    unsigned int maxTicks;
+    int winnerScore;
+    unsigned int counts[REPLAY_EVENT_TYPES]; // events of each type
+    unsigned int suddenDeathTick; // first cell closed off, REPLAY_NO_TICK if none
+    unsigned int suddenDeathKills; // EVENT_KILL from then on
+    unsigned int suddenDeathEaten; // EVENT_EATEN from then on
+    char name[REPLAY_NAME_SIZE]; // file name in the corpus directory
+};
+
+struct replay_recorder
+{
+    struct replay_header header;
+    struct event_reader reader;
+    struct game_event* events;
+    size_t eventCapacity;
+    unsigned char* inputs; // REPLAY_TICK_SIZE(MAX_PLAYERS) bytes a tick
+    size_t inputCapacity; // ticks
+    int failed; // out of memory, the replay won't be written
+};
+
+// seeds rand() and starts reading events, gymStartMatch() comes next so
+// the spawns are recorded too
+void replayBegin(struct replay_recorder* recorder, const struct gym_config* config, unsigned int seed);
+void replayTick(struct replay_recorder* recorder, const struct world* world, const unsigned char* controls); // after each worldStep()
+int replayEnd(struct replay_recorder* recorder, struct world* world, const char* path); // 1 if written
+void replayFree(struct replay_recorder* recorder);
+
+// a mapped replay: the header if the file is one, and its events in place
+const struct replay_header* replayHeader(const void* data, size_t size);
+const struct game_event* replayEvents(const struct replay_header* header);
+const unsigned char* replayControls(const struct replay_header* header, unsigned int tick);
+unsigned int replayTickHash(const struct replay_header* header, unsigned int tick); // low 32 bits after the tick
+void replaySummarize(const struct replay_header* header, struct replay_entry* entry);
+
+// plays the match again from its seed and inputs: REPLAY_NO_TICK if every
+// tick's hash and the end come out the same, otherwise the first tick that
+// doesn't, header->ticks if only the end differs. REPLAY_INCOMPATIBLE if
+// this build can't play it at all.
+unsigned int replayCheck(const struct replay_header* header);
+
+#endif
@@ -0,0 +1,446 @@
+/*
+Twelve Snakes - record, index and search a corpus of replays
+
+    replays record dir count [seed]   plays count matches with quick bots,
+                                      cycling through the modes
+    replays index dir file            summarizes every replay into an index
+    replays query file [filter...]    lists the replays in an index that match
+    replays scan dir [filter...]      the same straight from the replays
+    replays check file...             plays replays again, compares each
+                                      tick's hash and says where one differs
+
+Replays are mapped, never read into buffers, and summarized from their
+headers and events alone. The index is an array of struct replay_entry
+after a short header, mapped and searched in place the same way. Filters
+all have to hold:
+
+    mode=N      GAME_* from game.h
+    winner=N    player slot
+    minticks=N  maxticks=N
+    eaten       a snake ate another head on
+    sd-eaten    ... after sudden death started
+    sd-kills    a snake ran into another after sudden death started
+
+so "all Battle Royale matches where a snake was eaten in sudden death" is
+`replays query corpus.idx mode=2 sd-eaten`.
+*/
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../search.h"
+#include "replay.h"
+#include "timer.h"
+
+#define INDEX_MAGIC 0x49525354 // "TSRI"
+#define INDEX_VERSION 1
+
+struct index_header
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int count;
+    unsigned int entrySize; // sizeof(struct replay_entry) of the build that wrote it
+};
+
+struct filter
+{
+    int gameType; // -1 for any
+    int winner; // -1 for any
+    unsigned int minTicks;
+    unsigned int maxTicks;
+    int eaten;
+    int suddenDeathEaten;
+    int suddenDeathKills;
+};
+
+// what a pass over replays came to
+struct scan
+{
+    struct filter filter;
+    FILE* index; // entries are written to it instead of filtered, if set
+    unsigned long long bytes;
+    unsigned int files;
+    unsigned int matched;
+};
+
+static struct search_board g_Board;
+
+static int parseFilter(struct filter* filter, int argc, char** argv)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->gameType = -1;
+    filter->winner = -1;
+    filter->maxTicks = REPLAY_NO_TICK;
+
+    for(int i = 0; i < argc; i++)
+    {
+        const char* arg = argv[i];
+
+        if(strncmp(arg, "mode=", 5) == 0)
+        {
+            filter->gameType = atoi(arg + 5);
+        }
+        else if(strncmp(arg, "winner=", 7) == 0)
+        {
+            filter->winner = atoi(arg + 7);
+        }
+        else if(strncmp(arg, "minticks=", 9) == 0)
+        {
+            filter->minTicks = (unsigned int)atoi(arg + 9);
+        }
+        else if(strncmp(arg, "maxticks=", 9) == 0)
+        {
+            filter->maxTicks = (unsigned int)atoi(arg + 9);
+        }
+        else if(strcmp(arg, "eaten") == 0)
+        {
+            filter->eaten = 1;
+        }
+        else if(strcmp(arg, "sd-eaten") == 0)
+        {
+            filter->suddenDeathEaten = 1;
+        }
+        else if(strcmp(arg, "sd-kills") == 0)
+        {
+            filter->suddenDeathKills = 1;
+        }
+        else
+        {
+            printf("unknown filter %s\n", arg);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int matches(const struct filter* filter, const struct replay_entry* entry)
+{
+    return (filter->gameType < 0 || entry->gameType == filter->gameType) &&
+           (filter->winner < 0 || entry->winner == filter->winner) &&
+           entry->ticks >= filter->minTicks && entry->ticks <= filter->maxTicks &&
+           (filter->eaten == 0 || entry->counts[EVENT_EATEN] > 0) &&
+           (filter->suddenDeathEaten == 0 || entry->suddenDeathEaten > 0) &&
+           (filter->suddenDeathKills == 0 || entry->suddenDeathKills > 0);
+}
+
+static void printEntry(const struct replay_entry* entry)
+{
+    printf("%s  mode %d  %u ticks  winner %d with %d  %u deaths  %u eaten", entry->name, entry->gameType,
+           entry->ticks, entry->winner == EVENT_NO_PLAYER ? -1 : entry->winner, entry->winnerScore,
+           entry->counts[EVENT_DEATH], entry->counts[EVENT_EATEN]);
+    if(entry->suddenDeathTick != REPLAY_NO_TICK)
+    {
+        printf("  sudden death from %u: %u eaten, %u kills", entry->suddenDeathTick, entry->suddenDeathEaten,
+               entry->suddenDeathKills);
+    }
+    printf("\n");
+}
+
+// maps path read only, NULL if it can't be or is empty
+static const void* mapFile(const char* path, size_t* size)
+{
+    struct stat info;
+    void* data = NULL;
+    int fd = open(path, O_RDONLY);
+
+    if(fd < 0)
+    {
+        return NULL;
+    }
+
+    if(fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+    *size = (size_t)info.st_size;
+    return data;
+}
+
+static int isReplay(const struct dirent* file)
+{
+    size_t length = strlen(file->d_name);
+
+    return length > 4 && length < REPLAY_NAME_SIZE && strcmp(file->d_name + length - 4, ".tsp") == 0;
+}
+
+// every replay in dir in name order: summarized, filtered, printed or indexed
+static int scanDirectory(const char* dir, struct scan* scan)
+{
+    struct dirent** files = NULL;
+    char path[4096];
+    int count = scandir(dir, &files, isReplay, alphasort);
+
+    if(count < 0)
+    {
+        printf("can't read %s\n", dir);
+        return 0;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        const struct replay_header* header = NULL;
+        struct replay_entry entry;
+        const void* data = NULL;
+        size_t size = 0;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, files[i]->d_name);
+        data = mapFile(path, &size);
+        header = data != NULL ? replayHeader(data, size) : NULL;
+        if(header == NULL)
+        {
+            printf("%s isn't a replay\n", path);
+        }
+        else
+        {
+            replaySummarize(header, &entry);
+            strcpy(entry.name, files[i]->d_name);
+            scan->files++;
+            scan->bytes += size;
+
+            if(scan->index != NULL)
+            {
+                fwrite(&entry, sizeof(entry), 1, scan->index);
+            }
+            else if(matches(&scan->filter, &entry) == 1)
+            {
+                printEntry(&entry);
+                scan->matched++;
+            }
+        }
+
+        if(data != NULL)
+        {
+            munmap((void*)data, size);
+        }
+        free(files[i]);
+    }
+
+    free(files);
+    return 1;
+}
+
+static int record(const char* dir, int count, unsigned int seed)
+{
+    static struct world world;
+    struct replay_recorder recorder = {0};
+    struct gym_config config;
+    unsigned char controls[MAX_PLAYERS];
+    char path[4096];
+
+    mkdir(dir, 0777);
+    worldInit();
+    gymDefaultConfig(&config);
+
+    for(int match = 0; match < count; match++)
+    {
+        unsigned int matchSeed = seed + (unsigned int)match;
+        unsigned int random = matchSeed * 2654435761u | 1;
+        int over = 0;
+
+        config.gameType = match % NUM_GAME_TYPES;
+        replayBegin(&recorder, &config, matchSeed);
+        gymStartMatch(&config, &world);
+
+        while(over == 0)
+        {
+            // quick bots, their own random numbers so the inputs replay without them
+            searchQuickControls(&g_Board, &world, controls, &random);
+            over = gymStepMatch(&config, &world, controls);
+            replayTick(&recorder, &world, controls);
+        }
+
+        snprintf(path, sizeof(path), "%s/%08u.tsp", dir, matchSeed);
+        if(replayEnd(&recorder, &world, path) == 0)
+        {
+            printf("can't write %s\n", path);
+            replayFree(&recorder);
+            return 1;
+        }
+    }
+
+    replayFree(&recorder);
+    printf("%d replays in %s\n", count, dir);
+    return 0;
+}
+
+static int buildIndex(const char* dir, const char* path)
+{
+    struct index_header header = {INDEX_MAGIC, INDEX_VERSION, 0, sizeof(struct replay_entry)};
+    struct scan scan = {0};
+    double start = seconds();
+    double elapsed = 0;
+    int ok = 1;
+
+    scan.index = fopen(path, "wb");
+    if(scan.index == NULL)
+    {
+        printf("can't write %s\n", path);
+        return 1;
+    }
+
+    // the count goes in once it's known
+    ok &= fwrite(&header, sizeof(header), 1, scan.index) == 1;
+    ok &= scanDirectory(dir, &scan);
+    header.count = scan.files;
+    ok &= fseek(scan.index, 0, SEEK_SET) == 0;
+    ok &= fwrite(&header, sizeof(header), 1, scan.index) == 1;
+    ok &= fclose(scan.index) == 0;
+    elapsed = seconds() - start;
+
+    if(ok == 0)
+    {
+        printf("writing %s failed\n", path);
+        return 1;
+    }
+
+    printf("%u replays, %.1f MB indexed at %.0f MB per second\n", scan.files, scan.bytes / 1e6,
+           elapsed > 0 ? scan.bytes / 1e6 / elapsed : 0);
+    return 0;
+}
+
+static int query(const char* path, const struct filter* filter)
+{
+    const struct index_header* header = NULL;
+    const struct replay_entry* entries = NULL;
+    const void* data = NULL;
+    size_t size = 0;
+    unsigned int matched = 0;
+    double start = seconds();
+
+    data = mapFile(path, &size);
+    header = (const struct index_header*)data;
+    if(data == NULL || size < sizeof(*header) || header->magic != INDEX_MAGIC || header->version != INDEX_VERSION ||
+       header->entrySize != sizeof(struct replay_entry) ||
+       size < sizeof(*header) + (size_t)header->count * sizeof(struct replay_entry))
+    {
+        printf("%s isn't an index from this build\n", path);
+        return 1;
+    }
+
+    entries = (const struct replay_entry*)(header + 1);
+    for(unsigned int i = 0; i < header->count; i++)
+    {
+        if(matches(filter, &entries[i]) == 1)
+        {
+            printEntry(&entries[i]);
+            matched++;
+        }
+    }
+
+    printf("%u of %u replays match, %.3f ms\n", matched, header->count, (seconds() - start) * 1e3);
+    munmap((void*)data, size);
+    return 0;
+}
+
+static int scanReplays(const char* dir, const struct filter* filter)
+{
+    struct scan scan = {0};
+    double start = seconds();
+    double elapsed = 0;
+
+    scan.filter = *filter;
+    if(scanDirectory(dir, &scan) == 0)
+    {
+        return 1;
+    }
+    elapsed = seconds() - start;
+
+    printf("%u of %u replays match, %.1f MB scanned at %.0f MB per second\n", scan.matched, scan.files,
+           scan.bytes / 1e6, elapsed > 0 ? scan.bytes / 1e6 / elapsed : 0);
+    return 0;
+}
+
+static int check(int count, char** paths)
+{
+    int failed = 0;
+
+    worldInit();
+    for(int i = 0; i < count; i++)
+    {
+        const struct replay_header* header = NULL;
+        size_t size = 0;
+        const void* data = mapFile(paths[i], &size);
+        unsigned int tick = 0;
+
+        header = data != NULL ? replayHeader(data, size) : NULL;
+        if(header == NULL)
+        {
+            printf("%s: not a replay\n", paths[i]);
+            failed++;
+        }
+        else if((tick = replayCheck(header)) == REPLAY_INCOMPATIBLE)
+        {
+            printf("%s: played with %u players, this build has %d\n", paths[i], header->players, MAX_PLAYERS);
+            failed++;
+        }
+        else if(tick == header->ticks)
+        {
+            printf("%s: every tick matches, the end doesn't\n", paths[i]);
+            failed++;
+        }
+        else if(tick != REPLAY_NO_TICK)
+        {
+            printf("%s: plays out differently from tick %u\n", paths[i], tick);
+            failed++;
+        }
+
+        if(data != NULL)
+        {
+            munmap((void*)data, size);
+        }
+    }
+
+    printf("%d of %d replays play out the same\n", count - failed, count);
+    return failed > 0;
+}
+
+int main(int argc, char** argv)
+{
+    struct filter filter;
+
+    if(argc >= 4 && strcmp(argv[1], "record") == 0)
+    {
+        return record(argv[2], atoi(argv[3]), argc > 4 ? (unsigned int)atoi(argv[4]) : 1);
+    }
+
+    if(argc == 4 && strcmp(argv[1], "index") == 0)
+    {
+        return buildIndex(argv[2], argv[3]);
+    }
+
+    if(argc >= 3 && strcmp(argv[1], "query") == 0)
+    {
+        return parseFilter(&filter, argc - 3, argv + 3) == 1 ? query(argv[2], &filter) : 1;
+    }
+
+    if(argc >= 3 && strcmp(argv[1], "scan") == 0)
+    {
+        return parseFilter(&filter, argc - 3, argv + 3) == 1 ? scanReplays(argv[2], &filter) : 1;
+    }
+
+    if(argc >= 3 && strcmp(argv[1], "check") == 0)
+    {
+        return check(argc - 2, argv + 2);
+    }
+
+    printf("usage: replays record dir count [seed] | index dir file | query file [filter...] |\n"
+           "               scan dir [filter...] | check file...\n");
+    return 1;
+}
@@ -0,0 +1,586 @@
+/*
+Twelve Snakes - match results in a columnar file on Linux
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "results.h"
+
+#define RESULTS_HEADER_SIZE (16 + RESULTS_COLUMNS * (RESULTS_NAME_SIZE + 4))
+#define RESULTS_GROUP_HEADER 16
+#define RESULTS_FOOTER_SIZE 16
+#define RESULTS_CSV_BUFFER (1 << 20)
+#define RESULTS_CSV_FIELD 12 // sign and 10 digits, rounded up
+#define RESULTS_CSV_ROW (RESULTS_COLUMNS * RESULTS_CSV_FIELD)
+
+const char* const g_ResultsNames[RESULTS_COLUMNS] =
+{
+    "seed", "match", "mode", "lives", "maxScore", "maxTime", "ticks", "player",
+    "R#", "L#", "M#", "A#", "K#", "C#", "D#", "S#",
+};
+
+// big enough for any player count and a long headless run
+const unsigned char g_ResultsWidths[RESULTS_COLUMNS] =
+{
+    4, 4, 1, 2, 2, 2, 4, 1,
+    1, 2, 2, 4, 4, 4, 4, 4,
+};
+
+static void put32(unsigned char* out, unsigned int value)
+{
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+    out[2] = (unsigned char)(value >> 16);
+    out[3] = (unsigned char)(value >> 24);
+}
+
+static unsigned int get32(const unsigned char* in)
+{
+    return in[0] | in[1] << 8 | in[2] << 16 | (unsigned int)in[3] << 24;
+}
+
+static int rowBytes()
+{
+    int bytes = 0;
+
+    for(int i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        bytes += g_ResultsWidths[i];
+    }
+
+    return bytes;
+}
+
+// where each column of a group of rows starts
+static void placeColumns(unsigned char** columns, unsigned char* base, int rows)
+{
+    for(int i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        columns[i] = base;
+        base += (size_t)rows * g_ResultsWidths[i];
+    }
+}
+
+// FNV-1a a word at a time, each column's values on their own
+static unsigned long long checksumBytes(unsigned long long hash, const unsigned char* data, size_t size)
+{
+    size_t i = 0;
+
+    for(; i + 8 <= size; i += 8)
+    {
+        unsigned long long word = 0;
+
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x100000001B3ull;
+    }
+
+    for(; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+static unsigned int checksumGroup(unsigned char* const* columns, int rows)
+{
+    unsigned long long hash = 0xCBF29CE484222325ull;
+
+    for(int i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        hash = checksumBytes(hash, columns[i], (size_t)rows * g_ResultsWidths[i]);
+    }
+
+    return (unsigned int)(hash ^ hash >> 32);
+}
+
+//
+// writing
+//
+
+static void writeBytes(struct results_writer* writer, const void* data, size_t size)
+{
+    if(writer->failed == 0 && fwrite(data, 1, size, writer->file) != size)
+    {
+        writer->failed = 1;
+    }
+}
+
+static void writeFooter(struct results_writer* writer)
+{
+    unsigned char footer[RESULTS_FOOTER_SIZE];
+
+    memcpy(footer, "TSRF", 4);
+    put32(footer + 4, writer->groups);
+    put32(footer + 8, (unsigned int)writer->totalRows);
+    put32(footer + 12, (unsigned int)(writer->totalRows >> 32));
+    writeBytes(writer, footer, sizeof(footer));
+
+    // everything up to here survives the run dying
+    if(writer->failed == 0 && fflush(writer->file) != 0)
+    {
+        writer->failed = 1;
+    }
+}
+
+static void writeGroup(struct results_writer* writer)
+{
+    unsigned char header[RESULTS_GROUP_HEADER];
+    int rows = writer->rows;
+
+    memcpy(header, "TSRG", 4);
+    put32(header + 4, (unsigned int)rows);
+    put32(header + 8, (unsigned int)(rows * rowBytes()));
+    put32(header + 12, checksumGroup(writer->columns, rows));
+    writeBytes(writer, header, sizeof(header));
+
+    // a short group leaves a gap after each column in the buffer
+    for(int i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        writeBytes(writer, writer->columns[i], (size_t)rows * g_ResultsWidths[i]);
+    }
+
+    writer->groups++;
+    writer->totalRows += rows;
+    writer->rows = 0;
+    writeFooter(writer);
+}
+
+struct results_writer* resultsCreate(const char* path)
+{
+    struct results_writer* writer = calloc(1, sizeof(*writer));
+    unsigned char header[RESULTS_HEADER_SIZE] = {0};
+    unsigned char* p = header + 16;
+    unsigned char* base = NULL;
+
+    if(writer == NULL)
+    {
+        return NULL;
+    }
+
+    base = malloc((size_t)RESULTS_GROUP_ROWS * rowBytes());
+    writer->file = fopen(path, "wb");
+    if(base == NULL || writer->file == NULL)
+    {
+        if(writer->file != NULL)
+        {
+            fclose(writer->file);
+        }
+        free(base);
+        free(writer);
+        return NULL;
+    }
+    placeColumns(writer->columns, base, RESULTS_GROUP_ROWS);
+
+    memcpy(header, "TSRS", 4);
+    put32(header + 4, RESULTS_VERSION);
+    put32(header + 8, RESULTS_COLUMNS);
+    put32(header + 12, RESULTS_GROUP_ROWS);
+    for(int i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        strncpy((char*)p, g_ResultsNames[i], RESULTS_NAME_SIZE);
+        put32(p + RESULTS_NAME_SIZE, g_ResultsWidths[i]);
+        p += RESULTS_NAME_SIZE + 4;
+    }
+    writeBytes(writer, header, sizeof(header));
+    writeFooter(writer);
+
+    return writer;
+}
+
+void resultsAppend(struct results_writer* writer, const unsigned int* values)
+{
+    for(int i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        int width = g_ResultsWidths[i];
+        unsigned char* out = writer->columns[i] + (size_t)writer->rows * width;
+
+        switch(width)
+        {
+            case 1:
+                out[0] = (unsigned char)values[i];
+                break;
+
+            case 2:
+                out[0] = (unsigned char)values[i];
+                out[1] = (unsigned char)(values[i] >> 8);
+                break;
+
+            default:
+                put32(out, values[i]);
+                break;
+        }
+    }
+
+    writer->rows++;
+    if(writer->rows == RESULTS_GROUP_ROWS)
+    {
+        writeGroup(writer);
+    }
+}
+
+// everyone who played, in the order displayScore() shows them
+void resultsAddMatch(struct results_writer* writer, const struct world* world, unsigned int seed, unsigned int match)
+{
+    const struct options* options = &world->options;
+    int order[MAX_PLAYERS];
+    int rank = 1;
+
+    // insertionSort(), highest score first and ties in slot order
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        int j = i - 1;
+
+        while(j >= 0 && world->players[order[j]].score < world->players[i].score)
+        {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = i;
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        const struct snake* player = &world->players[order[i]];
+        unsigned int values[RESULTS_COLUMNS];
+
+        if(player->everActive == 0)
+        {
+            continue;
+        }
+
+        values[RESULTS_SEED] = seed;
+        values[RESULTS_MATCH] = match;
+        values[RESULTS_MODE] = (unsigned int)options->gameType;
+        values[RESULTS_LIVES] = (unsigned int)options->maxLives;
+        values[RESULTS_MAX_SCORE] = (unsigned int)options->maxScore;
+        values[RESULTS_MAX_TIME] = (unsigned int)options->maxTime;
+        values[RESULTS_TICKS] = options->tick;
+        values[RESULTS_PLAYER] = (unsigned int)order[i];
+        values[RESULTS_RANK] = (unsigned int)rank++;
+        values[RESULTS_LENGTH] = (unsigned int)player->currLength;
+        values[RESULTS_MAX_LENGTH] = (unsigned int)player->maxLength;
+        values[RESULTS_APPLES] = (unsigned int)player->numApples;
+        values[RESULTS_KILLS] = (unsigned int)player->numKills;
+        values[RESULTS_EATEN] = (unsigned int)player->numPlayersEaten;
+        values[RESULTS_DEATHS] = (unsigned int)player->numDeaths;
+        values[RESULTS_SCORE] = (unsigned int)player->score;
+        resultsAppend(writer, values);
+    }
+}
+
+int resultsClose(struct results_writer* writer)
+{
+    int ok = 0;
+
+    if(writer->rows > 0)
+    {
+        writeGroup(writer);
+    }
+
+    ok = writer->failed == 0;
+    if(fclose(writer->file) != 0)
+    {
+        ok = 0;
+    }
+
+    free(writer->columns[0]);
+    free(writer);
+    return ok;
+}
+
+//
+// reading
+//
+
+struct results_reader* resultsOpen(const char* path)
+{
+    struct results_reader* reader = calloc(1, sizeof(*reader));
+    unsigned char header[RESULTS_HEADER_SIZE];
+    int matches = 0;
+
+    if(reader == NULL)
+    {
+        return NULL;
+    }
+
+    reader->file = fopen(path, "rb");
+    reader->columns[0] = malloc((size_t)RESULTS_GROUP_ROWS * rowBytes());
+    if(reader->file != NULL && reader->columns[0] != NULL &&
+       fread(header, 1, sizeof(header), reader->file) == sizeof(header) && memcmp(header, "TSRS", 4) == 0 &&
+       get32(header + 4) == RESULTS_VERSION && get32(header + 8) == RESULTS_COLUMNS &&
+       get32(header + 12) == RESULTS_GROUP_ROWS)
+    {
+        matches = 1;
+        for(int i = 0; i < RESULTS_COLUMNS; i++)
+        {
+            if(get32(header + 16 + i * (RESULTS_NAME_SIZE + 4) + RESULTS_NAME_SIZE) != g_ResultsWidths[i])
+            {
+                matches = 0;
+            }
+        }
+    }
+
+    if(matches == 0)
+    {
+        resultsCloseReader(reader);
+        return NULL;
+    }
+
+    return reader;
+}
+
+int resultsNextGroup(struct results_reader* reader)
+{
+    unsigned char header[RESULTS_GROUP_HEADER];
+    unsigned char* base = reader->columns[0];
+    size_t got = 0;
+    int rows = 0;
+
+    reader->rows = 0;
+    if(reader->damaged == 1)
+    {
+        return 0;
+    }
+
+    // footers only matter to something that reads the end of the file
+    do
+    {
+        got = fread(header, 1, sizeof(header), reader->file);
+    }
+    while(got == sizeof(header) && memcmp(header, "TSRF", 4) == 0);
+
+    if(got == 0)
+    {
+        return 0;
+    }
+
+    rows = (int)get32(header + 4);
+    if(got < sizeof(header) || memcmp(header, "TSRG", 4) != 0 || rows <= 0 || rows > RESULTS_GROUP_ROWS ||
+       get32(header + 8) != (unsigned int)(rows * rowBytes()) ||
+       fread(base, 1, (size_t)rows * rowBytes(), reader->file) != (size_t)rows * rowBytes())
+    {
+        reader->damaged = 1;
+        return 0;
+    }
+
+    placeColumns(reader->columns, base, rows);
+    if(checksumGroup(reader->columns, rows) != get32(header + 12))
+    {
+        reader->damaged = 1;
+        return 0;
+    }
+
+    reader->rows = rows;
+    reader->groups++;
+    reader->totalRows += rows;
+    return rows;
+}
+
+unsigned int resultsValue(const struct results_reader* reader, int column, int row)
+{
+    int width = g_ResultsWidths[column];
+    const unsigned char* in = reader->columns[column] + (size_t)row * width;
+    unsigned int value = 0;
+
+    for(int b = width - 1; b >= 0; b--)
+    {
+        value = value << 8 | in[b];
+    }
+
+    return value;
+}
+
+void resultsCloseReader(struct results_reader* reader)
+{
+    if(reader->file != NULL)
+    {
+        fclose(reader->file);
+    }
+
+    free(reader->columns[0]);
+    free(reader);
+}
+
+//
+// CSV
+//
+
+#define RESULTS_CSV_SMALL 1000
+
+static char g_DigitPairs[200]; // "00" to "99"
+static char g_SmallText[RESULTS_CSV_SMALL][4]; // most values in a results file, ready to copy
+static unsigned char g_SmallLength[RESULTS_CSV_SMALL];
+
+static char* csvNumber(char* out, unsigned int value)
+{
+    char digits[10];
+    char* p = digits + sizeof(digits);
+    int length = 0;
+
+    while(value >= 100)
+    {
+        p -= 2;
+        memcpy(p, &g_DigitPairs[(value % 100) * 2], 2);
+        value /= 100;
+    }
+
+    if(value >= 10)
+    {
+        p -= 2;
+        memcpy(p, &g_DigitPairs[value * 2], 2);
+    }
+    else
+    {
+        *--p = (char)('0' + value);
+    }
+
+    length = (int)(digits + sizeof(digits) - p);
+    memcpy(out, p, (size_t)length);
+    return out + length;
+}
+
+static void makeCsvTables()
+{
+    for(int i = 0; i < 100; i++)
+    {
+        g_DigitPairs[i * 2] = (char)('0' + i / 10);
+        g_DigitPairs[i * 2 + 1] = (char)('0' + i % 10);
+    }
+
+    for(int i = 0; i < RESULTS_CSV_SMALL; i++)
+    {
+        g_SmallLength[i] = (unsigned char)(csvNumber(g_SmallText[i], (unsigned int)i) - g_SmallText[i]);
+    }
+}
+
+// one column of a group as plain numbers
+static void decodeColumn(unsigned int* out, const unsigned char* in, int width, int rows)
+{
+    switch(width)
+    {
+        case 1:
+            for(int row = 0; row < rows; row++)
+            {
+                out[row] = in[row];
+            }
+            break;
+
+        case 2:
+            for(int row = 0; row < rows; row++)
+            {
+                out[row] = in[row * 2] | in[row * 2 + 1] << 8;
+            }
+            break;
+
+        default:
+            for(int row = 0; row < rows; row++)
+            {
+                out[row] = get32(in + row * 4);
+            }
+            break;
+    }
+}
+
+long long resultsCsv(const char* path, FILE* out)
+{
+    struct results_reader* reader = resultsOpen(path);
+    unsigned int* values = NULL;
+    char* buffer = NULL;
+    char* p = NULL;
+    unsigned int last[RESULTS_COLUMNS] = {0};
+    char text[RESULTS_COLUMNS][RESULTS_CSV_FIELD] = {{0}};
+    unsigned char length[RESULTS_COLUMNS] = {0}; // of text, 0 until a value is cached
+    int rows = 0;
+    int failed = 0;
+    long long written = 0;
+
+    if(reader == NULL)
+    {
+        return -1;
+    }
+
+    values = malloc((size_t)RESULTS_COLUMNS * RESULTS_GROUP_ROWS * sizeof(unsigned int));
+    buffer = malloc(RESULTS_CSV_BUFFER);
+    if(values == NULL || buffer == NULL)
+    {
+        free(values);
+        free(buffer);
+        resultsCloseReader(reader);
+        return -1;
+    }
+
+    makeCsvTables();
+
+    p = buffer;
+    for(int i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        p = stpcpy(p, g_ResultsNames[i]);
+        *p++ = i + 1 < RESULTS_COLUMNS ? ',' : '\n';
+    }
+
+    while((rows = resultsNextGroup(reader)) > 0)
+    {
+        for(int i = 0; i < RESULTS_COLUMNS; i++)
+        {
+            decodeColumn(&values[(size_t)i * RESULTS_GROUP_ROWS], reader->columns[i], g_ResultsWidths[i], rows);
+        }
+
+        for(int row = 0; row < rows; row++)
+        {
+            if(p - buffer > RESULTS_CSV_BUFFER - RESULTS_CSV_ROW)
+            {
+                failed |= fwrite(buffer, 1, (size_t)(p - buffer), out) != (size_t)(p - buffer);
+                p = buffer;
+            }
+
+            for(int i = 0; i < RESULTS_COLUMNS; i++)
+            {
+                unsigned int value = values[(size_t)i * RESULTS_GROUP_ROWS + row];
+
+                // the copies are always the whole field, the next one writes over the rest
+                if(value < RESULTS_CSV_SMALL)
+                {
+                    memcpy(p, g_SmallText[value], 4);
+                    p += g_SmallLength[value];
+                }
+                else
+                {
+                    if(length[i] == 0 || value != last[i])
+                    {
+                        char* end = text[i];
+
+                        if(i == RESULTS_SCORE && (int)value < 0)
+                        {
+                            *end++ = '-';
+                            end = csvNumber(end, 0u - value);
+                        }
+                        else
+                        {
+                            end = csvNumber(end, value);
+                        }
+
+                        length[i] = (unsigned char)(end - text[i]);
+                        last[i] = value;
+                    }
+
+                    memcpy(p, text[i], RESULTS_CSV_FIELD);
+                    p += length[i];
+                }
+
+                *p++ = ',';
+            }
+            p[-1] = '\n';
+        }
+
+        written += rows;
+    }
+
+    failed |= fwrite(buffer, 1, (size_t)(p - buffer), out) != (size_t)(p - buffer);
+    failed |= fflush(out) != 0;
+
+    free(values);
+    free(buffer);
+    resultsCloseReader(reader);
+    return failed == 0 ? written : -1;
+}
@@ -0,0 +1,93 @@
+/*
+Twelve Snakes - match results in a columnar file on Linux
+
+One row per player per match, with the score screen's columns R# L# M# A#
+K# C# D# S# after the match's seed, number, mode, options, ticks played and
+the player's slot. Rows are kept a row group at a time, each column's values
+back to back in as few bytes as the column needs, so the writer's memory is
+one group whatever the number of rows and appending a row allocates nothing.
+
+The file, little endian throughout:
+
+    header  "TSRS", version, column count, rows per group, then each
+            column's name (RESULTS_NAME_SIZE bytes, NUL padded) and width
+    group   "TSRG", rows, bytes, checksum, then every column's values
+    footer  "TSRF", groups so far, rows so far (8 bytes)
+    group, footer, group, footer, ...
+
+A footer goes out and the file is flushed after every group, so a run that
+dies only loses the group it was filling. A reader walks the groups from the
+front and stops at the first one that is cut short or doesn't match its
+checksum; whatever came before it reads as written.
+
+resultsCsv() turns a file back into text a group at a time. Rows of one
+match repeat the same seed, mode and options, so each column remembers the
+text of its last value and copies it when the value comes round again.
+*/
+
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include <stdio.h>
+#include "../world.h"
+
+#define RESULTS_VERSION 1
+#define RESULTS_GROUP_ROWS 65536
+#define RESULTS_NAME_SIZE 12
+
+// columns, in file order
+#define RESULTS_SEED       0
+#define RESULTS_MATCH      1 // counts the matches written with the seed
+#define RESULTS_MODE       2 // GAME_*
+#define RESULTS_LIVES      3 // options the mode ends on
+#define RESULTS_MAX_SCORE  4
+#define RESULTS_MAX_TIME   5
+#define RESULTS_TICKS      6 // played
+#define RESULTS_PLAYER     7 // slot
+#define RESULTS_RANK       8 // R#, the score screen's order
+#define RESULTS_LENGTH     9 // L#
+#define RESULTS_MAX_LENGTH 10 // M#
+#define RESULTS_APPLES     11 // A#
+#define RESULTS_KILLS      12 // K#
+#define RESULTS_EATEN      13 // C#
+#define RESULTS_DEATHS     14 // D#
+#define RESULTS_SCORE      15 // S#, the only signed column
+#define RESULTS_COLUMNS    16
+
+struct results_writer
+{
+    FILE* file;
+    unsigned char* columns[RESULTS_COLUMNS]; // RESULTS_GROUP_ROWS values each, one allocation
+    int rows; // in the group being filled
+    unsigned int groups; // written
+    unsigned long long totalRows; // written
+    int failed; // a write went wrong, the rest are skipped
+};
+
+struct results_reader
+{
+    FILE* file;
+    unsigned char* columns[RESULTS_COLUMNS]; // the group read last
+    int rows; // in it
+    unsigned int groups; // read
+    unsigned long long totalRows; // read
+    int damaged; // stopped at a group that was cut short or didn't check out
+};
+
+extern const char* const g_ResultsNames[RESULTS_COLUMNS];
+extern const unsigned char g_ResultsWidths[RESULTS_COLUMNS]; // bytes
+
+struct results_writer* resultsCreate(const char* path); // NULL if it can't be written
+void resultsAppend(struct results_writer* writer, const unsigned int* values); // RESULTS_COLUMNS of them
+void resultsAddMatch(struct results_writer* writer, const struct world* world, unsigned int seed, unsigned int match);
+int resultsClose(struct results_writer* writer); // writes the last group, 1 if every write went through
+
+struct results_reader* resultsOpen(const char* path); // NULL if it isn't a results file
+int resultsNextGroup(struct results_reader* reader); // rows in the next group, 0 once there are none
+unsigned int resultsValue(const struct results_reader* reader, int column, int row); // S# as two's complement
+void resultsCloseReader(struct results_reader* reader);
+
+// the whole file as CSV with a header line, returns the rows or -1
+long long resultsCsv(const char* path, FILE* out);
+
+#endif
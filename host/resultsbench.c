@@ -0,0 +1,192 @@
+/*
+Twelve Snakes - how fast results files write and export
+
+Writes rows of made up twelve player matches with results.h, reads them
+back and checks every value, times the CSV export, then cuts the file off
+in the middle of its last group and checks that every group before it still
+reads.
+
+    resultsbench [rows] [file]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "results.h"
+#include "timer.h"
+
+#define TEMPLATE_ROWS 4096
+#define MATCH_PLAYERS 12
+
+static unsigned int g_Templates[TEMPLATE_ROWS][RESULTS_COLUMNS];
+
+static unsigned int nextRandom(unsigned int* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+// scores like a match's, the match number comes from the row
+static void makeTemplates(unsigned int seed)
+{
+    unsigned int state = seed | 1;
+
+    for(int row = 0; row < TEMPLATE_ROWS; row++)
+    {
+        unsigned int* values = g_Templates[row];
+
+        values[RESULTS_SEED] = seed;
+        values[RESULTS_MODE] = GAME_FREE_FOR_ALL;
+        values[RESULTS_LIVES] = 3;
+        values[RESULTS_MAX_SCORE] = 50;
+        values[RESULTS_MAX_TIME] = 0;
+        values[RESULTS_TICKS] = 1000;
+        values[RESULTS_PLAYER] = nextRandom(&state) % MATCH_PLAYERS;
+        values[RESULTS_RANK] = row % MATCH_PLAYERS + 1;
+        values[RESULTS_LENGTH] = nextRandom(&state) % 40 + 1;
+        values[RESULTS_MAX_LENGTH] = values[RESULTS_LENGTH] + nextRandom(&state) % 60;
+        values[RESULTS_APPLES] = nextRandom(&state) % 30;
+        values[RESULTS_KILLS] = nextRandom(&state) % 8;
+        values[RESULTS_EATEN] = nextRandom(&state) % 4;
+        values[RESULTS_DEATHS] = nextRandom(&state) % 12;
+        values[RESULTS_SCORE] = (unsigned int)((int)(nextRandom(&state) % 120) - 10);
+    }
+}
+
+static void makeRow(unsigned int* values, unsigned long long row)
+{
+    for(int i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        values[i] = g_Templates[row % TEMPLATE_ROWS][i];
+    }
+    values[RESULTS_MATCH] = (unsigned int)(row / MATCH_PLAYERS);
+}
+
+// rows read, -1 if a value differs from what was written
+static long long readBack(const char* path, int* damaged)
+{
+    struct results_reader* reader = resultsOpen(path);
+    unsigned int values[RESULTS_COLUMNS];
+    long long row = 0;
+    int rows = 0;
+
+    if(reader == NULL)
+    {
+        return -1;
+    }
+
+    while((rows = resultsNextGroup(reader)) > 0)
+    {
+        for(int k = 0; k < rows; k++, row++)
+        {
+            makeRow(values, (unsigned long long)row);
+            for(int i = 0; i < RESULTS_COLUMNS; i++)
+            {
+                if(resultsValue(reader, i, k) != values[i])
+                {
+                    printf("row %lld column %s: read %u, wrote %u\n", row, g_ResultsNames[i],
+                           resultsValue(reader, i, k), values[i]);
+                    resultsCloseReader(reader);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    *damaged = reader->damaged;
+    resultsCloseReader(reader);
+    return row;
+}
+
+int main(int argc, char** argv)
+{
+    long long rows = argc > 1 ? atoll(argv[1]) : 20000000;
+    const char* path = argc > 2 ? argv[2] : "/tmp/resultsbench.tsr";
+    struct results_writer* writer = NULL;
+    unsigned int values[RESULTS_COLUMNS];
+    FILE* sink = NULL;
+    long long read = 0;
+    long long exported = 0;
+    long long cutRows = 0;
+    long long size = 0;
+    int damaged = 0;
+    double start = 0;
+    double elapsed = 0;
+
+    makeTemplates(1);
+
+    writer = resultsCreate(path);
+    if(writer == NULL)
+    {
+        printf("can't write %s\n", path);
+        return 1;
+    }
+
+    start = seconds();
+    for(long long row = 0; row < rows; row++)
+    {
+        makeRow(values, (unsigned long long)row);
+        resultsAppend(writer, values);
+    }
+    if(resultsClose(writer) == 0)
+    {
+        printf("writing %s failed\n", path);
+        return 1;
+    }
+    elapsed = seconds() - start;
+    printf("%lld rows written: %.1f million rows per second\n", rows, elapsed > 0 ? rows / elapsed / 1e6 : 0);
+
+    read = readBack(path, &damaged);
+    if(read != rows || damaged == 1)
+    {
+        printf("read back %lld rows of %lld%s\n", read, rows, damaged == 1 ? ", the file is damaged" : "");
+        return 1;
+    }
+    printf("%lld rows read back as written\n", read);
+
+    sink = fopen("/dev/null", "wb");
+    start = seconds();
+    exported = sink != NULL ? resultsCsv(path, sink) : -1;
+    elapsed = seconds() - start;
+    if(sink != NULL)
+    {
+        fclose(sink);
+    }
+    if(exported != rows)
+    {
+        printf("exported %lld rows of %lld as CSV\n", exported, rows);
+        return 1;
+    }
+    printf("%lld rows exported as CSV: %.1f million rows per second\n", exported,
+           elapsed > 0 ? exported / elapsed / 1e6 : 0);
+
+    // the last group loses its last few bytes, as if the run died writing it
+    if(rows > 0)
+    {
+        sink = fopen(path, "rb");
+        fseek(sink, 0, SEEK_END);
+        size = ftell(sink);
+        fclose(sink);
+
+        cutRows = (rows - 1) / RESULTS_GROUP_ROWS * RESULTS_GROUP_ROWS;
+        if(truncate(path, size - 32) != 0)
+        {
+            printf("can't cut %s short\n", path);
+            return 1;
+        }
+
+        read = readBack(path, &damaged);
+        if(read != cutRows || damaged == 0)
+        {
+            printf("cut short, %lld rows read, expected %lld\n", read, cutRows);
+            return 1;
+        }
+        printf("cut off in the last group, the %lld rows before it still read\n", read);
+    }
+
+    remove(path);
+    return 0;
+}
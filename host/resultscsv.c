@@ -0,0 +1,32 @@
+/*
+Twelve Snakes - a results file as CSV
+
+Writes every row of a file from results.h to standard output with a header
+line. A file that was cut short exports up to its last complete group.
+
+    resultscsv file > results.csv
+*/
+
+#include <stdio.h>
+#include "results.h"
+
+int main(int argc, char** argv)
+{
+    long long rows = 0;
+
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: resultscsv file\n");
+        return 1;
+    }
+
+    rows = resultsCsv(argv[1], stdout);
+    if(rows < 0)
+    {
+        fprintf(stderr, "can't export %s\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(stderr, "%lld rows\n", rows);
+    return 0;
+}
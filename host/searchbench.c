@@ -0,0 +1,414 @@
+/*
+Twelve Snakes - how fast and how well the lookahead bot plays
+
+Plays free for alls with the quick policy in every slot, some moves aimed
+at other snakes' heads so snakes eat each other, and checks that
+searchMake() ends up where worldStep() does for the same moves, and that
+searchUnmake() puts the board back exactly. The world's and the board's
+hashes are checked against hashing them from scratch every tick. Then times searchControl() on a
+busy board and plays matches with search bots in the first slots against
+quick bots in the rest, counting deaths.
+
+    searchbench [matches] [ticks] [seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../search.h"
+#include "timer.h"
+
+#define CHECK_TICKS 2000
+#define CHECK_DEPTH 4
+#define SEARCH_BOTS 3
+#define BENCH_ITERATIONS 256
+#define BENCH_DEPTH 8
+#define BENCH_NODES 4096
+#define BENCH_TABLE 4096
+
+static const signed char STEP_X[4] = {0, 0, 1, -1};
+static const signed char STEP_Y[4] = {-1, 1, 0, 0};
+
+static struct search g_Search;
+static struct search_node g_Nodes[BENCH_NODES];
+static struct search_entry g_Table[BENCH_TABLE];
+
+static void startMatch(struct world* world, unsigned int seed)
+{
+    srand(seed);
+    worldReset(world);
+    world->options.gameType = GAME_FREE_FOR_ALL;
+    world->options.slowdown = INITIAL_SLOWDOWN;
+    worldStart(world);
+}
+
+// the quick policy for everyone, dead snakes join
+static void quickMoves(const struct search_board* board, unsigned char* moves, unsigned char* controls,
+                       unsigned int* random)
+{
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        moves[i] = SEARCH_STRAIGHT;
+        controls[i] = CONTROL_JOIN;
+        if(board->alive[i] == 1)
+        {
+            moves[i] = (unsigned char)searchQuickMove(board, i, random);
+            controls[i] = CONTROL_TURN | SEARCH_TURNS[board->dir[i]][moves[i]];
+        }
+    }
+}
+
+// where player's head goes with move
+static unsigned short destination(const struct search_board* board, int player, int move)
+{
+    unsigned short head = board->cells[player][board->head[player]];
+    int dir = SEARCH_TURNS[board->dir[player]][move];
+
+    return (unsigned short)(((((head >> 6) + STEP_Y[dir]) & 63) << 6) | (((head & 63) + STEP_X[dir]) & 63));
+}
+
+//
+// The quick policy never steps into a body, so now and then a snake steers
+// onto another's head instead: that head is a neck once both have moved,
+// or, if the other snake came the same way, they meet head on.
+//
+static void aimMoves(const struct search_board* board, unsigned char* moves, unsigned char* controls,
+                     unsigned int* random)
+{
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        *random = *random * 1103515245 + 12345;
+        if(board->alive[i] == 0 || ((*random >> 16) & 3) != 0)
+        {
+            continue;
+        }
+
+        for(int move = 0; move < SEARCH_MOVES; move++)
+        {
+            unsigned short cell = destination(board, i, move);
+
+            for(int j = 0; j < MAX_PLAYERS; j++)
+            {
+                if(j != i && board->alive[j] == 1 && board->cells[j][board->head[j]] == cell)
+                {
+                    moves[i] = (unsigned char)move;
+                    controls[i] = CONTROL_TURN | SEARCH_TURNS[board->dir[i]][move];
+                }
+            }
+        }
+    }
+}
+
+// the eats the last searchMake() settled, heads are from before it
+static void countEats(const struct search_board* board, const unsigned short* heads, int* neck, int* headOn)
+{
+    const struct search_undo* undo = &board->undo[board->depth - 1];
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        unsigned short cell = board->cells[i][board->head[i]];
+
+        for(int j = 0; j < MAX_PLAYERS && undo->moved[i] == 1 && undo->died[i] == 0; j++)
+        {
+            if(j == i || undo->moved[j] == 0 || undo->died[j] == 0)
+            {
+                continue;
+            }
+
+            *neck += heads[j] == cell;
+            *headOn += board->cells[j][board->head[j]] == cell;
+        }
+    }
+}
+
+static int sameAsWorld(const struct search_board* board, const struct world* world)
+{
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(board->alive[i] != world->snakes->active[i])
+        {
+            printf("player %d is %s in the search, not in the world\n", i, board->alive[i] ? "alive" : "dead");
+            return 0;
+        }
+
+        if(board->alive[i] == 1 && (board->size[i] != world->players[i].currLength ||
+                                    board->growth[i] != world->snakes->pendingGrowth[i]))
+        {
+            printf("player %d is %d long growing %d, the world has %d growing %d\n", i, board->size[i],
+                   board->growth[i], world->players[i].currLength, world->snakes->pendingGrowth[i]);
+            return 0;
+        }
+    }
+
+    if(memcmp(board->bodies, world->bits.bodies, sizeof(board->bodies)) != 0)
+    {
+        printf("the bodies differ\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+// what the board's hash should be, the scores are the world's
+static unsigned long long rehashBoard(const struct search_board* board, const struct world* world)
+{
+    unsigned long long hash = 0;
+
+    for(int y = 0; y < BOARD_HEIGHT; y++)
+    {
+        for(int x = 0; x < BOARD_WIDTH; x++)
+        {
+            if(BIT_TEST(board->food, x, y) != 0)
+            {
+                hash ^= worldHashKey(HASH_FOOD, 0, y * BOARD_WIDTH + x);
+            }
+
+            if(BIT_TEST(board->bits->suddenDeath, x, y) != 0)
+            {
+                hash ^= worldHashKey(HASH_SUDDEN_DEATH, 0, y * BOARD_WIDTH + x);
+            }
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        for(int k = 0; k < board->length[i] && board->alive[i] == 1; k++)
+        {
+            unsigned short cell = board->cells[i][(board->head[i] + k) % SEARCH_RING];
+
+            hash ^= worldHashKey(HASH_BODY, i, (cell >> 6) * BOARD_WIDTH + (cell & 63));
+        }
+
+        hash ^= worldHashKey(HASH_DIR, i, board->dir[i]);
+        hash ^= worldHashKey(HASH_SCORE, i, world->players[i].score);
+    }
+
+    return hash;
+}
+
+// the ring past each snake's tail and the undo records are scratch
+static int sameBoard(const struct search_board* board, const struct search_board* loaded)
+{
+    if(memcmp(board->bodies, loaded->bodies, sizeof(board->bodies)) != 0 || board->hash != loaded->hash ||
+       memcmp(board->food, loaded->food, sizeof(board->food)) != 0 || board->depth != loaded->depth)
+    {
+        return 0;
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(board->alive[i] != loaded->alive[i])
+        {
+            return 0;
+        }
+
+        if(loaded->alive[i] == 0)
+        {
+            continue;
+        }
+
+        if(board->head[i] != loaded->head[i] || board->length[i] != loaded->length[i] ||
+           board->growth[i] != loaded->growth[i] || board->size[i] != loaded->size[i] ||
+           board->dir[i] != loaded->dir[i])
+        {
+            return 0;
+        }
+
+        for(int k = 0; k < loaded->length[i]; k++)
+        {
+            if(board->cells[i][(loaded->head[i] + k) % SEARCH_RING] != loaded->cells[i][(loaded->head[i] + k) % SEARCH_RING])
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+//
+// Every tick: load the board, play the next CHECK_DEPTH ticks of quick moves
+// and take them back, then play one tick on both the board and the world
+// and compare. Dead snakes join the world again and are reloaded next tick.
+//
+static int checkMakeUnmake(unsigned int seed, int* neck, int* headOn)
+{
+    static struct world world;
+    static struct search_board board;
+    static struct search_board loaded;
+    unsigned char moves[MAX_PLAYERS];
+    unsigned char controls[MAX_PLAYERS];
+    unsigned short heads[MAX_PLAYERS];
+    unsigned int random = seed;
+
+    startMatch(&world, seed);
+    for(int tick = 0; tick < CHECK_TICKS; tick++)
+    {
+        if(world.hash != worldRehash(&world))
+        {
+            printf("tick %d: the world's hash is %016llx, hashed from scratch %016llx\n", tick, world.hash,
+                   worldRehash(&world));
+            return 0;
+        }
+
+        searchLoad(&board, &world);
+        memcpy(&loaded, &board, sizeof(board));
+
+        for(int depth = 0; depth < CHECK_DEPTH; depth++)
+        {
+            quickMoves(&board, moves, controls, &random);
+            aimMoves(&board, moves, controls, &random);
+            for(int i = 0; i < MAX_PLAYERS; i++)
+            {
+                heads[i] = board.cells[i][board.head[i]];
+            }
+            searchMake(&board, moves);
+            countEats(&board, heads, neck, headOn);
+
+            if(board.hash != rehashBoard(&board, &world))
+            {
+                printf("tick %d: the board's hash is wrong %d ticks ahead\n", tick, depth + 1);
+                return 0;
+            }
+        }
+
+        for(int depth = 0; depth < CHECK_DEPTH; depth++)
+        {
+            searchUnmake(&board);
+        }
+
+        if(sameBoard(&board, &loaded) == 0)
+        {
+            printf("tick %d: unmaking %d ticks didn't put the board back\n", tick, CHECK_DEPTH);
+            return 0;
+        }
+
+        quickMoves(&board, moves, controls, &random);
+        aimMoves(&board, moves, controls, &random);
+        searchMake(&board, moves);
+
+        // only the snakes that moved, joining would change the board
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            if(loaded.alive[i] == 0)
+            {
+                controls[i] = CONTROL_NONE;
+            }
+        }
+
+        worldStep(&world, controls);
+        if(sameAsWorld(&board, &world) == 0)
+        {
+            printf("tick %d: the search and the world disagree\n", tick);
+            return 0;
+        }
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            controls[i] = CONTROL_JOIN;
+        }
+        worldStep(&world, controls);
+    }
+
+    return 1;
+}
+
+// bots below searchBots look ahead, the rest play the quick policy.
+// Adds up deaths per player.
+static void playMatch(unsigned int seed, int ticks, int searchBots, int iterations, unsigned int* deaths)
+{
+    static struct world world;
+    struct search_limits limits = {iterations, BENCH_DEPTH, NULL, NULL};
+    unsigned char moves[MAX_PLAYERS];
+    unsigned char controls[MAX_PLAYERS];
+    unsigned char alive[MAX_PLAYERS];
+    unsigned int random = seed;
+
+    startMatch(&world, seed);
+    for(int tick = 0; tick < ticks; tick++)
+    {
+        searchLoad(&g_Search.board, &world);
+        memcpy(alive, g_Search.board.alive, sizeof(alive));
+        quickMoves(&g_Search.board, moves, controls, &random);
+
+        for(int i = 0; i < searchBots; i++)
+        {
+            controls[i] = searchControl(&g_Search, i, &limits);
+        }
+
+        worldStep(&world, controls);
+
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            deaths[i] += alive[i] == 1 && world.snakes->active[i] == 0;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int matches = argc > 1 ? atoi(argv[1]) : 2;
+    int ticks = argc > 2 ? atoi(argv[2]) : 1000;
+    unsigned int seed = argc > 3 ? (unsigned int)atoi(argv[3]) : 1;
+    unsigned int deaths[MAX_PLAYERS] = {0};
+    unsigned int quickDeaths[MAX_PLAYERS] = {0};
+    unsigned int searchDeaths = 0;
+    int neckEats = 0;
+    int headOnEats = 0;
+    unsigned int otherDeaths = 0;
+    double start = 0;
+    double elapsed = 0;
+
+    worldInit();
+    searchInit(&g_Search, g_Nodes, BENCH_NODES, seed);
+    searchTable(&g_Search, g_Table, BENCH_TABLE);
+
+    for(int match = 0; match < matches; match++)
+    {
+        if(checkMakeUnmake(seed + match, &neckEats, &headOnEats) == 0)
+        {
+            return 1;
+        }
+    }
+    printf("%d matches of %d ticks: searchMake() agrees with worldStep(), searchUnmake() with the board\n",
+           matches, CHECK_TICKS);
+    printf("%d neck eats and %d head on eats made and unmade\n", neckEats, headOnEats);
+    if(neckEats == 0 || headOnEats == 0)
+    {
+        printf("no snake ate another, the check didn't cover eating\n");
+        return 1;
+    }
+
+    start = seconds();
+    for(int match = 0; match < matches; match++)
+    {
+        playMatch(seed + match, ticks, SEARCH_BOTS, BENCH_ITERATIONS, deaths);
+    }
+    elapsed = seconds() - start;
+
+    printf("%u rollouts of %d ticks: %.0f rollouts per second, %.0f decisions per second\n", g_Search.rollouts,
+           BENCH_DEPTH, g_Search.rollouts / elapsed, (double)matches * ticks * SEARCH_BOTS / elapsed);
+    printf("%u rollouts (%.1f%%) answered by the transposition table\n", g_Search.tableHits,
+           100.0 * g_Search.tableHits / g_Search.rollouts);
+
+    // the same matches with nobody looking ahead
+    for(int match = 0; match < matches; match++)
+    {
+        playMatch(seed + match, ticks, 0, 0, quickDeaths);
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(i < SEARCH_BOTS)
+        {
+            searchDeaths += deaths[i];
+            otherDeaths += quickDeaths[i];
+        }
+    }
+
+    printf("deaths per 1000 ticks in slots 0-%d: %.1f looking ahead, %.1f with the quick policy\n",
+           SEARCH_BOTS - 1, searchDeaths * 1000.0 / ((double)matches * ticks * SEARCH_BOTS),
+           otherDeaths * 1000.0 / ((double)matches * ticks * SEARCH_BOTS));
+
+    return 0;
+}
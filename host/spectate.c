@@ -0,0 +1,533 @@
+/*
+Twelve Snakes - watch a match in a terminal
+
+Draws a match on the Saturn's 40x30 text screen layout, the walls and pits
+drawGrid() draws and the score bar displayScoreBar() keeps, in a terminal
+over ANSI escapes. A live match has quick bots in every slot and starts over
+with the next seed when it ends, a replay plays its recorded inputs.
+
+    spectate live [mode] [seed] [ticks per second] [ticks]
+    spectate replay file [ticks per second]
+
+The match runs on its own thread and draws through world->put like the
+Saturn does, into a shadow of the screen, queueing only the cells that
+changed on a cellqueue.h queue. The main thread drains the queue into the
+screen it wants and, thirty times a second, writes only the cells that
+differ from what the terminal shows, a cursor move and a run of glyphs per
+stretch of changes. A frame costs bytes for what moved, however many ticks
+went by, so a fast match can be watched over a slow link. Ticks per second
+of 0 runs flat out. Frames, bytes and ticks are printed to stderr at the end.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../fmt.h"
+#include "../search.h"
+#include "../textplane.h"
+#include "cellqueue.h"
+#include "replay.h"
+#include "timer.h"
+
+#define FRAMES_PER_SECOND 30
+#define RUN_GAP 4 // unchanged cells a run carries on over rather than moving the cursor
+#define SCORE_ROW 5 // the score bar's row, as main.c prints it
+#define DRAIN_CELLS 1024
+#define FRAME_BUFFER 16384
+
+struct spectate
+{
+    // what to play
+    struct gym_config config;
+    const struct replay_header* replay; // NULL for a live match
+    unsigned int seed;
+    int ticksPerSecond; // 0 for as fast as possible
+    unsigned int maxTicks; // live matches stop after this many, 0 for never
+
+    // producer
+    struct world world;
+    char drawn[TEXT_ROWS][TEXT_COLUMNS]; // the screen as the match drew it
+    unsigned int ticks;
+};
+
+static struct cell_queue g_Queue;
+static struct spectate g_Spectate;
+static struct search_board g_Board;
+
+// consumer
+static char g_Wanted[TEXT_ROWS][TEXT_COLUMNS];
+static char g_Shown[TEXT_ROWS][TEXT_COLUMNS];
+
+static void sleepUntil(double when)
+{
+    struct timespec until;
+
+    until.tv_sec = (time_t)when;
+    until.tv_nsec = (long)((when - until.tv_sec) * 1e9);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+}
+
+// the Saturn font's glyphs the game uses that aren't plain ASCII
+static const char* glyphText(char glyph, char* ascii)
+{
+    switch((unsigned char)glyph)
+    {
+        case 14: return "\xE2\x96\x88"; // block
+        case 21: return "\xE2\x94\x80"; // walls
+        case 22: return "\xE2\x94\x82";
+        case 23: return "\xE2\x94\x8C";
+        case 24: return "\xE2\x94\x90";
+        case 25: return "\xE2\x94\x94";
+        case 26: return "\xE2\x94\x98";
+        case 127: return "\xE2\x96\x92"; // checkerboard
+        case 149: return "\xC2\xA7"; // evil snake
+    }
+
+    ascii[0] = glyph >= ' ' && glyph < 127 ? glyph : '?';
+    ascii[1] = '\0';
+    return ascii;
+}
+
+//
+// The match, on its own thread
+//
+
+// world->put, and everything the score bar draws
+static void spectatePut(int x, int y, char glyph)
+{
+    struct spectate* spectate = &g_Spectate;
+
+    if(x < 0 || x >= TEXT_COLUMNS || y < 0 || y >= TEXT_ROWS || spectate->drawn[y][x] == glyph)
+    {
+        return;
+    }
+
+    spectate->drawn[y][x] = glyph;
+    while(cellQueuePush(&g_Queue, x, y, glyph) == 0)
+    {
+        sched_yield();
+    }
+}
+
+static void putText(int x, int y, const char* text)
+{
+    for(int i = 0; text[i] != '\0'; i++)
+    {
+        spectatePut(x + i, y, text[i]);
+    }
+}
+
+// drawGrid()
+static void drawGrid()
+{
+    for(int x = MIN_X - 1; x <= MAX_X + 1; x++)
+    {
+        spectatePut(x, MIN_Y - 1, (char)21);
+        spectatePut(x, MAX_Y + 1, (char)21);
+    }
+
+    spectatePut(MIN_X - 1, MIN_Y - 1, (char)23);
+    spectatePut(MAX_X + 1, MIN_Y - 1, (char)24);
+    spectatePut(MIN_X - 1, MAX_Y + 1, (char)25);
+    spectatePut(MAX_X + 1, MAX_Y + 1, (char)26);
+
+    for(int y = MIN_Y; y <= MAX_Y; y++)
+    {
+        spectatePut(MIN_X - 1, y, (char)22);
+        spectatePut(MAX_X + 1, y, (char)22);
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        const struct spawn_point* spawn = &g_Spawns[i];
+
+        for(int j = 0; j < PIT_CELLS && spawn->pit == 1; j++)
+        {
+            const struct pit_cell* cell = &PIT_SHAPES[spawn->dir][j];
+
+            spectatePut(spawn->x + cell->dx, spawn->y + cell->dy, cell->glyph);
+        }
+    }
+}
+
+// redrawScreen(), after a snake died on the wall
+static void redrawScreen(struct world* world)
+{
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        for(struct location* segment = world->snakes->head[i]; world->snakes->active[i] == 1 && segment != NULL;
+            segment = segment->next)
+        {
+            spectatePut(segment->x, segment->y, g_SnakeGlyphs[i]);
+        }
+    }
+
+    for(int i = 0; i < world->food.count; i++)
+    {
+        spectatePut(world->food.items[i].x, world->food.items[i].y, world->food.shape[0]);
+    }
+
+    drawGrid();
+}
+
+// displayScoreBar() and drawRanking(), with the time counted in ticks
+static void drawScoreBar(struct spectate* spectate)
+{
+    struct world* world = &spectate->world;
+    struct options* options = &world->options;
+    int framesPerTick = options->slowdown + 1;
+    int leader = worldLeader(world);
+    int highScore = leader != EVENT_NO_PLAYER ? world->players[leader].score : 0;
+    int limit = spectate->config.maxTicks - (int)options->tick;
+    int order[MAX_PLAYERS];
+    int counter = 0;
+    char temp[16];
+    char* p = NULL;
+
+    switch(options->gameType)
+    {
+        case GAME_FREE_FOR_ALL:
+            p = fmtString(temp, "FFA ");
+            fmtDecimal(p, highScore > 0 ? highScore : 0, 3, '0');
+            limit = (int)options->tick;
+            break;
+
+        case GAME_SCORE_ATTACK:
+            p = fmtString(temp, " SA ");
+            fmtDecimal(p, options->maxScore - highScore > 0 ? options->maxScore - highScore : 0, 3, '0');
+            break;
+
+        case GAME_BATTLE_ROYALE:
+            p = fmtString(temp, "BR ");
+            fmtDecimal(p, worldPlayersRemaining(world), 3, '0');
+            break;
+
+        case GAME_SURVIVOR:
+            p = fmtString(temp, "SRV ");
+            fmtDecimal(p, highScore, 3, '0');
+            break;
+
+        default:
+            p = fmtString(temp, "KTH ");
+            fmtDecimal(p, highScore, 3, '0');
+            break;
+    }
+    putText(1, SCORE_ROW, temp);
+
+    p = fmtString(temp, " ");
+    fmtClock(p, limit > 0 ? limit * framesPerTick / 60 : 0);
+    putText(11, SCORE_ROW, temp);
+
+    p = fmtString(temp, "SD ");
+    fmtDecimal(p, options->slowdown, 1, ' ');
+    putText(31, SCORE_ROW, temp);
+
+    // insertionSort()
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        int j = i - 1;
+
+        while(j >= 0 && world->players[order[j]].score < world->players[i].score)
+        {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = i;
+    }
+
+    for(int i = 0; i < MAX_PLAYERS && counter < 7; i++)
+    {
+        if(world->players[order[i]].everActive == 1)
+        {
+            spectatePut(21 + counter, SCORE_ROW, world->players[order[i]].shape[0]);
+            counter++;
+        }
+    }
+
+    counter = 0;
+    for(int i = 0; i < MAX_PLAYERS && counter < 4; i++)
+    {
+        if(world->players[order[i]].everActive == 1)
+        {
+            p = fmtRepeat(temp, world->players[order[i]].shape[0], 3);
+            p = fmtString(p, " ");
+            fmtDecimal(p, world->players[order[i]].score, 3, '0');
+            putText(1 + counter * 10, MAX_Y + 2, temp);
+            counter++;
+        }
+    }
+}
+
+static void startMatch(struct spectate* spectate)
+{
+    // clearScreen()
+    for(int y = 0; y < TEXT_ROWS; y++)
+    {
+        for(int x = 0; x < TEXT_COLUMNS; x++)
+        {
+            spectatePut(x, y, ' ');
+        }
+    }
+
+    drawGrid();
+    srand(spectate->seed);
+    gymStartMatch(&spectate->config, &spectate->world);
+}
+
+static void* playMatches(void* arg)
+{
+    struct spectate* spectate = (struct spectate*)arg;
+    struct world* world = &spectate->world;
+    unsigned char controls[MAX_PLAYERS];
+    unsigned char alive[MAX_PLAYERS];
+    unsigned int random = spectate->seed * 2654435761u | 1;
+    double next = seconds();
+
+    world->put = spectatePut;
+    startMatch(spectate);
+
+    for(;;)
+    {
+        int over = 0;
+        int died = 0;
+
+        if(spectate->replay != NULL)
+        {
+            if(world->options.tick >= spectate->replay->ticks)
+            {
+                break;
+            }
+            memcpy(controls, replayControls(spectate->replay, world->options.tick), MAX_PLAYERS);
+        }
+        else
+        {
+            searchQuickControls(&g_Board, world, controls, &random);
+        }
+
+        memcpy(alive, world->snakes->active, sizeof(alive));
+        over = gymStepMatch(&spectate->config, world, controls);
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            died |= alive[i] == 1 && world->snakes->active[i] == 0;
+        }
+        spectate->ticks++;
+
+        if(died == 1)
+        {
+            redrawScreen(world);
+        }
+        drawScoreBar(spectate);
+
+        if(spectate->maxTicks > 0 && spectate->ticks >= spectate->maxTicks)
+        {
+            break;
+        }
+
+        if(over == 1)
+        {
+            if(spectate->replay != NULL)
+            {
+                break;
+            }
+
+            spectate->seed++;
+            startMatch(spectate);
+        }
+
+        if(spectate->ticksPerSecond > 0)
+        {
+            next += 1.0 / spectate->ticksPerSecond;
+            sleepUntil(next);
+        }
+    }
+
+    cellQueueClose(&g_Queue);
+    return NULL;
+}
+
+//
+// The terminal, on the main thread
+//
+
+// the cells that differ from what's shown, returns the bytes written to out
+static size_t drawFrame(char* out)
+{
+    char* p = out;
+    char ascii[2];
+
+    for(int y = 0; y < TEXT_ROWS; y++)
+    {
+        int x = 0;
+
+        while(x < TEXT_COLUMNS)
+        {
+            int end = x;
+            int gap = 0;
+
+            if(g_Wanted[y][x] == g_Shown[y][x])
+            {
+                x++;
+                continue;
+            }
+
+            // the run ends after RUN_GAP unchanged cells in a row
+            for(int k = x + 1; k < TEXT_COLUMNS && gap <= RUN_GAP; k++)
+            {
+                if(g_Wanted[y][k] != g_Shown[y][k])
+                {
+                    end = k;
+                    gap = 0;
+                }
+                else
+                {
+                    gap++;
+                }
+            }
+
+            // ESC [ row ; column H, both from 1
+            p = fmtString(p, "\x1b[");
+            p = fmtDecimal(p, y + 1, 1, ' ');
+            p = fmtString(p, ";");
+            p = fmtDecimal(p, x + 1, 1, ' ');
+            p = fmtString(p, "H");
+
+            for(; x <= end; x++)
+            {
+                p = fmtString(p, glyphText(g_Wanted[y][x], ascii));
+                g_Shown[y][x] = g_Wanted[y][x];
+            }
+        }
+    }
+
+    return (size_t)(p - out);
+}
+
+static int watch()
+{
+    static char frame[FRAME_BUFFER];
+    struct cell_delta cells[DRAIN_CELLS];
+    pthread_t thread;
+    unsigned long long bytes = 0;
+    unsigned int frames = 0;
+    double start = seconds();
+    double nextFrame = start;
+    int closed = 0;
+
+    memset(g_Wanted, ' ', sizeof(g_Wanted));
+    memset(g_Shown, ' ', sizeof(g_Shown));
+    memset(g_Spectate.drawn, ' ', sizeof(g_Spectate.drawn));
+    cellQueueInit(&g_Queue);
+
+    // clear, hide the cursor
+    fputs("\x1b[2J\x1b[?25l", stdout);
+
+    if(pthread_create(&thread, NULL, playMatches, &g_Spectate) != 0)
+    {
+        fprintf(stderr, "can't start the match\n");
+        return 1;
+    }
+
+    while(closed == 0)
+    {
+        int count = 0;
+
+        // closed first, so nothing pushed before it is left behind
+        closed = cellQueueClosed(&g_Queue);
+        while((count = cellQueuePop(&g_Queue, cells, DRAIN_CELLS)) > 0)
+        {
+            for(int i = 0; i < count; i++)
+            {
+                g_Wanted[cells[i].y][cells[i].x] = cells[i].glyph;
+            }
+        }
+
+        if(seconds() >= nextFrame || closed == 1)
+        {
+            size_t size = drawFrame(frame);
+
+            if(size > 0)
+            {
+                fwrite(frame, 1, size, stdout);
+                fflush(stdout);
+                bytes += size;
+            }
+            frames++;
+            nextFrame += 1.0 / FRAMES_PER_SECOND;
+        }
+        else
+        {
+            sleepUntil(seconds() + 0.001);
+        }
+    }
+
+    pthread_join(thread, NULL);
+
+    // the cursor back, under the screen
+    printf("\x1b[%d;1H\x1b[?25h", TEXT_ROWS + 1);
+    fflush(stdout);
+
+    fprintf(stderr, "%u ticks, %u frames, %llu bytes: %.0f bytes per frame, %.0f ticks per second\n",
+            g_Spectate.ticks, frames, bytes, frames > 0 ? (double)bytes / frames : 0,
+            g_Spectate.ticks / (seconds() - start));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    struct spectate* spectate = &g_Spectate;
+    unsigned char* data = NULL;
+    long size = 0;
+
+    worldInit();
+    gymDefaultConfig(&spectate->config);
+    spectate->seed = 1;
+    spectate->ticksPerSecond = 30;
+
+    if(argc >= 2 && strcmp(argv[1], "live") == 0)
+    {
+        spectate->config.gameType = argc > 2 ? atoi(argv[2]) : GAME_FREE_FOR_ALL;
+        spectate->seed = argc > 3 ? (unsigned int)atoi(argv[3]) : 1;
+        spectate->ticksPerSecond = argc > 4 ? atoi(argv[4]) : 30;
+        spectate->maxTicks = argc > 5 ? (unsigned int)atoi(argv[5]) : 0;
+        return watch();
+    }
+
+    if(argc >= 3 && strcmp(argv[1], "replay") == 0)
+    {
+        FILE* file = fopen(argv[2], "rb");
+
+        // the whole replay, it's played from start to end
+        if(file != NULL && fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 &&
+           fseek(file, 0, SEEK_SET) == 0 && (data = malloc((size_t)size)) != NULL &&
+           fread(data, 1, (size_t)size, file) == (size_t)size)
+        {
+            spectate->replay = replayHeader(data, (size_t)size);
+        }
+        if(file != NULL)
+        {
+            fclose(file);
+        }
+
+        if(spectate->replay == NULL || spectate->replay->players != MAX_PLAYERS)
+        {
+            fprintf(stderr, "%s isn't a replay from a %d player build\n", argv[2], MAX_PLAYERS);
+            return 1;
+        }
+
+        spectate->config.gameType = spectate->replay->gameType;
+        spectate->config.maxLives = spectate->replay->maxLives;
+        spectate->config.maxScore = spectate->replay->maxScore;
+        spectate->config.maxTicks = spectate->replay->maxTicks;
+        spectate->config.joinTicks = spectate->replay->joinTicks;
+        spectate->seed = spectate->replay->seed;
+        spectate->ticksPerSecond = argc > 3 ? atoi(argv[3]) : 30;
+        return watch();
+    }
+
+    fprintf(stderr, "usage: spectate live [mode] [seed] [ticks per second] [ticks]\n"
+                    "       spectate replay file [ticks per second]\n");
+    return 1;
+}
@@ -0,0 +1,14 @@
+/*
+Twelve Snakes - timing for the Linux tools
+*/
+
+#include <time.h>
+#include "timer.h"
+
+double seconds()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
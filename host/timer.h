@@ -0,0 +1,13 @@
+/*
+Twelve Snakes - timing for the Linux tools
+
+seconds() reads the monotonic clock, so the difference of two calls is the
+time between them however the wall clock gets set meanwhile.
+*/
+
+#ifndef TIMER_H
+#define TIMER_H
+
+double seconds(); // since some fixed point in the past
+
+#endif
@@ -0,0 +1,127 @@
+/*
+Twelve Snakes - background work in the slowdown frames
+*/
+
+#include <jo/jo.h>
+#include "bench.h"
+#include "idle.h"
+
+// what a task that has never run is assumed to take
+#define IDLE_FIRST_SLICE 20000
+
+static struct idle_task* g_IdleHead = NULL;
+static struct idle_task* g_IdleTail = NULL;
+
+void idleQueue(struct idle_task* task)
+{
+    if(task->queued == 1)
+    {
+        return;
+    }
+
+    task->queued = 1;
+    task->next = NULL;
+
+    if(g_IdleTail == NULL)
+    {
+        g_IdleHead = task;
+    }
+    else
+    {
+        g_IdleTail->next = task;
+    }
+    g_IdleTail = task;
+}
+
+// takes the task after previous off the queue, the head if previous is NULL
+static struct idle_task* dequeue(struct idle_task* previous)
+{
+    struct idle_task* task = previous != NULL ? previous->next : g_IdleHead;
+
+    if(previous != NULL)
+    {
+        previous->next = task->next;
+    }
+    else
+    {
+        g_IdleHead = task->next;
+    }
+
+    if(g_IdleTail == task)
+    {
+        g_IdleTail = previous;
+    }
+
+    task->queued = 0;
+    task->next = NULL;
+    return task;
+}
+
+// what a slice of task is expected to take
+static unsigned int expectedSlice(const struct idle_task* task)
+{
+    return task->slices == 0 ? IDLE_FIRST_SLICE : task->worstSlice;
+}
+
+// runs one slice of the task after previous and sends it to the back if it
+// has more to do. Returns the cycles it took.
+static unsigned int runSlice(struct idle_task* previous)
+{
+    struct idle_task* task = dequeue(previous);
+    unsigned int start = benchStartTimer();
+    unsigned int cycles = 0;
+    int result = 0;
+
+    result = task->step(task->state);
+    cycles = benchCyclesSince(start);
+
+    task->slices++;
+    task->cycles += cycles;
+    if(cycles > task->worstSlice)
+    {
+        task->worstSlice = cycles;
+    }
+
+    if(result == IDLE_MORE)
+    {
+        idleQueue(task);
+    }
+
+    return cycles;
+}
+
+// Runs the first task in the queue whose slice still fits, so a task with
+// long slices waits for an emptier frame without holding up the short ones
+// queued behind it. Stops when nothing left fits.
+unsigned int idleRun(unsigned int budget)
+{
+    unsigned int used = 0;
+
+    for(;;)
+    {
+        struct idle_task* previous = NULL;
+        struct idle_task* task = g_IdleHead;
+
+        while(task != NULL && used + expectedSlice(task) > budget)
+        {
+            previous = task;
+            task = task->next;
+        }
+
+        // the rest waits for the next idle frame
+        if(task == NULL)
+        {
+            return used;
+        }
+
+        used += runSlice(previous);
+    }
+}
+
+void idleFinish()
+{
+    while(g_IdleHead != NULL)
+    {
+        runSlice(NULL);
+    }
+}
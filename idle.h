@@ -0,0 +1,49 @@
+/*
+Twelve Snakes - background work in the slowdown frames
+
+Between two ticks jo_main() waits out gameOptions.slowdown frames. Work that
+doesn't have to happen inside the tick is queued here and run in those frames
+a slice at a time, round robin between the queued tasks. Every slice is timed
+with the free running timer. A slice only starts if the task's longest slice
+so far still fits in what is left of the frame's budget, so the frame that
+plays the next tick is never late. A task that doesn't fit is passed over
+for the ones behind it that do; one whose slices never fit a whole frame's
+budget runs in idleFinish().
+
+Nothing that decides the outcome of a tick may run here. The slices a
+console gets depend on its timing, so in link play the two consoles would
+drift apart.
+*/
+
+#ifndef IDLE_H
+#define IDLE_H
+
+#define IDLE_DONE 0
+#define IDLE_MORE 1
+
+// CPU cycles per idle frame, a third of an NTSC frame so SGL's vertical
+// blank work and the link still get theirs
+#define IDLE_FRAME_BUDGET 150000
+
+// does one small piece of the task, returns IDLE_MORE until it's finished
+typedef int (*idleStep)(void* state);
+
+struct idle_task
+{
+    const char* name;
+    idleStep step;
+    void* state;
+
+    // filled in by the queue
+    int queued;
+    struct idle_task* next;
+    unsigned int slices; // slices run
+    unsigned int cycles; // CPU cycles spent in them
+    unsigned int worstSlice; // longest slice in CPU cycles
+};
+
+void idleQueue(struct idle_task* task); // a queued task keeps its place
+unsigned int idleRun(unsigned int budget); // runs slices for up to budget cycles, returns the cycles used
+void idleFinish(); // runs everything queued to the end, when there are no idle frames
+
+#endif
@@ -0,0 +1,492 @@
+/*
+Twelve Snakes - lockstep link play between two consoles
+
+Packets are framed as
+
+    LINK_SYNC, type, payload length, payload..., Fletcher-16 (2 bytes)
+
+with every field big endian. A receiver that sees a bad checksum drops one byte
+and hunts for the next LINK_SYNC.
+*/
+
+#include <stddef.h>
+#include "link.h"
+
+#define LINK_PACKET_HELLO 1 // guest to host: ready for settings
+#define LINK_PACKET_START 2 // host to guest: struct link_start
+#define LINK_PACKET_TICKS 3 // ack, first tick, count, count * struct link_tick
+
+#define LINK_START_SIZE 14
+
+static void put16(unsigned char* out, unsigned int value)
+{
+    out[0] = (unsigned char)(value >> 8);
+    out[1] = (unsigned char)value;
+}
+
+static void put32(unsigned char* out, unsigned int value)
+{
+    put16(out, value >> 16);
+    put16(out + 2, value);
+}
+
+static unsigned int get16(const unsigned char* in)
+{
+    return ((unsigned int)in[0] << 8) | in[1];
+}
+
+static unsigned int get32(const unsigned char* in)
+{
+    return (get16(in) << 16) | get16(in + 2);
+}
+
+static unsigned int fletcher16(const unsigned char* data, int size)
+{
+    unsigned int sum1 = 0;
+    unsigned int sum2 = 0;
+
+    for(int i = 0; i < size; i++)
+    {
+        sum1 = (sum1 + data[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+
+    return (sum2 << 8) | sum1;
+}
+
+void linkInit(struct link* link, const struct link_transport* transport, int side)
+{
+    unsigned char* bytes = (unsigned char*)link;
+
+    for(unsigned int i = 0; i < sizeof(struct link); i++)
+    {
+        bytes[i] = 0;
+    }
+
+    link->transport = *transport;
+    link->side = side;
+    link->state = LINK_WAITING;
+
+    // the first ticks are played with nothing pressed on either side
+    link->nextLocalTick = LINK_INPUT_DELAY;
+    link->localAcked = LINK_INPUT_DELAY;
+    link->nextPeerTick = LINK_INPUT_DELAY;
+    link->nextConsumedTick = 0;
+    link->ackSent = LINK_INPUT_DELAY;
+    link->localSent = LINK_INPUT_DELAY;
+}
+
+void linkHost(struct link* link, const struct link_start* start)
+{
+    link->start = *start;
+    link->haveStart = 1;
+    link->pollsSinceSend = LINK_RESEND_POLLS; // send it on the next poll
+}
+
+//
+// sending
+//
+
+// appends a packet to the transmit buffer, 0 if it doesn't fit yet
+static int queuePacket(struct link* link, int type, const unsigned char* payload, int size)
+{
+    unsigned char* out = NULL;
+    unsigned int checksum = 0;
+
+    if(link->txCount + LINK_HEADER_SIZE + size + LINK_TRAILER_SIZE > (int)sizeof(link->tx))
+    {
+        return 0;
+    }
+
+    out = &link->tx[link->txCount];
+    out[0] = LINK_SYNC;
+    out[1] = (unsigned char)type;
+    out[2] = (unsigned char)size;
+    for(int i = 0; i < size; i++)
+    {
+        out[LINK_HEADER_SIZE + i] = payload[i];
+    }
+
+    checksum = fletcher16(&out[1], 2 + size);
+    put16(&out[LINK_HEADER_SIZE + size], checksum);
+
+    link->txCount += LINK_HEADER_SIZE + size + LINK_TRAILER_SIZE;
+    link->pollsSinceSend = 0;
+    return 1;
+}
+
+static void queueStart(struct link* link)
+{
+    unsigned char payload[LINK_START_SIZE];
+
+    put16(&payload[0], link->start.gameType);
+    put16(&payload[2], link->start.maxLives);
+    put16(&payload[4], link->start.maxScore);
+    put16(&payload[6], link->start.maxTime);
+    put16(&payload[8], link->start.slowdown);
+    put32(&payload[10], link->start.seed);
+
+    queuePacket(link, LINK_PACKET_START, payload, LINK_START_SIZE);
+}
+
+static void queueTicks(struct link* link)
+{
+    unsigned char payload[LINK_MAX_PAYLOAD];
+    unsigned int first = link->localAcked;
+    unsigned int count = link->nextLocalTick - first;
+    unsigned char* out = &payload[9];
+
+    if(count > LINK_BATCH)
+    {
+        count = LINK_BATCH;
+    }
+
+    put32(&payload[0], link->nextPeerTick);
+    put32(&payload[4], first);
+    payload[8] = (unsigned char)count;
+
+    for(unsigned int i = 0; i < count; i++)
+    {
+        const struct link_tick* tick = &link->local[(first + i) % LINK_WINDOW];
+
+        put16(out, (unsigned int)tick->elapsed);
+        out += 2;
+
+        for(int pad = 0; pad < LINK_PLAYERS_PER_CONSOLE; pad++)
+        {
+            put16(out, tick->pads[pad]);
+            out += 2;
+        }
+
+        put32(out, tick->check);
+        out += 4;
+    }
+
+    if(queuePacket(link, LINK_PACKET_TICKS, payload, (int)(out - payload)) == 1)
+    {
+        link->ackSent = link->nextPeerTick;
+        if(first + count > link->localSent)
+        {
+            link->localSent = first + count;
+        }
+    }
+}
+
+static void flushTransmit(struct link* link)
+{
+    int sent = 0;
+
+    if(link->txSent == link->txCount)
+    {
+        link->txSent = 0;
+        link->txCount = 0;
+        return;
+    }
+
+    sent = link->transport.send(link->transport.context, &link->tx[link->txSent], link->txCount - link->txSent);
+    if(sent < 0)
+    {
+        link->state = LINK_LOST;
+        return;
+    }
+
+    link->txSent += sent;
+    if(link->txSent == link->txCount)
+    {
+        link->txSent = 0;
+        link->txCount = 0;
+    }
+}
+
+// decides what, if anything, goes out on this poll
+static void queueOutgoing(struct link* link)
+{
+    int resend = link->pollsSinceSend >= LINK_RESEND_POLLS;
+
+    if(link->side == LINK_SIDE_GUEST && link->haveStart == 0)
+    {
+        if(resend)
+        {
+            queuePacket(link, LINK_PACKET_HELLO, NULL, 0);
+        }
+        return;
+    }
+
+    if(link->side == LINK_SIDE_HOST && link->state == LINK_WAITING)
+    {
+        // nobody to send to until a guest says hello
+        return;
+    }
+
+    if(link->side == LINK_SIDE_HOST && link->peerTicking == 0 && resend)
+    {
+        // repeated until the guest's ticks show it has the settings
+        queueStart(link);
+    }
+
+    if(link->nextLocalTick > link->localSent ||
+       link->nextPeerTick != link->ackSent ||
+       (link->localAcked < link->nextLocalTick && resend))
+    {
+        queueTicks(link);
+    }
+}
+
+//
+// receiving
+//
+
+static void handleTicks(struct link* link, const unsigned char* payload, int size)
+{
+    unsigned int ack = 0;
+    unsigned int first = 0;
+    unsigned int count = 0;
+    const unsigned char* in = &payload[9];
+
+    // ticks from before the handshake belong to an earlier session
+    if(size < 9 || link->state != LINK_RUNNING)
+    {
+        return;
+    }
+
+    ack = get32(&payload[0]);
+    first = get32(&payload[4]);
+    count = payload[8];
+
+    if(size != 9 + (int)(count * LINK_TICK_SIZE))
+    {
+        return;
+    }
+
+    if(ack > link->localAcked && ack <= link->nextLocalTick)
+    {
+        link->localAcked = ack;
+    }
+
+    if(count > 0)
+    {
+        link->peerTicking = 1;
+    }
+
+    for(unsigned int i = 0; i < count; i++, in += LINK_TICK_SIZE)
+    {
+        unsigned int tick = first + i;
+        struct link_tick* slot = NULL;
+
+        // only the next tick in order is taken, and only if it doesn't
+        // overwrite one the game hasn't played yet. Anything else is resent.
+        if(tick != link->nextPeerTick || tick >= link->nextConsumedTick + LINK_WINDOW)
+        {
+            continue;
+        }
+
+        slot = &link->peer[tick % LINK_WINDOW];
+        slot->elapsed = (int)get16(in);
+        for(int pad = 0; pad < LINK_PLAYERS_PER_CONSOLE; pad++)
+        {
+            slot->pads[pad] = (unsigned short)get16(&in[2 + (pad * 2)]);
+        }
+        slot->check = get32(&in[2 + (2 * LINK_PLAYERS_PER_CONSOLE)]);
+
+        link->nextPeerTick++;
+    }
+}
+
+static void handlePacket(struct link* link, int type, const unsigned char* payload, int size)
+{
+    link->pollsSinceReceive = 0;
+
+    switch(type)
+    {
+        case LINK_PACKET_HELLO:
+            if(link->side == LINK_SIDE_HOST && link->haveStart == 1 && link->state == LINK_WAITING)
+            {
+                link->state = LINK_RUNNING;
+                link->pollsSinceSend = LINK_RESEND_POLLS; // answer with the settings now
+            }
+            break;
+
+        case LINK_PACKET_START:
+            if(link->side == LINK_SIDE_GUEST && link->haveStart == 0 && size == LINK_START_SIZE)
+            {
+                link->start.gameType = (int)get16(&payload[0]);
+                link->start.maxLives = (int)get16(&payload[2]);
+                link->start.maxScore = (int)get16(&payload[4]);
+                link->start.maxTime = (int)get16(&payload[6]);
+                link->start.slowdown = (int)get16(&payload[8]);
+                link->start.seed = get32(&payload[10]);
+                link->haveStart = 1;
+                link->state = LINK_RUNNING;
+            }
+            break;
+
+        case LINK_PACKET_TICKS:
+            handleTicks(link, payload, size);
+            break;
+    }
+}
+
+static void parseReceived(struct link* link)
+{
+    int start = 0;
+
+    while(link->rxCount - start >= LINK_HEADER_SIZE)
+    {
+        const unsigned char* packet = &link->rx[start];
+        int size = packet[2];
+        int total = LINK_HEADER_SIZE + size + LINK_TRAILER_SIZE;
+
+        if(packet[0] != LINK_SYNC || size > LINK_MAX_PAYLOAD)
+        {
+            start++;
+            continue;
+        }
+
+        if(link->rxCount - start < total)
+        {
+            break;
+        }
+
+        if(fletcher16(&packet[1], 2 + size) != get16(&packet[LINK_HEADER_SIZE + size]))
+        {
+            // corrupted, resynchronise on the next sync byte
+            start++;
+            continue;
+        }
+
+        handlePacket(link, packet[1], &packet[LINK_HEADER_SIZE], size);
+        start += total;
+    }
+
+    // keep the partial packet at the front of the buffer
+    for(int i = start; i < link->rxCount; i++)
+    {
+        link->rx[i - start] = link->rx[i];
+    }
+    link->rxCount -= start;
+}
+
+int linkPoll(struct link* link)
+{
+    int received = 0;
+
+    if(link->state == LINK_LOST)
+    {
+        return link->state;
+    }
+
+    flushTransmit(link);
+
+    received = link->transport.receive(link->transport.context, &link->rx[link->rxCount], (int)sizeof(link->rx) - link->rxCount);
+    if(received < 0)
+    {
+        link->state = LINK_LOST;
+        return link->state;
+    }
+
+    link->rxCount += received;
+    parseReceived(link);
+
+    queueOutgoing(link);
+    flushTransmit(link);
+
+    link->pollsSinceSend++;
+    link->pollsSinceReceive++;
+
+    if(link->state == LINK_RUNNING && link->pollsSinceReceive > LINK_TIMEOUT_POLLS)
+    {
+        link->state = LINK_LOST;
+    }
+
+    return link->state;
+}
+
+//
+// ticks
+//
+
+int linkSubmit(struct link* link, const unsigned short* pads, int elapsed, unsigned int check)
+{
+    struct link_tick* tick = NULL;
+
+    // the slot must be neither unacknowledged nor still waiting to be played
+    if(link->nextLocalTick - link->localAcked >= LINK_WINDOW ||
+       link->nextLocalTick >= link->nextConsumedTick + LINK_WINDOW)
+    {
+        return 0;
+    }
+
+    if(elapsed < 0)
+    {
+        elapsed = 0;
+    }
+    if(elapsed > 0xFFFF)
+    {
+        elapsed = 0xFFFF;
+    }
+
+    tick = &link->local[link->nextLocalTick % LINK_WINDOW];
+    tick->elapsed = elapsed;
+    for(int pad = 0; pad < LINK_PLAYERS_PER_CONSOLE; pad++)
+    {
+        tick->pads[pad] = pads[pad];
+    }
+    tick->check = check;
+
+    link->nextLocalTick++;
+    return 1;
+}
+
+int linkReady(const struct link* link, unsigned int tick)
+{
+    if(tick < LINK_INPUT_DELAY)
+    {
+        return 1;
+    }
+
+    return tick < link->nextLocalTick && tick < link->nextPeerTick;
+}
+
+void linkInputs(struct link* link, unsigned int tick, unsigned short* pads, int* elapsed)
+{
+    const struct link_tick* host = NULL;
+    const struct link_tick* guest = NULL;
+
+    link->nextConsumedTick = tick + 1;
+
+    if(tick < LINK_INPUT_DELAY)
+    {
+        for(int pad = 0; pad < 2 * LINK_PLAYERS_PER_CONSOLE; pad++)
+        {
+            pads[pad] = LINK_NEUTRAL_PAD;
+        }
+        *elapsed = 0;
+        return;
+    }
+
+    if(link->side == LINK_SIDE_HOST)
+    {
+        host = &link->local[tick % LINK_WINDOW];
+        guest = &link->peer[tick % LINK_WINDOW];
+    }
+    else
+    {
+        host = &link->peer[tick % LINK_WINDOW];
+        guest = &link->local[tick % LINK_WINDOW];
+    }
+
+    for(int pad = 0; pad < LINK_PLAYERS_PER_CONSOLE; pad++)
+    {
+        pads[pad] = host->pads[pad];
+        pads[LINK_PLAYERS_PER_CONSOLE + pad] = guest->pads[pad];
+    }
+
+    *elapsed = host->elapsed;
+
+    // both worlds should have been the same when these were sampled
+    if(host->check != guest->check && link->desynced == 0)
+    {
+        link->desynced = 1;
+        link->desyncTick = tick - LINK_INPUT_DELAY;
+    }
+}
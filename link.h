@@ -0,0 +1,118 @@
+/*
+Twelve Snakes - lockstep link play between two consoles
+
+Each console owns twelve players. Every tick both consoles send the pad words
+of all their local players and simulate the same tick from the combined
+inputs, so the two worlds stay identical without sending any game state.
+
+Local inputs are sampled LINK_INPUT_DELAY ticks before they are used. The game
+pumps the link during its slowdown frames, which gives the peer's inputs that
+long to arrive before the tick that needs them; the game only stalls when the
+transport is slower than that.
+
+Packets carry every tick the peer hasn't acknowledged yet (up to LINK_BATCH),
+so a dropped or corrupted packet is repaired by the next one.
+
+Each tick also carries the sender's world hash from when its inputs were
+sampled. Both sides play the same ticks, so the hashes only differ if the
+worlds have gone apart, and linkInputs() notes after how many ticks they
+first did.
+
+This file has no Saturn dependencies so the protocol can also be run on Linux
+with the pipe transport in host/.
+*/
+
+#ifndef LINK_H
+#define LINK_H
+
+#define LINK_PLAYERS_PER_CONSOLE 12
+#define LINK_INPUT_DELAY 2 // ticks between sampling local pads and using them
+#define LINK_BATCH 4 // most ticks of inputs in one packet
+#define LINK_WINDOW 8 // ticks buffered each way, power of two
+#define LINK_RESEND_POLLS 4 // resend unacknowledged ticks this often
+#define LINK_TIMEOUT_POLLS 600 // polls without a packet before the link is lost
+#define LINK_NEUTRAL_PAD 0xFFFF // pad bits are active low
+
+#define LINK_SIDE_HOST 0 // players 0-11, picks the game mode
+#define LINK_SIDE_GUEST 1 // players 12-23
+
+#define LINK_WAITING 0 // guest: waiting for the host's settings, host: waiting for a guest
+#define LINK_RUNNING 1
+#define LINK_LOST 2
+
+#define LINK_SYNC 0xA5
+#define LINK_HEADER_SIZE 3 // sync, type, payload length
+#define LINK_TRAILER_SIZE 2 // Fletcher-16 of type, length and payload
+#define LINK_TICK_SIZE (2 + (2 * LINK_PLAYERS_PER_CONSOLE) + 4)
+#define LINK_MAX_PAYLOAD (9 + (LINK_BATCH * LINK_TICK_SIZE))
+#define LINK_MAX_PACKET (LINK_HEADER_SIZE + LINK_MAX_PAYLOAD + LINK_TRAILER_SIZE)
+
+// Moves bytes to or from the other console. Both calls must return at once
+// with the number of bytes moved (possibly 0), or -1 if the link is gone.
+struct link_transport
+{
+    void* context;
+    int (*send)(void* context, const unsigned char* data, int size);
+    int (*receive)(void* context, unsigned char* data, int size);
+};
+
+// match settings chosen on the host
+struct link_start
+{
+    int gameType;
+    int maxLives;
+    int maxScore;
+    int maxTime;
+    int slowdown;
+    unsigned int seed;
+};
+
+struct link_tick
+{
+    int elapsed; // host's match clock in seconds, the guest's is ignored
+    unsigned short pads[LINK_PLAYERS_PER_CONSOLE];
+    unsigned int check; // sender's state hash after this tick - LINK_INPUT_DELAY ticks
+};
+
+struct link
+{
+    struct link_transport transport;
+    int side;
+    int state;
+    int haveStart; // host: settings published, guest: settings received
+    int peerTicking; // the peer's first tick packet has arrived
+    struct link_start start;
+
+    unsigned int nextLocalTick; // tick the next submitted inputs are for
+    unsigned int localAcked; // the peer has all of our ticks below this
+    unsigned int nextPeerTick; // we have all of the peer's ticks below this
+    unsigned int nextConsumedTick; // linkInputs() has been called for ticks below this
+    unsigned int ackSent; // nextPeerTick as of our last packet
+    unsigned int localSent; // our ticks below this have been sent at least once
+    struct link_tick local[LINK_WINDOW];
+    struct link_tick peer[LINK_WINDOW];
+
+    int desynced; // the two sides' state hashes differed
+    unsigned int desyncTick; // ticks both had played when they first did
+
+    int pollsSinceSend;
+    int pollsSinceReceive;
+
+    unsigned char rx[2 * LINK_MAX_PACKET];
+    int rxCount;
+    unsigned char tx[2 * LINK_MAX_PACKET];
+    int txCount;
+    int txSent;
+};
+
+void linkInit(struct link* link, const struct link_transport* transport, int side);
+void linkHost(struct link* link, const struct link_start* start); // host: publish the settings
+int linkPoll(struct link* link); // move bytes both ways, returns the link state
+
+// check is the state hash after the ticks played so far, the peer compares
+// it with its own. Returns 0 if the window is full.
+int linkSubmit(struct link* link, const unsigned short* pads, int elapsed, unsigned int check);
+int linkReady(const struct link* link, unsigned int tick);
+void linkInputs(struct link* link, unsigned int tick, unsigned short* pads, int* elapsed); // pads[2 * LINK_PLAYERS_PER_CONSOLE]
+
+#endif
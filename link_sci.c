@@ -0,0 +1,186 @@
+/*
+Twelve Snakes - link transport over the SH-2 serial port
+*/
+
+#include <jo/jo.h>
+#include "link_sci.h"
+
+// SH-2 on-chip SCI
+#define SCI_SMR (*(volatile Uint8*)0xFFFFFE00)
+#define SCI_BRR (*(volatile Uint8*)0xFFFFFE01)
+#define SCI_SCR (*(volatile Uint8*)0xFFFFFE02)
+#define SCI_TDR (*(volatile Uint8*)0xFFFFFE03)
+#define SCI_SSR (*(volatile Uint8*)0xFFFFFE04)
+#define SCI_RDR (*(volatile Uint8*)0xFFFFFE05)
+
+#define SCI_SCR_TIE 0x80
+#define SCI_SCR_RIE 0x40
+#define SCI_SCR_TE  0x20
+#define SCI_SCR_RE  0x10
+
+#define SCI_SSR_TDRE 0x80
+#define SCI_SSR_RDRF 0x40
+#define SCI_SSR_ORER 0x20
+#define SCI_SSR_FER  0x10
+#define SCI_SSR_PER  0x08
+
+// SH-2 interrupt controller
+#define INTC_IPRB (*(volatile Uint16*)0xFFFFFE60) // SCI priority in bits 15-12
+#define INTC_VCRA (*(volatile Uint16*)0xFFFFFE62) // ERI vector in bits 14-8, RXI in 6-0
+#define INTC_VCRB (*(volatile Uint16*)0xFFFFFE64) // TXI vector in bits 14-8, TEI in 6-0
+
+// user vectors SGL leaves alone
+#define SCI_VECTOR_ERI 0x70
+#define SCI_VECTOR_RXI 0x71
+#define SCI_VECTOR_TXI 0x72
+#define SCI_VECTOR_TEI 0x73
+#define SCI_PRIORITY 10
+
+// 8N1, BRR = clock / (32 * baud) - 1 with the SH-2 at 26.85MHz in the 320
+// pixel modes. 38400 baud is 64 bytes a frame, a tick of inputs is 40.
+#define SCI_CLOCK 26846587
+#define SCI_BAUD 38400
+#define SCI_BRR_VALUE ((SCI_CLOCK / (32 * SCI_BAUD)) - 1)
+
+#define SCI_RING_SIZE 512 // power of two
+
+// single producer, single consumer: the interrupt owns one index, the game
+// owns the other
+struct sci_ring
+{
+    volatile unsigned int head; // next write
+    volatile unsigned int tail; // next read
+    unsigned char data[SCI_RING_SIZE];
+};
+
+static struct sci_ring g_SciReceive;
+static struct sci_ring g_SciTransmit;
+static volatile unsigned int g_SciErrors = 0;
+
+static void __attribute__((interrupt_handler)) sciReceiveError()
+{
+    Uint8 status = SCI_SSR;
+
+    // the byte is lost, the link protocol resends it
+    g_SciErrors++;
+    SCI_SSR = status & (Uint8)~(SCI_SSR_ORER | SCI_SSR_FER | SCI_SSR_PER);
+}
+
+static void __attribute__((interrupt_handler)) sciReceive()
+{
+    unsigned char byte = SCI_RDR;
+    unsigned int head = g_SciReceive.head;
+
+    SCI_SSR &= (Uint8)~SCI_SSR_RDRF;
+
+    if(head - g_SciReceive.tail < SCI_RING_SIZE)
+    {
+        g_SciReceive.data[head % SCI_RING_SIZE] = byte;
+        g_SciReceive.head = head + 1;
+    }
+}
+
+static void __attribute__((interrupt_handler)) sciTransmit()
+{
+    unsigned int tail = g_SciTransmit.tail;
+
+    if(tail == g_SciTransmit.head)
+    {
+        // nothing left, sciSend() turns the interrupt back on
+        SCI_SCR &= (Uint8)~SCI_SCR_TIE;
+        return;
+    }
+
+    SCI_TDR = g_SciTransmit.data[tail % SCI_RING_SIZE];
+    SCI_SSR &= (Uint8)~SCI_SSR_TDRE;
+    g_SciTransmit.tail = tail + 1;
+}
+
+static void __attribute__((interrupt_handler)) sciTransmitEnd()
+{
+}
+
+static int sciSend(void* context, const unsigned char* data, int size)
+{
+    unsigned int head = g_SciTransmit.head;
+    int sent = 0;
+
+    (void)context;
+
+    while(sent < size && head - g_SciTransmit.tail < SCI_RING_SIZE)
+    {
+        g_SciTransmit.data[head % SCI_RING_SIZE] = data[sent++];
+        head++;
+    }
+
+    g_SciTransmit.head = head;
+    if(sent > 0)
+    {
+        SCI_SCR |= SCI_SCR_TIE;
+    }
+
+    return sent;
+}
+
+static int sciReceiveBytes(void* context, unsigned char* data, int size)
+{
+    unsigned int tail = g_SciReceive.tail;
+    int received = 0;
+
+    (void)context;
+
+    while(received < size && tail != g_SciReceive.head)
+    {
+        data[received++] = g_SciReceive.data[tail % SCI_RING_SIZE];
+        tail++;
+    }
+
+    g_SciReceive.tail = tail;
+    return received;
+}
+
+static void** vectorTable()
+{
+    void** vbr = NULL;
+
+    __asm__ volatile("stc vbr, %0" : "=r"(vbr));
+    return vbr;
+}
+
+void linkSciTransport(struct link_transport* transport)
+{
+    void** vectors = vectorTable();
+
+    // quiet the port while it is set up
+    SCI_SCR = 0;
+
+    g_SciReceive.head = 0;
+    g_SciReceive.tail = 0;
+    g_SciTransmit.head = 0;
+    g_SciTransmit.tail = 0;
+    g_SciErrors = 0;
+
+    vectors[SCI_VECTOR_ERI] = (void*)sciReceiveError;
+    vectors[SCI_VECTOR_RXI] = (void*)sciReceive;
+    vectors[SCI_VECTOR_TXI] = (void*)sciTransmit;
+    vectors[SCI_VECTOR_TEI] = (void*)sciTransmitEnd;
+
+    INTC_VCRA = (Uint16)((SCI_VECTOR_ERI << 8) | SCI_VECTOR_RXI);
+    INTC_VCRB = (Uint16)((SCI_VECTOR_TXI << 8) | SCI_VECTOR_TEI);
+    INTC_IPRB = (Uint16)((INTC_IPRB & 0x0FFF) | (SCI_PRIORITY << 12));
+
+    SCI_SMR = 0; // asynchronous, 8 data bits, no parity, 1 stop bit, clock / 1
+    SCI_BRR = (Uint8)SCI_BRR_VALUE;
+
+    // give the baud rate a bit time to settle, then drop anything stale
+    for(volatile int i = 0; i < 1000; i++)
+    {
+    }
+    SCI_SSR &= (Uint8)~(SCI_SSR_RDRF | SCI_SSR_ORER | SCI_SSR_FER | SCI_SSR_PER);
+
+    SCI_SCR = SCI_SCR_RIE | SCI_SCR_TE | SCI_SCR_RE;
+
+    transport->context = NULL;
+    transport->send = sciSend;
+    transport->receive = sciReceiveBytes;
+}
@@ -0,0 +1,16 @@
+/*
+Twelve Snakes - link transport over the SH-2 serial port
+
+The communication connector on the back of the Saturn is wired to the master
+SH-2's SCI. Bytes are moved by the receive and transmit interrupts through two
+small rings, so linkPoll() only has to be called once a frame.
+*/
+
+#ifndef LINK_SCI_H
+#define LINK_SCI_H
+
+#include "link.h"
+
+void linkSciTransport(struct link_transport* transport); // (re)starts the port with empty rings
+
+#endif
@@ -31,70 +31,51 @@ Twelve Snakes v3.0.0 - a 12 player snake clone by Slinga
 */
 
 #include <jo/jo.h> // Required for basic sgl functions
+#include "bench.h"
+#include "bots.h"
+#include "events.h"
+#include "fmt.h"
+#include "game.h"
+#include "idle.h"
+#include "link.h"
+#include "link_sci.h"
+#include "screens.h"
+#include "slave.h"
+#include "stats.h"
+#include "textplane.h"
+#include "world.h"
 
-#define MAX_PLAYERS 12
-#define MIN_SCORE -99
-#define MAX_SCORE 999
-#define MAX_SLOWDOWN 9
-#define MIN_SLOWDOWN 0
 #define MAX_SUBOPTION_VALUES 5
-#define INITIAL_SLOWDOWN 5
-#define PORT_TWO 9
-#define DIR_UP 0
-#define DIR_DOWN 1
-#define DIR_RIGHT 2
-#define DIR_LEFT 3
-#define OFF_SCREEN -1
-
-#define MIN_Y 7
-#define MAX_Y 23
-#define MIN_X 2
-#define MAX_X 37
-
-#define MAX_SUDDEN_DEATH_X (MAX_X - MIN_X + 1)
-#define MAX_SUDDEN_DEATH_Y (MAX_Y - MIN_Y + 1)
-
-#define GAME_FREE_FOR_ALL     0
-#define GAME_SCORE_ATTACK     1
-#define GAME_BATTLE_ROYALE    2
-#define GAME_SURVIVOR         3
-#define GAME_KING_OF_THE_HILL 4
-
-// stdlib function prototypes to keep compiler happy
-void* memcpy(void *dst, const void *src, unsigned int len);
-int rand(void);
-void srand(unsigned int seed);
-void *malloc(unsigned int size);
-void free(void *ptr);
-void *memset(void *s, int c, unsigned int n);
-int strcmp(const char* s1, const char* s2);
-
-struct location
-{
-    int x;
-    int y;
-    struct location* next;
-};
 
-struct food
-{
-    char shape[2]; // The shape of the food
-    int x;
-    int y;
-};
-
-struct options
-{
-    int gameType;
-    int maxLives;
-    int maxScore;
-    int maxTime;
-    int slowdown; // factor used to adjust the speed of the game
-
-    int startTime; // what time in seconds the game was started
-    int joinTimeStopped; // no longer allowed to join the game
-    int suddenDeath; // are we in sudden death mode for Battle Royale
-};
+#define LINK_PLAY_OFF 0
+#define LINK_PLAY_HOST 1
+#define LINK_PLAY_GUEST 2
+#define NUM_LINK_PLAY 3
+
+// 1 skips the SSMTF logo and title screen and boots straight to the menu,
+// set FAST_BOOT in the makefile
+#ifndef FAST_BOOT
+#define FAST_BOOT 0
+#endif
+
+// 1 checks collisions on the slave SH-2, set SLAVE_CPU in the makefile
+#ifndef SLAVE_CPU
+#define SLAVE_CPU 1
+#endif
+
+// link play needs a player slot for every pad on both consoles
+#if MAX_PLAYERS >= 2 * LINK_PLAYERS_PER_CONSOLE
+#define LINK_PLAY_SUPPORTED 1
+#else
+#define LINK_PLAY_SUPPORTED 0
+#endif
+
+// the title screen has the default build's playing field and pits in it
+#if MIN_X == 2 && MAX_X == 37 && MIN_Y == 7 && MAX_Y == 23 && MAX_PLAYERS >= 4 * PITS_PER_SIDE
+#define TITLE_FIELD_MATCHES 1
+#else
+#define TITLE_FIELD_MATCHES 0
+#endif
 
 struct suboptions
 {
@@ -104,77 +85,50 @@ struct suboptions
     int values[MAX_SUBOPTION_VALUES];
 };
 
-struct sudden_death_grid
-{
-    int lastX;
-    int lastY;
-    int count;
-    int dir;
-    char grid[MAX_SUDDEN_DEATH_X][MAX_SUDDEN_DEATH_X];
-};
-
 const struct suboptions SUBOPTION_TIME_LIMIT =  {"Time Limit: ", "min",    1, {1, 3, 5, 7, 10}};
 const struct suboptions SUBOPTION_LIVES_LIMIT = {"Lives Limit:", "lives",  2, {1, 3, 5, 7, 10}};
 const struct suboptions SUBOPTION_SCORE_LIMIT = {"Score Limit:", "points", 2, {10, 15, 25, 50, 100}};
 const struct suboptions SUBOPTION_SLOWDOWN =    {"Slowdown:   ", "delay",  2, {3, 4, 5, 6, 7}};
+const struct suboptions SUBOPTION_BOTS =        {"Computer:   ", "snakes", 0, {0, 1, 2, 3, 4}};
 
-struct snake
-{
-    int ID; // index into the array of players
-    int controllerNum; // which port to read data from. On multitap 2 this it != ID
-    char shape[2]; // the shape of the snake
-    int dir; // current direction snake is moving in
-    int active; // Is this player playing or not
-    int everActive; // has the player ever been active?
-    int dying; // Is player marked for death?
-    struct location* head; // points to the head of the snake
-    struct location* tail; // points to the tail of the snake
-
-    // variables for score
-    int numApples;
-    int numDeaths;
-    int numKills;
-    int numPlayersEaten;
-    int currLength;
-    int maxLength;
-    int score;
-};
+const char* const LINK_PLAY_NAMES[NUM_LINK_PLAY] = {"   Link Play: Off  ", "   Link Play: Host ", "   Link Play: Guest"};
 
 // init functions
-void initializePlayer(struct snake* somePlayer, struct options* gameOptions);
-void initializeFood(struct food* theFood, char theShape);
-void initializePlayerNumbers(struct snake* players);
+void initializeControllerPorts();
 
 // display\drawing functions
 void displayText(); // Displays the heading information
-void displayJoinText(struct snake* players, struct options* gameOptions);
+void displayJoinText(struct world* world);
 void displayMenu(); // Displays the menu choices
 int displaySubMenu(struct options* gameOptions, char* gameMode, int numSubOptions, struct suboptions* subOptions);
 void displaySSMTFPresents(); // Displays Sega Saturn Multiplayer Task Force logo
 void drawGrid(); // Draws the playing field
-void drawSnake(struct snake* somePlayer); // Updates the snake, collision detection
-void drawFood(struct food* someFood, struct snake* players); // Draws the food on the screen
-void drawSuddenDeathGrid(struct sudden_death_grid* deathGrid);
 void displayScore(struct snake* players, struct options* gameOptions);
-int displayScoreBar(struct snake* players, struct options* gameOptions);
+void displayBestScore(struct options* gameOptions);
+int displayScoreBar(struct world* world);
+int displayScoreBarScores(struct world* world);
 void clearScreen();
-void redrawScreen(struct snake* players, struct food* theFood, struct sudden_death_grid* deathGrid);
+void redrawScreen(struct world* world);
 void redrawSuddenDeathGrid(struct sudden_death_grid* suddenDeath);
 void titleScreen();
 
 // game functions
-void killPlayer(struct snake* somePlayer);
-void eraseSnake(struct location* snakeHead); // erases the snake, free its memory
-void pressStart(struct snake* players, struct options* gameOptions);
-int safeFood(struct food* someFood, struct snake* players); // returns a 1 if the new position of the food is "safe"
-void clearScore(struct snake* players); // clears the game score
-void checkPlayerOneCommands(struct snake* players, struct food* theFood, struct options* gameOptions, struct sudden_death_grid* deathGrid);
-void checkForCollisions(struct snake* someSnake, struct snake* players);
-void checkForSuddenDeathCollisions(struct snake* players, struct options* gameOptions, struct sudden_death_grid* deathGrid);
-void validateScore(struct snake* players, struct options* gameOptions);
-int isAllowedToSpawn(struct snake* somePlayer, struct options* gameOptions);
-void growSnake(struct snake* player, int amount);
-int changeSuddenDeathDir(struct sudden_death_grid* deathGrid);
+void pressStart(struct world* world);
+void checkPlayerOneCommands(struct world* world, Uint16 data);
+void insertionSort(struct snake* players, int* order);
+void rankReset();
+int rankStep(void* state); // idle task, sorts the ranking a player at a time and draws it
+int statsStep(void* state); // idle task, folds the match events into the lifetime stats
+unsigned char padControl(Uint16 data); // pad bits to a CONTROL_* byte for worldStep()
+void startBots(struct world* world); // plans the CPU snakes' next tick, on the slave if there is one
+void finishBots(struct world* world); // until the plan is ready
+
+// link play functions
+void readInputs(struct options* gameOptions, Uint16* inputs);
+int linkConnect(struct options* gameOptions, int side);
+void pumpLink();
+void linkLost();
+void linkOutOfSync(); // the two consoles' worlds went apart
 
 // utility functions
 void getTime(jo_datetime* currentTime);
@@ -182,6 +136,17 @@ unsigned int getSeconds();
 void checkForABCStart();
 
 int g_DisplayedSSMTF = 0;
+struct world g_World = {0}; // the match being played
+Uint8 g_ControllerPorts[LOCAL_PLAYERS] = {0}; // Smpc_Peripheral index of each local player, players 12-23 are on the linked console
+int g_LinkPlay = LINK_PLAY_OFF; // menu choice, kept between matches
+struct link g_Link = {0};
+unsigned int g_LinkTick = 0; // next tick to play in link play
+
+// work done in the slowdown frames
+int g_RankOrder[MAX_PLAYERS] = {0}; // player indexes highest score first, sorted a step at a time
+int g_RankNext = MAX_PLAYERS; // next player to insert, MAX_PLAYERS once sorted
+struct idle_task g_RankTask = {.name = "rank", .step = rankStep, .state = &g_World};
+struct idle_task g_StatsTask = {.name = "stats", .step = statsStep};
 
 
 
@@ -189,43 +154,68 @@ void jo_main(void)
 {
     int i = 0;
     Uint16 data = 0;
-    struct snake players[MAX_PLAYERS] = {0};
-    struct food theFood = {0};
-    struct options gameOptions = {0};
-    struct sudden_death_grid deathGrid = {0};
+    Uint16 inputs[MAX_PLAYERS] = {0};
+    unsigned char controls[MAX_PLAYERS] = {0};
+    struct snake* players = g_World.players;
+    struct options* gameOptions = &g_World.options;
 
-    int redrawGrid = 0;
     int gameEnded = 0;
 
     // Initializing functions
     slInitSystem(TV_320x240, NULL, 1); // Initializes screen
     jo_core_init(JO_COLOR_Black);
+    textPlaneInit();
+    statsLoad(); // only reads backup RAM the first time
 
-    if(g_DisplayedSSMTF == 0)
+    g_World.put = textPlanePut;
+    if(SLAVE_CPU == 1)
+    {
+        g_World.startDetect = slaveStartDetect;
+        g_World.waitDetect = slaveWaitDetect;
+    }
+    worldInit();
+
+    if(FAST_BOOT == 0 && g_DisplayedSSMTF == 0)
     {
         displaySSMTFPresents(); // SSMTF logo
         g_DisplayedSSMTF = 1;
-    }
-    drawGrid(); // Draws the playing field box
 
-    displayText();
-    titleScreen();
+        // hold L+R during the logo to run the benchmarks
+        data = Smpc_Peripheral[0].data;
+        if((data & PER_DGT_TL) == 0 && (data & PER_DGT_TR) == 0)
+        {
+            displayBenchmarks();
+        }
+    }
+    if(FAST_BOOT == 0)
+    {
+        titleScreen(); // also draws the playing field box and heading
+    }
+    else
+    {
+        drawGrid(); // Draws the playing field box
+        displayText();
+    }
 
     do
     {
         //
         // Initialize game specific things
         //
-        initializePlayerNumbers(players);
-        memset(&deathGrid, 0, sizeof(deathGrid));
-        clearScore(players);
+        worldReset(&g_World);
+        initializeControllerPorts();
+        eventsReset();
+        statsBeginMatch();
+        rankReset();
         srand(getSeconds());
 
         //
         // Prompt the player for game mode and options
         //
-        displayMenu(&gameOptions);
-        initializeFood(&theFood, '*');
+        displayMenu(gameOptions);
+        worldStart(&g_World);
+        botsReset(&g_World);
+        startBots(&g_World);
 
 
         //
@@ -234,96 +224,84 @@ void jo_main(void)
         do
         {
             //
-            // Check for special player one commands
+            // Every player's pad for this tick. In link play this waits for
+            // the other console's if they haven't arrived yet.
             //
-            checkPlayerOneCommands(players, &theFood, &gameOptions, &deathGrid);
+            readInputs(gameOptions, inputs);
+            finishBots(&g_World);
 
             //
-            // Draw existing players
+            // Check for special player one commands
             //
-            for(i = 0; i < MAX_PLAYERS; i++)
-            {
-                data = Smpc_Peripheral[players[i].controllerNum].data;
-
-                // Check if player pressed the A button and is not already playing
-                if((data & PER_DGT_TA) == 0 && players[i].active == 0)
-                {
-                    initializePlayer(&players[i], &gameOptions);
-                }
-
-                if(players[i].active == 1)
-                {
-                    drawSnake(&players[i]);
-                }
-            }
-
-            if(gameOptions.suddenDeath == 1)
-            {
-                drawSuddenDeathGrid(&deathGrid);
-            }
+            checkPlayerOneCommands(&g_World, inputs[0]);
 
             //
-            // After all players have moved, check for collisions
+            // Join, move, collide, eat
             //
+            UNROLL_PLAYERS
             for(i = 0; i < MAX_PLAYERS; i++)
             {
-                if(players[i].active == 1)
-                {
-                    checkForCollisions(&players[i], players);
-                }
-            }
-
-            if(gameOptions.suddenDeath == 1)
-            {
-                checkForSuddenDeathCollisions(players, &gameOptions, &deathGrid);
+                controls[i] = padControl(inputs[i]);
             }
+            botsControls(&g_World, controls);
 
-            //
-            // Kill snakes that are marked for death
-            //
-            for(i = 0; i < MAX_PLAYERS; i++)
+            if(worldStep(&g_World, controls) == 1)
             {
-                if(players[i].active == 1 && players[i].dying == 1)
-                {
-                    killPlayer(&players[i]);
-                    redrawGrid = 1; // someone died so redraw the grid
-                }
-            }
-
-            //
-            // Draw the food
-            //
-            drawFood(&theFood, players);
-
-            //
-            // Draw the grid again in case a Snake crashed into it
-            //
-            if(redrawGrid == 1)
-            {
-                redrawGrid = 0;
-                redrawScreen(players, &theFood, &deathGrid);
+                // someone died, draw the grid again in case a snake crashed into it
+                redrawScreen(&g_World);
             }
 
             // display the score bar and check for end of game conditions
-            gameEnded = displayScoreBar(players, &gameOptions);
+            gameEnded = displayScoreBar(&g_World);
             if(gameEnded == 1)
             {
+                emitEvent(EVENT_MODE_END, worldLeader(&g_World), gameOptions->gameType, 0, 0);
+                statsUpdate();
+
                 clearScreen();
-                displayScore(players, &gameOptions);
-                pressStart(players, &gameOptions);
+                displayScore(players, gameOptions);
+                statsRecordMatch(players, gameOptions, 1);
+                displayBestScore(gameOptions);
+                statsSave();
+                pressStart(&g_World);
                 jo_main();
             }
 
             // "Press A to Join"
-            displayJoinText(players, &gameOptions);
+            displayJoinText(&g_World);
+
+            // the CPU snakes think about the next tick while this one is shown
+            startBots(&g_World);
+
+            // fold this tick's events into the lifetime stats once there's time
+            idleQueue(&g_StatsTask);
 
             //
             // synch the screen
             //
             slSynch(); // You won't see anything without this!!
-            for(i = 0; i < gameOptions.slowdown; i++)
+            textPlaneFlush(); // this frame's snake, food and sudden death cells
+            if(gameOptions->linked == 1)
+            {
+                pumpLink();
+            }
+
+            if(gameOptions->slowdown == 0)
             {
+                // no frames to spare, catch up on the background work now
+                idleFinish();
+            }
+
+            for(i = 0; i < gameOptions->slowdown; i++)
+            {
+                idleRun(IDLE_FRAME_BUDGET);
                 slSynch(); // Slow down
+
+                // the other console's inputs arrive while we wait
+                if(gameOptions->linked == 1)
+                {
+                    pumpLink();
+                }
             }
 
         }while(1); // game loop
@@ -331,247 +309,90 @@ void jo_main(void)
     }while(1); // game type loop
 }
 
-void initializePlayerNumbers(struct snake* players)
+void initializeControllerPorts()
 {
-    for(int i = 0; i < MAX_PLAYERS; i++)
+    for(int i = 0; i < LOCAL_PLAYERS; i++)
     {
-        int controllerNum = 0;
-
         if(i < 6)
         {
             // player is on multitap 1
-            controllerNum = i;
+            g_ControllerPorts[i] = i;
         }
         else
         {
             // player is on multitap 2
-            // the controllerNum is offset
-            controllerNum = i + PORT_TWO;
+            // the port is offset
+            g_ControllerPorts[i] = i + PORT_TWO;
         }
-
-        players[i].ID = i;
-        players[i].controllerNum = controllerNum;
     }
 }
 
-int isAllowedToSpawn(struct snake* somePlayer, struct options* gameOptions)
+// The D-pad picks the direction to turn to, A joins. Pressing more than one
+// direction turns the first of down, up, right, left like before.
+unsigned char padControl(Uint16 data)
 {
-    //
-    // Do not let the player spawn if:
-    // - they are playing a game type with lives and have run out
-    // - they didn't spawn in the first 30s a
-    //
+    unsigned char control = CONTROL_NONE;
 
-    switch(gameOptions->gameType)
+    if((data & PER_DGT_KD) == 0)
     {
-        case GAME_FREE_FOR_ALL:
-        case GAME_SURVIVOR:
-        case GAME_KING_OF_THE_HILL:
-        case GAME_SCORE_ATTACK:
-            // FFA, Survivor, and KOTH, SA always allow spawning
-            return 1;
-            break;
-
-        case GAME_BATTLE_ROYALE:
-
-            if(gameOptions->suddenDeath == 1)
-            {
-                // don't allow spawning in sudden death
-                return 0;
-            }
-
-            // don't allow spawning if the player is out of lives
-            if(somePlayer->numDeaths >= gameOptions->maxLives)
-            {
-                return 0;
-            }
+        control = CONTROL_TURN | DIR_DOWN;
+    }
+    else if((data & PER_DGT_KU) == 0)
+    {
+        control = CONTROL_TURN | DIR_UP;
+    }
+    else if((data & PER_DGT_KR) == 0)
+    {
+        control = CONTROL_TURN | DIR_RIGHT;
+    }
+    else if((data & PER_DGT_KL) == 0)
+    {
+        control = CONTROL_TURN | DIR_LEFT;
+    }
 
-            return 1;
-            break;
+    if((data & PER_DGT_TA) == 0)
+    {
+        control |= CONTROL_JOIN;
     }
 
-    return 0;
+    return control;
 }
 
-void initializePlayer(struct snake* somePlayer, struct options* gameOptions)
+void startBots(struct world* world)
 {
-    if(isAllowedToSpawn(somePlayer, gameOptions) == 0)
+    if(world->options.bots == 0)
     {
         return;
     }
 
-    // Create player
-    if(somePlayer->active != 1)
+    if(SLAVE_CPU == 1)
     {
-        switch (somePlayer->ID)
-        {
-            case 0:
-                somePlayer->shape[0] = (char)14; // block
-                break;
-
-            case 1:
-                somePlayer->shape[0] = (char)35; // pound sign
-                break;
-
-            case 2:
-                somePlayer->shape[0] = (char)23; // gaurav's gamma
-                break;
-
-            case 3:
-                somePlayer->shape[0] = (char)127; // checkerboard
-                break;
-
-            case 4:
-                somePlayer->shape[0] = (char)92; // looks like a V
-                break;
-
-            case 5:
-                somePlayer->shape[0] = (char)38; // percent sign
-                break;
-
-            case 6:
-                somePlayer->shape[0] = (char)64; // copyright symbol
-                break;
-
-            case 7:
-                somePlayer->shape[0] = (char)56; // number eight
-                break;
-
-            case 8:
-                somePlayer->shape[0] = (char)37; // percent sign
-                break;
-
-            case 9:
-                somePlayer->shape[0] = (char)48; // zero
-                break;
-
-            case 10:
-                somePlayer->shape[0] = (char)81; // letter Q
-                break;
-
-            case 11:
-                somePlayer->shape[0] = (char)149; // evil snake!
-                break;
-
-            default:
-                somePlayer->shape[0] = 'e';
-                break;
-        }
-
-        somePlayer->shape[1] = '\0';
-
-        // allocate three segments for the snake
-        somePlayer->head = (struct location*)malloc(sizeof(struct location));
-        somePlayer->head->next = (struct location*)malloc(sizeof(struct location));
-        somePlayer->head->next->next= (struct location*)malloc(sizeof(struct location));
-
-        switch(somePlayer->ID)
-        {
-            case 0:
-                somePlayer->head->x = 1;
-                somePlayer->head->y = 9;
-                somePlayer->dir = 2;
-                break;
-
-            case 1:
-                somePlayer->head->x = 38;
-                somePlayer->head->y = 21;
-                somePlayer->dir = 3;
-                break;
-
-            case 2:
-                somePlayer->head->x = 1;
-                somePlayer->head->y = 21;
-                somePlayer->dir = 2;
-                break;
-
-            case 3:
-                somePlayer->head->x = 38;
-                somePlayer->head->y = 9;
-                somePlayer->dir = 3;
-                break;
-
-            case 4:
-                somePlayer->head->x = 1;
-                somePlayer->head->y = 15;
-                somePlayer->dir = 2;
-                break;
-
-            case 5:
-                somePlayer->head->x = 38;
-                somePlayer->head->y = 15;
-                somePlayer->dir = 3;
-                break;
-
-            case 6:
-                somePlayer->head->x = 29;
-                somePlayer->head->y = 24;
-                somePlayer->dir = 0;
-                break;
-
-            case 7:
-                somePlayer->head->x = 9;
-                somePlayer->head->y = 6;
-                somePlayer->dir = 1;
-                break;
-
-            case 8:
-                somePlayer->head->x = 9;
-                somePlayer->head->y = 24;
-                somePlayer->dir = 0;
-                break;
-
-            case 9:
-                somePlayer->head->x = 29;
-                somePlayer->head->y = 6;
-                somePlayer->dir = 1;
-                break;
-
-            case 10:
-                somePlayer->head->x = 19;
-                somePlayer->head->y = 24;
-                somePlayer->dir = 0;
-                break;
-
-            case 11:
-                somePlayer->head->x = 19;
-                somePlayer->head->y = 6;
-                somePlayer->dir = 1;
-                break;
-        }
-
-        // Initiate rest of snake to offscreen positions
-        somePlayer->head->next->x = OFF_SCREEN;
-        somePlayer->head->next->y = OFF_SCREEN;
-
-        somePlayer->head->next->next->x = OFF_SCREEN;
-        somePlayer->head->next->next->y = OFF_SCREEN;
-
-        somePlayer->head->next->next->next = NULL;
-        somePlayer->tail = somePlayer->head->next->next;
-
-        somePlayer->currLength = 3;
-        if(somePlayer->currLength > somePlayer->maxLength)
-        {
-            somePlayer->maxLength = somePlayer->currLength;
-        }
-
-        somePlayer->active = 1;
-        somePlayer->everActive = 1;
-        somePlayer->dying = 0;
-
-        // Draw the starting position of the snake
-        slPrint(somePlayer->shape, slLocate(somePlayer->head->x, somePlayer->head->y));
+        slaveStart(botsPlan, world);
+    }
+    else
+    {
+        botsPlan(world);
     }
 }
 
-void checkPlayerOneCommands(struct snake* players, struct food* theFood, struct options* gameOptions, struct sudden_death_grid* deathGrid)
+void finishBots(struct world* world)
 {
-    Uint16 data = 0;
+    if(world->options.bots == 0 || SLAVE_CPU == 0)
+    {
+        return;
+    }
 
-    // Read the 1st player controller
-    data = Smpc_Peripheral[0].data;
+    slaveStop();
+    slaveWait();
+}
+
+void checkPlayerOneCommands(struct world* world, Uint16 data)
+{
+    struct snake* players = world->players;
+    struct options* gameOptions = &world->options;
 
+    // data is the 1st player's controller for this tick, in link play the
+    // host's player one so both consoles change speed together
     checkForABCStart();
 
     // Did player decrease game speed
@@ -594,476 +415,96 @@ void checkPlayerOneCommands(struct snake* players, struct food* theFood, struct
         }
     }
 
+    // the score screen would stall the other console and clearing the score
+    // would only happen on this one
+    if(gameOptions->linked == 1)
+    {
+        return;
+    }
+
     // Does the user want to see the score
     if((data & PER_DGT_ST) == 0)
     {
+        statsUpdate(); // whatever the idle frames haven't folded yet
         clearScreen();
         displayScore(players, gameOptions);
-        pressStart(players, gameOptions);
+        statsRecordMatch(players, gameOptions, 0);
+        displayBestScore(gameOptions);
+        statsSave();
+        pressStart(world);
         clearScreen();
-        redrawScreen(players, theFood, deathGrid);
+        redrawScreen(world);
     }
 
     // Does the user want to clear score
     if((data & PER_DGT_TZ) == 0)
     {
-        clearScore(players);
+        worldClearScore(world);
     }
 }
 
 void drawGrid()
 {
+    int width = ARENA_WIDTH + 2;
+    int i;
     int j;
 
-    char temp[10];
-    char top[40]; // The top of the playing field
-    char bottom[40]; // The bottom of the playing field
-
-    char topLeftPit[2];
-    char bottomRightPit[2];
-    char topRightPit[2];
-    char bottomLeftPit[2];
-    char sidePit[2];
-    char topPit[2];
+    char top[BOARD_WIDTH + 1]; // The top of the playing field
+    char bottom[BOARD_WIDTH + 1]; // The bottom of the playing field
+    char side[2];
+    char glyph[2];
 
     // Fill the arrays with '-'
-    sprintf(temp, "%c", 21);
-    for(j = 0; j<38; j++)
-    {
-        top[j] = temp[0];
-        bottom[j] = temp[0];
-    }
+    fmtRepeat(top, (char)21, width);
+    fmtRepeat(bottom, (char)21, width);
 
     // Corner pieces
-    sprintf(temp, "%c", 23);
-    top[0] = temp[0];
-
-    sprintf(temp, "%c", 24);
-    top[37] = temp[0];
-
-    sprintf(temp, "%c", 25);
-    bottom[0] = temp[0];
-
-    sprintf(temp, "%c", 26);
-    bottom[37] = temp[0];
-
-    top[38] = '\0';
-    bottom[38] = '\0';
+    top[0] = (char)23;
+    top[width - 1] = (char)24;
+    bottom[0] = (char)25;
+    bottom[width - 1] = (char)26;
 
     // Draw the top and bottom borders
-    slPrint(top, slLocate(1, 6));
-    slPrint(bottom, slLocate(1, 24));
+    slPrint(top, slLocate(MIN_X - 1, MIN_Y - 1));
+    slPrint(bottom, slLocate(MIN_X - 1, MAX_Y + 1));
 
     // Draw the sides
-    sprintf(temp, "%c", 22);
-    for(j = 7; j<24; j++)
-    {
-        slPrint(temp, slLocate(1, j));
-        slPrint(temp, slLocate(38, j));
-    }
-
-    // Draw the snake pits
-    sprintf(temp, "%c", 23);
-    topLeftPit[0] = temp[0];
-    topLeftPit[1] = '\0';
-
-    sprintf(temp, "%c", 25);
-    bottomLeftPit[0] = temp[0];
-    bottomLeftPit[1] = '\0';
-
-    sprintf(temp, "%c", 24);
-    topRightPit[0] = temp[0];
-    topRightPit[1] = '\0';
-
-    sprintf(temp, "%c", 26);
-    bottomRightPit[0] = temp[0];
-    bottomRightPit[1] = '\0';
-
-    sprintf(temp, "%c", 22);
-    sidePit[0] = temp[0];
-    sidePit[1] = '\0';
-
-    sprintf(temp, "%c", 21);
-    topPit[0] = temp[0];
-    topPit[1] = '\0';
-
-    // Left Side Pits
-    slPrint(bottomRightPit, slLocate(1,8));
-    slPrint(topLeftPit, slLocate(0,8));
-    slPrint(sidePit, slLocate(0,9));
-    slPrint(" ", slLocate(1,9));
-    slPrint(bottomLeftPit, slLocate(0,10));
-    slPrint(topRightPit, slLocate(1,10));
-
-    slPrint(bottomRightPit, slLocate(1,14));
-    slPrint(topLeftPit, slLocate(0,14));
-    slPrint(sidePit, slLocate(0,15));
-    slPrint(" ", slLocate(1,15));
-    slPrint(bottomLeftPit, slLocate(0,16));
-    slPrint(topRightPit, slLocate(1,16));
-
-    slPrint(bottomRightPit, slLocate(1,20));
-    slPrint(topLeftPit, slLocate(0,20));
-    slPrint(sidePit, slLocate(0,21));
-    slPrint(" ", slLocate(1,21));
-    slPrint(bottomLeftPit, slLocate(0,22));
-    slPrint(topRightPit, slLocate(1,22));
-
-    // Right Side Pits
-    slPrint(bottomLeftPit, slLocate(38,8));
-    slPrint(topRightPit, slLocate(39,8));
-    slPrint(sidePit, slLocate(39,9));
-    slPrint(" ", slLocate(38,9));
-    slPrint(bottomRightPit, slLocate(39,10));
-    slPrint(topLeftPit, slLocate(38,10));
-
-    slPrint(bottomLeftPit, slLocate(38,14));
-    slPrint(topRightPit, slLocate(39,14));
-    slPrint(sidePit, slLocate(39,15));
-    slPrint(" ", slLocate(38,15));
-    slPrint(bottomRightPit, slLocate(39,16));
-    slPrint(topLeftPit, slLocate(38,16));
-
-    slPrint(bottomLeftPit, slLocate(38,20));
-    slPrint(topRightPit, slLocate(39,20));
-    slPrint(sidePit, slLocate(39,21));
-    slPrint(" ", slLocate(38,21));
-    slPrint(bottomRightPit, slLocate(39,22));
-    slPrint(topLeftPit, slLocate(38,22));
-
-    // Top Pits
-    slPrint(bottomRightPit, slLocate(8,6));
-    slPrint(topLeftPit, slLocate(8,5));
-    slPrint(topPit, slLocate(9,5));
-    slPrint(" ", slLocate(9,6));
-    slPrint(topRightPit, slLocate(10,5));
-    slPrint(bottomLeftPit, slLocate(10,6));
-
-    slPrint(bottomRightPit, slLocate(18,6));
-    slPrint(topLeftPit, slLocate(18,5));
-    slPrint(topPit, slLocate(19,5));
-    slPrint(" ", slLocate(19,6));
-    slPrint(topRightPit, slLocate(20,5));
-    slPrint(bottomLeftPit, slLocate(20,6));
-
-    slPrint(bottomRightPit, slLocate(28,6));
-    slPrint(topLeftPit, slLocate(28,5));
-    slPrint(topPit, slLocate(29,5));
-    slPrint(" ", slLocate(29,6));
-    slPrint(topRightPit, slLocate(30,5));
-    slPrint(bottomLeftPit, slLocate(30,6));
-
-    // Bottom Pits
-    slPrint(topRightPit, slLocate(8,24));
-    slPrint(bottomLeftPit, slLocate(8,25));
-    slPrint(topPit, slLocate(9,25));
-    slPrint(" ", slLocate(9,24));
-    slPrint(bottomRightPit, slLocate(10,25));
-    slPrint(topLeftPit, slLocate(10,24));
-
-    slPrint(topRightPit, slLocate(18,24));
-    slPrint(bottomLeftPit, slLocate(18,25));
-    slPrint(topPit, slLocate(19,25));
-    slPrint(" ", slLocate(19,24));
-    slPrint(bottomRightPit, slLocate(20,25));
-    slPrint(topLeftPit, slLocate(20,24));
-
-    slPrint(topRightPit, slLocate(28,24));
-    slPrint(bottomLeftPit, slLocate(28,25));
-    slPrint(topPit, slLocate(29,25));
-    slPrint(" ", slLocate(29,24));
-    slPrint(bottomRightPit, slLocate(30,25));
-    slPrint(topLeftPit, slLocate(30,24));
-}
-
-void checkForSuddenDeathCollisions(struct snake* players, struct options* gameOptions, struct sudden_death_grid* deathGrid)
-{
-    if(gameOptions->gameType != GAME_BATTLE_ROYALE || gameOptions->suddenDeath != 1)
+    fmtRepeat(side, (char)22, 1);
+    for(j = MIN_Y; j <= MAX_Y; j++)
     {
-        return;
+        slPrint(side, slLocate(MIN_X - 1, j));
+        slPrint(side, slLocate(MAX_X + 1, j));
     }
 
-    for(int i = 0; i < MAX_PLAYERS; i++)
+    // Draw the snake pits, one around every spawn point in the walls
+    glyph[1] = '\0';
+    for(i = 0; i < MAX_PLAYERS; i++)
     {
-        struct snake* someSnake = &players[i];
+        const struct spawn_point* spawn = &g_Spawns[i];
 
-        if(deathGrid->grid[someSnake->head->x - MIN_X][someSnake->head->y - MIN_Y] != 0)
+        if(spawn->pit == 0)
         {
-            someSnake->dying = 1;
             continue;
         }
-    }
-}
 
-void drawSuddenDeathGrid(struct sudden_death_grid* deathGrid)
-{
-    int newX = 0;
-    int newY = 0;
-
-    // check if this is the first time we are calling this
-    if(deathGrid->count == 0)
-    {
-        deathGrid->dir = DIR_DOWN;
-        deathGrid->lastX = 0;
-        deathGrid->lastY = -1;
-    }
-
-    switch(deathGrid->dir)
-    {
-        case DIR_DOWN:
-            newX = deathGrid->lastX;
-            newY = deathGrid->lastY + 1;
-            break;
-        case DIR_UP:
-            newX = deathGrid->lastX;
-            newY = deathGrid->lastY - 1;
-            break;
-        case DIR_LEFT:
-            newX = deathGrid->lastX - 1;
-            newY = deathGrid->lastY;
-            break;
-        case DIR_RIGHT:
-            newX = deathGrid->lastX + 1;
-            newY = deathGrid->lastY;
-            break;
-    }
-
-    if(newX < 0 || newX > MAX_X - MIN_X)
-    {
-        changeSuddenDeathDir(deathGrid);
-        return;
-    }
-
-    if(newY < 0 || newY > MAX_Y - MIN_Y)
-    {
-        changeSuddenDeathDir(deathGrid);
-        return;
-    }
-
-    if(deathGrid->grid[newX][newY] == 'X')
-    {
-        // grid is occupied, try again
-        changeSuddenDeathDir(deathGrid);
-        return;
-    }
-
-    deathGrid->grid[newX][newY] = 'X';
-
-    deathGrid->lastX = newX;
-    deathGrid->lastY = newY;
-
-    slPrint("X", slLocate(deathGrid->lastX + MIN_X, deathGrid->lastY + MIN_Y));
-    deathGrid->count++;
-}
-
-int changeSuddenDeathDir(struct sudden_death_grid* deathGrid)
-{
-    switch(deathGrid->dir)
-    {
-        case DIR_DOWN:
-            deathGrid->dir = DIR_RIGHT;
-            break;
-        case DIR_UP:
-            deathGrid->dir = DIR_LEFT;
-            break;
-        case DIR_LEFT:
-            deathGrid->dir = DIR_DOWN;
-            break;
-        case DIR_RIGHT:
-            deathGrid->dir = DIR_UP;
-            break;
-    }
-
-    return 0;
-}
-
-void checkForCollisions(struct snake* someSnake, struct snake* players)
-{
-    struct location* temp = NULL;
-
-    // Check collision with ceiling
-    if(someSnake->head->y < MIN_Y && someSnake->dir != DIR_DOWN)
-    {
-        someSnake->dying = 1;
-        return;
-    }
-
-    // Check collision with floor
-    if(someSnake->head->y > MAX_Y && someSnake->dir != DIR_UP)
-    {
-        someSnake->dying = 1;
-        return;
-    }
-
-    // Check collision with left wall
-    if(someSnake->head->x < MIN_X && someSnake->dir != DIR_RIGHT)
-    {
-        someSnake->dying = 1;
-        return;
-    }
-
-    // Check collision with right wall
-    if(someSnake->head->x > MAX_X && someSnake->dir != DIR_LEFT)
-    {
-        someSnake->dying = 1;
-        return;
-    }
-
-    // Check for collisions with yourself and other players
-    for(int i = 0; i < MAX_PLAYERS; i++)
-    {
-        if(players[i].active == 1)
+        for(j = 0; j < PIT_CELLS; j++)
         {
-            // Don't check for collisions with your own head!!
-            if(someSnake->ID != i)
-            {
-                temp = players[i].head;
-            }
-            else
-            {
-                temp = players[i].head->next;
-            }
+            const struct pit_cell* cell = &PIT_SHAPES[spawn->dir][j];
 
-            while(temp != NULL)
-            {
-                // check if there was a collision
-                if(someSnake->head->x == temp->x && someSnake->head->y == temp->y)
-                {
-                    // check for head-on collision
-                    if(temp == players[i].head || temp == players[i].head->next)
-                    {
-                        // if Snake is at least twice as big eat the other snake
-                        if(someSnake->currLength >= players[i].currLength * 2)
-                        {
-                            players[i].dying = 1;
-                            someSnake->numPlayersEaten++;
-
-                            // consome the other snake
-                            growSnake(someSnake, players[i].currLength);
-                            return;
-                        }
-                    }
-
-                    someSnake->dying = 1;
-
-                    if(someSnake->ID != players[i].ID)
-                    {
-                        // Other player killed you, reward him
-                        players[i].numKills++;
-                    }
-                    return;
-                }
-                temp = temp->next;
-            }
+            glyph[0] = cell->glyph;
+            slPrint(glyph, slLocate(spawn->x + cell->dx, spawn->y + cell->dy));
         }
     }
 }
 
-void drawSnake(struct snake* someSnake)
-{
-    Uint16 data = 0;
-    //Uint16 i;
-    struct location* temp = NULL;
-
-    // Checks the controller for input
-    data = Smpc_Peripheral[someSnake->controllerNum].data;
-
-    // Check vertical movement
-    if((data & PER_DGT_KD)== 0)
-    {
-        if(someSnake->dir != 0)
-        {
-            someSnake->dir = 1;
-        }
-    }
-    else if((data & PER_DGT_KU)== 0)
-    {
-        if(someSnake->dir != 1)
-        {
-            someSnake->dir = 0;
-        }
-    }
-    // Check horizontal movement
-    else if((data & PER_DGT_KR)== 0)
-    {
-        if(someSnake->dir!= 3)
-        {
-            someSnake->dir = 2;
-        }
-    }
-    else if((data & PER_DGT_KL)== 0)
-    {
-        if(someSnake->dir!=2)
-        {
-            someSnake->dir = 3;
-        }
-    }
-
-    // erase old snake position
-    // need it so that it deletes only the tail
-    temp = (someSnake->head);
-
-    // Temp will be second to last node
-    while(temp->next != someSnake->tail)
-    {
-        temp = temp->next;
-    }
-
-    // Erase the old tail
-    if(someSnake->tail->x != OFF_SCREEN && someSnake->tail->y != OFF_SCREEN)
-    {
-        slPrint(" ", slLocate(someSnake->tail->x, someSnake->tail->y));
-    }
-    temp->next = NULL;
-
-    // Calc snake's new position
-    if(someSnake->dir == DIR_UP)
-    {
-        // up
-        someSnake->tail->y = someSnake->head->y - 1;
-        someSnake->tail->x = someSnake->head->x;
-    }
-    else if(someSnake->dir == DIR_DOWN)
-    {
-        // down
-        someSnake->tail->y = someSnake->head->y + 1;
-        someSnake->tail->x = someSnake->head->x;
-    }
-    else if(someSnake->dir == DIR_RIGHT)
-    {
-        // right
-        someSnake->tail->x = someSnake->head->x + 1;
-        someSnake->tail->y = someSnake->head->y;
-    }
-    else if(someSnake->dir == DIR_LEFT)
-    {
-        // left
-        someSnake->tail->x = someSnake->head->x-1;
-        someSnake->tail->y = someSnake->head->y;
-    }
-
-    // set the new tail
-    someSnake->tail->next = someSnake->head;
-    someSnake->head = someSnake->tail;
-    someSnake->tail = temp;
-    someSnake->tail->next = NULL;
-    temp = NULL;
-
-    // draw new snake position
-    // draws only the new head
-    slPrint(someSnake->shape, slLocate(someSnake->head->x, someSnake->head->y));
-}
-
 // Displays the "Sega Saturn Multiplayer Task Force" presents screen
 void displaySSMTFPresents()
 {
     Uint16 counter = 0;
 
-    do{
-        slPrint("The Sega Saturn", slLocate(13, 11));
-        slPrint("Multiplayer Task Force", slLocate(9, 14));
-        slPrint("Proudly Presents", slLocate(12, 17));
+    displaySSMTFScreen();
 
+    do{
         slSynch();
 
         counter++;
@@ -1078,12 +519,13 @@ void displayText()
     slPrint("Twelve Snakes Version 3.0.1 by Slinga", slLocate(1,1));
 }
 
-void displayJoinText(struct snake* players, struct options* gameOptions)
+void displayJoinText(struct world* world)
 {
+    UNROLL_PLAYERS
     for(int i = 0; i < MAX_PLAYERS; i++)
     {
         // if even one player can join, display the Press A to join button
-        if(isAllowedToSpawn(&players[i], gameOptions) == 1)
+        if(isAllowedToSpawn(world, &world->players[i]) == 1)
         {
             slPrint("Press A to join", slLocate(1,2));
             return;
@@ -1095,7 +537,8 @@ void displayJoinText(struct snake* players, struct options* gameOptions)
 }
 
 // Displays the text "Press Start" and waits for the user to hit start
-void pressStart(struct snake* players, struct options* gameOptions)
+// world is NULL outside of a match, Z only clears the score during one
+void pressStart(struct world* world)
 {
     Uint16 data;
 
@@ -1112,10 +555,10 @@ void pressStart(struct snake* players, struct options* gameOptions)
         // check if the user cleared the scores
         if((data & PER_DGT_TZ) == 0)
         {
-            if(players != NULL && gameOptions != NULL)
+            if(world != NULL)
             {
-                clearScore(players);
-                displayScore(players, gameOptions);
+                worldClearScore(world);
+                displayScore(world->players, &world->options);
             }
         }
 
@@ -1130,260 +573,57 @@ void pressStart(struct snake* players, struct options* gameOptions)
     // hack in case the user is already holding down the start button
     // first check if the start button is pressed, now wait for it to be released
     do{
-        data = Smpc_Peripheral[0].data; // Checks if start button has been pressed
-        slSynch();
-
-    }while((data & PER_DGT_ST) == 0);
-}
-
-void killPlayer(struct snake* somePlayer)
-{
-    // erase Snake
-    eraseSnake(somePlayer->head);
-
-    // You died, so increase your deaths
-    somePlayer->numDeaths++;
-    somePlayer->currLength = 0;
-
-    somePlayer->active = 0;
-    somePlayer->dying = 0;
-    somePlayer->dir = 0;
-}
-
-void eraseSnake(struct location* snakeHead)
-{
-    if(snakeHead->next!=NULL)
-    {
-        eraseSnake(snakeHead->next);
-    }
-
-    if(snakeHead->x != OFF_SCREEN && snakeHead->y != OFF_SCREEN)
-    {
-        slPrint(" ", slLocate(snakeHead->x, snakeHead->y));
-    }
-    free(snakeHead);
-}
-
-void initializeFood(struct food* theFood, char theShape)
-{
-    // Shape, and initial position of food
-    theFood->shape[0] = theShape;
-    theFood->shape[1] = '\0';
-
-    theFood->x = (rand()%(MAX_X - MIN_X + 1)) + MIN_X;
-    theFood->y = (rand()%(MAX_Y - MIN_Y + 1)) + MIN_Y;
-
-    // Print the food
-    slPrint(theFood->shape, slLocate(theFood->x, theFood->y));
-}
-
-void drawFood(struct food* theFood, struct snake* players)
-{
-    struct location* temp = NULL;
-    Uint16 i = 0;
-
-    for(i = 0; i < MAX_PLAYERS; i++)
-    {
-        if(players[i].active == 1)
-        {
-            temp = players[i].head;
-
-            // check if there was a collision
-            if(theFood->x == temp->x && theFood->y == temp->y)
-            {
-                do{
-                    theFood->x = (rand()%(MAX_X - MIN_X + 1)) + MIN_X;
-                    theFood->y = (rand()%(MAX_Y - MIN_Y + 1)) + MIN_Y;
-                }while(safeFood(theFood, players) != 1);
-
-                slPrint(theFood->shape, slLocate(theFood->x, theFood->y));
-
-                // Add a new segment, make that segment the tail
-                growSnake(&players[i], 1);
-
-                // You ate the apple, increase your score
-                players[i].numApples++;
-
-
-                if(players[i].currLength > players[i].maxLength)
-                {
-                    players[i].maxLength = players[i].currLength;
-                }
-
-                return;
-            }
-        }
-    }
-}
-
-void growSnake(struct snake* player, int amount)
-{
-    struct location* temp = NULL;
-
-    for(int i = 0; i < amount; i++)
-    {
-        temp = (struct location*)malloc(sizeof(struct location));
-
-        player->tail->next = temp;
-        temp->x = OFF_SCREEN;
-        temp->y = OFF_SCREEN;
-        temp->next = NULL;
-
-        player->tail = temp;
-        player->currLength++;
-    }
-}
-
-int safeFood(struct food* someFood, struct snake* players)
-{
-    struct location* temp;
-
-    for(int i = 0; i < MAX_PLAYERS; i++)
-    {
-        if(players[i].active == 1)
-        {
-            temp = players[i].head;
-
-            while(temp!=NULL)
-            {
-                // check if there was a collision
-                if(someFood->x == temp->x && someFood->y == temp->y)
-                {
-                    return 0;
-                }
-                temp = temp->next;
-            }
-        }
-    }
-
-    return 1;
-}
-
-void clearScore(struct snake* players)
-{
-    int i;
-
-    for(i = 0; i < MAX_PLAYERS; i++)
-    {
-        players[i].numApples = 0;
-        players[i].numDeaths = 0;
-        players[i].numPlayersEaten = 0;
-        players[i].numKills = 0;
-        players[i].currLength = 0;
-        players[i].maxLength = 0;
-        players[i].score = 0;
-    }
-}
-
-void validateScore(struct snake* players, struct options* gameOptions)
-{
-    int i;
-    int gameType = gameOptions->gameType;
-
-    for(i = 0; i < MAX_PLAYERS; i++)
-    {
-        players[i].numApples = MIN(players[i].numApples, MAX_SCORE);
-        players[i].numApples = MAX(players[i].numApples, MIN_SCORE);
-
-        players[i].numDeaths = MIN(players[i].numDeaths, MAX_SCORE);
-        players[i].numDeaths = MAX(players[i].numDeaths, MIN_SCORE);
-
-        players[i].numKills = MIN(players[i].numKills, MAX_SCORE);
-        players[i].numKills = MAX(players[i].numKills, MIN_SCORE);
-
-        players[i].numPlayersEaten = MIN(players[i].numPlayersEaten, MAX_SCORE);
-        players[i].numPlayersEaten = MAX(players[i].numPlayersEaten, MIN_SCORE);
-
-        players[i].currLength = MIN(players[i].currLength, MAX_SCORE);
-        players[i].currLength = MAX(players[i].currLength, MIN_SCORE);
-
-        players[i].maxLength = MIN(players[i].maxLength, MAX_SCORE);
-        players[i].maxLength = MAX(players[i].maxLength, MIN_SCORE);
+        data = Smpc_Peripheral[0].data; // Checks if start button has been pressed
+        slSynch();
 
-        if(gameType == GAME_FREE_FOR_ALL || gameType == GAME_SCORE_ATTACK)
-        {
-            players[i].score = players[i].numApples + players[i].numKills - players[i].numDeaths;
-            players[i].score = MIN(players[i].score, MAX_SCORE);
-            players[i].score = MAX(players[i].score, MIN_SCORE);
-        }
-        else if(gameType == GAME_BATTLE_ROYALE)
-        {
-            players[i].score = gameOptions->maxLives - players[i].numDeaths;
-        }
-        else if(gameType == GAME_SURVIVOR)
-        {
-            players[i].score = players[i].currLength;
-        }
-        else if(gameType == GAME_KING_OF_THE_HILL)
-        {
-            players[i].score = players[i].maxLength;
-        }
-    }
+    }while((data & PER_DGT_ST) == 0);
 }
 
-/* Function to sort an array using insertion sort*/
-void insertionSort(struct snake* players)
+/* Function to sort players by score using insertion sort, order gets the
+   player indexes highest score first */
+void insertionSort(struct snake* players, int* order)
 {
     int i, j;
-    struct snake key = {0};
+    int key = 0;
+
+    for (i = 0; i < MAX_PLAYERS; i++) {
+        order[i] = i;
+    }
+
     for (i = 1; i < MAX_PLAYERS; i++) {
-        key = players[i];
+        key = order[i];
         j = i - 1;
 
         /* Move elements of arr[0..i-1], that are
           greater than key, to one position ahead
           of their current position */
-        while (j >= 0 && players[j].score < key.score) {
-            players[j + 1] = players[j];
+        while (j >= 0 && players[order[j]].score < players[key].score) {
+            order[j + 1] = order[j];
             j = j - 1;
         }
-        players[j + 1] = key;
-    }
-}
-
-int calculatePlayersRemaining(struct snake* players, struct options* gameOptions)
-{
-    int count = 0;
-
-    for(int i = 0; i < MAX_PLAYERS; i++)
-    {
-        // if the player is alive currently, count them
-        if(players[i].active == 1)
-        {
-            count++;
-            continue;
-        }
-
-        // if the player was ever active, but still has lives count them as alive
-        if(players[i].everActive == 1 && isAllowedToSpawn(&players[i], gameOptions) == 1)
-        {
-            count++;
-            continue;
-        }
+        order[j + 1] = key;
     }
-
-    return count;
 }
 
-int displayScoreBar(struct snake* players, struct options* gameOptions)
+// Draws the top left square of the score bar. The ranking is sorted and drawn
+// by g_RankTask in the slowdown frames. Returns 1 if a score limit ends the game.
+int displayScoreBarScores(struct world* world)
 {
+    struct snake* players = world->players;
+    struct options* gameOptions = &world->options;
     int gameLimitReached = 0;
     int pointsRemaining = 0;
     int highScore = 0;
     int playersRemaining = 0;
-    int spawnTime = 0;
-    int mins = 0;
-    int secs = 0;
-    int timeDiff = 0;
-    int currSeconds = 0;
-    int counter = 0;
-    struct snake sortedPlayers[MAX_PLAYERS] = {0};
+    int leader = worldLeader(world);
     char temp[16] = {0};
+    char* p = NULL;
 
-    // sort the player scores. The "score" field will be different depending on the game type
-    validateScore(players, gameOptions);
-    memcpy(sortedPlayers, players, sizeof(sortedPlayers));
-    insertionSort(sortedPlayers);
+    // the "score" field will be different depending on the game type
+    if(leader != EVENT_NO_PLAYER)
+    {
+        highScore = players[leader].score;
+    }
 
     // top left square is game options and points remaining
     switch(gameOptions->gameType)
@@ -1391,70 +631,187 @@ int displayScoreBar(struct snake* players, struct options* gameOptions)
         case GAME_FREE_FOR_ALL:
 
             // FFA game never ends, but display highest score
-            highScore = sortedPlayers[0].score;
             if(highScore < 0)
             {
                 highScore = 0;
             }
 
-            sprintf(temp, "%s %03i", "FFA", highScore);
+            p = fmtString(temp, "FFA ");
+            fmtDecimal(p, highScore, 3, '0');
             break;
 
         case GAME_SCORE_ATTACK:
 
             // game ends when score is reached
             // display points remainign
-            pointsRemaining = gameOptions->maxScore - sortedPlayers[0].score;
+            pointsRemaining = gameOptions->maxScore - highScore;
             if(pointsRemaining <= 0)
             {
                 pointsRemaining = 0;
                 gameLimitReached = 1;
             }
-            sprintf(temp, " %s %03i", "SA", pointsRemaining);
+            p = fmtString(temp, " SA ");
+            fmtDecimal(p, pointsRemaining, 3, '0');
             break;
 
         case GAME_BATTLE_ROYALE:
 
             // game ends when there is only one player left standing
-            playersRemaining = calculatePlayersRemaining(players, gameOptions);
+            playersRemaining = worldPlayersRemaining(world);
 
             if(playersRemaining <= 1)
             {
                 gameLimitReached = 1;
             }
-            sprintf(temp, "%s %03i", "BR", playersRemaining);
+            p = fmtString(temp, "BR ");
+            fmtDecimal(p, playersRemaining, 3, '0');
             break;
 
         case GAME_SURVIVOR:
-            sprintf(temp, "%s %03i", "SRV", sortedPlayers[0].score);
+            p = fmtString(temp, "SRV ");
+            fmtDecimal(p, highScore, 3, '0');
             break;
 
         case GAME_KING_OF_THE_HILL:
-            sprintf(temp, "%s %03i", "KTH", sortedPlayers[0].score);
+            p = fmtString(temp, "KTH ");
+            fmtDecimal(p, highScore, 3, '0');
             break;
     }
     slPrint(temp, slLocate(1,5));
 
+    // sort again from the current order, usually only a place or two changed
+    g_RankNext = 1;
+    idleQueue(&g_RankTask);
+
+    return gameLimitReached;
+}
+
+void rankReset()
+{
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        g_RankOrder[i] = i;
+    }
+    g_RankNext = MAX_PLAYERS;
+}
+
+// Draws the 3rd square, the ranking of the top 7 players, and the bottom four
+// areas, the 4 highest scoring players
+static void drawRanking(struct snake* players, int* order)
+{
+    int counter = 0;
+    char temp[16] = {0};
+    char* p = NULL;
+
+    for(int i = 0; i < MAX_PLAYERS && counter < 7; i++)
+    {
+        if(players[order[i]].everActive == 0)
+        {
+            continue;
+        }
+
+        temp[counter] = players[order[i]].shape[0];
+        counter++;
+    }
+
+    if(counter > 0)
+    {
+        temp[counter] = '\0';
+        slPrint(temp, slLocate(21, 5));
+    }
+
+    counter = 0;
+    for(int i = 0; i < MAX_PLAYERS && counter < 4; i++)
+    {
+        if(players[order[i]].everActive == 0)
+        {
+            continue;
+        }
+
+        p = fmtRepeat(temp, players[order[i]].shape[0], 3);
+        p = fmtString(p, " ");
+        fmtDecimal(p, players[order[i]].score, 3, '0');
+        slPrint(temp, slLocate(1 + (counter*10), MAX_Y + 2));
+        counter++;
+    }
+}
+
+// One insertion sort step per slice. The order is kept from the last sort,
+// so a step is usually a single compare.
+int rankStep(void* state)
+{
+    struct world* world = (struct world*)state;
+    struct snake* players = world->players;
+    int key = 0;
+    int j = 0;
+
+    if(g_RankNext < MAX_PLAYERS)
+    {
+        key = g_RankOrder[g_RankNext];
+        j = g_RankNext - 1;
+
+        while(j >= 0 && players[g_RankOrder[j]].score < players[key].score)
+        {
+            g_RankOrder[j + 1] = g_RankOrder[j];
+            j--;
+        }
+        g_RankOrder[j + 1] = key;
+
+        g_RankNext++;
+        return IDLE_MORE;
+    }
+
+    drawRanking(players, g_RankOrder);
+    return IDLE_DONE;
+}
+
+int statsStep(void* state)
+{
+    (void)state;
+
+    if(statsFold(16) == 1)
+    {
+        return IDLE_MORE;
+    }
+
+    return IDLE_DONE;
+}
+
+int displayScoreBar(struct world* world)
+{
+    struct options* gameOptions = &world->options;
+    static int scoreLimitReached = 0;
+    int gameLimitReached = 0;
+    int spawnTime = 0;
+    int timeDiff = 0;
+    char temp[16] = {0};
+    char* p = NULL;
+
+    // scores only change on apples, kills, deaths and growth, most ticks
+    // there is nothing to sort or redraw
+    if(world->scoreChanged == 1)
+    {
+        world->scoreChanged = 0;
+        scoreLimitReached = displayScoreBarScores(world);
+    }
+    gameLimitReached = scoreLimitReached;
+
     // 2nd top square is for time remaining
     switch(gameOptions->gameType)
     {
         case GAME_FREE_FOR_ALL:
 
             // Free-For-All timer counts up
-            currSeconds = getSeconds();
-            timeDiff = currSeconds - gameOptions->startTime;
+            timeDiff = gameOptions->elapsed;
 
-            mins = timeDiff / 60;
-            secs = timeDiff % 60;
             break;
 
         case GAME_BATTLE_ROYALE:
 
             // Battle Royale games can't end before 15 seconds (to allow people to join in)
             // and once the timer hits, the game doesn't end but sudden death starts
-            currSeconds = getSeconds();
-            spawnTime = gameOptions->startTime + 15 - currSeconds;
-            timeDiff = gameOptions->startTime + gameOptions->maxTime - currSeconds;
+            spawnTime = 15 - gameOptions->elapsed;
+            timeDiff = gameOptions->maxTime - gameOptions->elapsed;
 
             if(spawnTime > 0)
             {
@@ -1464,12 +821,16 @@ int displayScoreBar(struct snake* players, struct options* gameOptions)
 
             if(timeDiff <= 0)
             {
+                if(gameOptions->suddenDeath == 0)
+                {
+                    // nobody can respawn now, count the players remaining again
+                    world->scoreChanged = 1;
+                }
+
                 gameOptions->suddenDeath = 1;
                 timeDiff = 0;
             }
 
-            mins = timeDiff / 60;
-            secs = timeDiff % 60;
             break;
 
         case GAME_SCORE_ATTACK:
@@ -1477,8 +838,7 @@ int displayScoreBar(struct snake* players, struct options* gameOptions)
         case GAME_KING_OF_THE_HILL:
 
             // all other game modes have a timer that counts down
-            currSeconds = getSeconds();
-            timeDiff = gameOptions->startTime + gameOptions->maxTime - currSeconds;
+            timeDiff = gameOptions->maxTime - gameOptions->elapsed;
 
             if(timeDiff <= 0)
             {
@@ -1486,46 +846,17 @@ int displayScoreBar(struct snake* players, struct options* gameOptions)
                 timeDiff = 0;
             }
 
-            mins = timeDiff / 60;
-            secs = timeDiff % 60;
             break;
     }
-    sprintf(temp, " %02i:%02i", mins, secs);
+    p = fmtString(temp, " ");
+    fmtClock(p, timeDiff);
     slPrint(temp, slLocate(11,5));
 
-    // 3rd square is for ranking of top 7 players
-    counter = 0;
-    for(int i = 0; i < MAX_PLAYERS && counter < 7; i++)
-    {
-        if(sortedPlayers[i].everActive == 0)
-        {
-            continue;
-        }
-
-        sprintf(temp, "%c", sortedPlayers[i].shape[0]);
-        slPrint(temp, slLocate(21 + counter, 5));
-        counter++;
-    }
-
     // 4th square is for the slow down speed
-    sprintf(temp, "SD %1i", gameOptions->slowdown);
+    p = fmtString(temp, "SD ");
+    fmtDecimal(p, gameOptions->slowdown, 1, ' ');
     slPrint(temp, slLocate(31,5));
 
-    // bottom four areas are for the 4 highest scoring players
-    counter = 0;
-    for(int i = 0; i < MAX_PLAYERS && counter < 4; i++)
-    {
-        if(sortedPlayers[i].everActive == 0)
-        {
-            continue;
-        }
-
-        sprintf(temp, "%c%c%c %03i", sortedPlayers[i].shape[0], sortedPlayers[i].shape[0],
-                                     sortedPlayers[i].shape[0], sortedPlayers[i].score);
-        slPrint(temp, slLocate(1 + (counter*10), MAX_Y + 2));
-        counter++;
-    }
-
     return gameLimitReached;
 }
 
@@ -1537,7 +868,7 @@ void displayMenu(struct options* gameOptions)
     int numSubOptions = 0;
     int suboptionsResult = 0;
     char* gameMode = NULL;
-    struct suboptions subOptions[3] = {0}; // max number of options for subtype is 3
+    struct suboptions subOptions[4] = {0}; // max number of options for subtype is 4
 
     memset(gameOptions, 0, sizeof(struct options));
     gameOptions->slowdown = INITIAL_SLOWDOWN;
@@ -1555,9 +886,26 @@ void displayMenu(struct options* gameOptions)
         slPrint("   Battle Royale", slLocate(4,counter++));
         slPrint("   Survivor", slLocate(4,counter++));
         slPrint("   King of the Hill", slLocate(4,counter++));
+        counter++;
 
         do
         {
+            // Left\Right picks link play
+            if (LINK_PLAY_SUPPORTED == 1 && jo_is_input_key_down(0, JO_KEY_LEFT))
+            {
+                g_LinkPlay = (g_LinkPlay + NUM_LINK_PLAY - 1) % NUM_LINK_PLAY;
+            }
+
+            if (LINK_PLAY_SUPPORTED == 1 && jo_is_input_key_down(0, JO_KEY_RIGHT))
+            {
+                g_LinkPlay = (g_LinkPlay + 1) % NUM_LINK_PLAY;
+            }
+
+            if (LINK_PLAY_SUPPORTED == 1)
+            {
+                slPrint((char*)LINK_PLAY_NAMES[g_LinkPlay], slLocate(4, counter));
+            }
+
             // check if the user is selecting a different option
             if (jo_is_input_key_down(0, JO_KEY_DOWN))
             {
@@ -1607,12 +955,23 @@ void displayMenu(struct options* gameOptions)
         }
         while(jo_is_input_key_pressed(0, JO_KEY_START) || jo_is_input_key_pressed(0, JO_KEY_A) || jo_is_input_key_pressed(0, JO_KEY_B));
 
+        if(g_LinkPlay == LINK_PLAY_GUEST)
+        {
+            // the host picks the game
+            if(linkConnect(gameOptions, LINK_SIDE_GUEST) == 0)
+            {
+                continue;
+            }
+            break;
+        }
+
         // depending on the game type, there are suboptions
         switch(gameOptions->gameType)
         {
             case GAME_FREE_FOR_ALL:
-                // no options for free for allocate
+                // no options for free for all but the CPU snakes
                 numSubOptions = 0;
+                gameMode = "Free For All";
                 break;
 
             case GAME_SCORE_ATTACK:
@@ -1646,6 +1005,12 @@ void displayMenu(struct options* gameOptions)
                 break;
         }
 
+        // no CPU snakes in link play, the other console can't see them think
+        if(g_LinkPlay == LINK_PLAY_OFF)
+        {
+            memcpy(&subOptions[numSubOptions++], &SUBOPTION_BOTS, sizeof(struct suboptions));
+        }
+
         if(numSubOptions > 0)
         {
             suboptionsResult = displaySubMenu(gameOptions, gameMode, numSubOptions, subOptions);
@@ -1660,11 +1025,15 @@ void displayMenu(struct options* gameOptions)
             // user hit B, continue
             continue;
         }
-        else
+
+        if(g_LinkPlay == LINK_PLAY_HOST && linkConnect(gameOptions, LINK_SIDE_HOST) == 0)
         {
-            break;
+            // user hit B while waiting for a guest
+            continue;
         }
 
+        break;
+
     }while(1);
 
     clearScreen();
@@ -1676,6 +1045,7 @@ int displaySubMenu(struct options* gameOptions, char* gameMode, int numSubOption
     int counter = 8;
     int cursorPosition = 0;
     char temp[32];
+    char* p = NULL;
 
     clearScreen();
 
@@ -1683,7 +1053,8 @@ int displaySubMenu(struct options* gameOptions, char* gameMode, int numSubOption
     {
         counter = 8;
 
-        sprintf(temp, "%s Options", gameMode);
+        p = fmtString(temp, gameMode);
+        fmtString(p, " Options");
         slPrint(temp, slLocate(4,counter++));
         slPrint("-------------------------------", slLocate(4,counter++));
         slPrint("                               ", slLocate(4,counter++));
@@ -1691,7 +1062,13 @@ int displaySubMenu(struct options* gameOptions, char* gameMode, int numSubOption
         for(int i = 0; i < numSubOptions; i++)
         {
             int pos = subOptions[i].position;
-            sprintf(temp, "   %s %d %s   ", subOptions[i].optionName, subOptions[i].values[pos], subOptions[i].optionType);
+            p = fmtString(temp, "   ");
+            p = fmtString(p, subOptions[i].optionName);
+            p = fmtString(p, " ");
+            p = fmtDecimal(p, subOptions[i].values[pos], 1, ' ');
+            p = fmtString(p, " ");
+            p = fmtString(p, subOptions[i].optionType);
+            fmtString(p, "   ");
             slPrint(temp, slLocate(4,counter++));
         }
 
@@ -1794,6 +1171,11 @@ int displaySubMenu(struct options* gameOptions, char* gameMode, int numSubOption
         {
             gameOptions->slowdown = subOptions[i].values[pos];
         }
+        else if(strcmp(subOptions[i].optionType, "snakes") == 0)
+        {
+            // a player slot is always left for player one
+            gameOptions->bots = subOptions[i].values[pos] < MAX_PLAYERS ? subOptions[i].values[pos] : MAX_PLAYERS - 1;
+        }
     }
 
     clearScreen();
@@ -1822,41 +1204,73 @@ void checkForABCStart()
 void displayScore(struct snake* players, struct options* gameOptions)
 {
     char temp[50];
+    char* p = NULL;
     Uint16 counter = 8;
-    struct snake sortedPlayers[MAX_PLAYERS] = {0};
+    int order[MAX_PLAYERS] = {0};
     int rank = 1;
 
     temp[0] = '\0';
 
-    validateScore(players, gameOptions);
-
-    memcpy(sortedPlayers, players, sizeof(sortedPlayers));
-
-    insertionSort(sortedPlayers);
+    insertionSort(players, order);
 
     slPrint("R# CHR  L#  M#  A#  K#  C#  D#  S#", slLocate(3,counter++));
     slPrint("----------------------------------", slLocate(3,counter++));
     slPrint("                                   ", slLocate(3,counter++));
 
-    for(int i = 0; i < MAX_PLAYERS; i++)
+    // rows run out above "Press Start", with two consoles only the top 12 fit
+    for(int i = 0; i < MAX_PLAYERS && counter < 23; i++)
     {
+        struct snake* player = &players[order[i]];
+
         // display the score if the player is currently active (or has ever been active)
-        if(sortedPlayers[i].everActive == 1)
+        if(player->everActive == 1)
         {
-            sprintf(temp, "%2i %c%c%c %3i %3i %3i %3i %3i %3i %3i", rank, sortedPlayers[i].shape[0], sortedPlayers[i].shape[0], sortedPlayers[i].shape[0],
-                                                                 sortedPlayers[i].currLength, sortedPlayers[i].maxLength, sortedPlayers[i].numApples,
-                                                                 sortedPlayers[i].numKills, sortedPlayers[i].numPlayersEaten, sortedPlayers[i].numDeaths,
-                                                                 sortedPlayers[i].score);
+            // "%2i %c%c%c %3i %3i %3i %3i %3i %3i %3i"
+            int columns[7] = {player->currLength, player->maxLength, player->numApples,
+                              player->numKills, player->numPlayersEaten, player->numDeaths,
+                              player->score};
+
+            p = fmtDecimal(temp, rank, 2, ' ');
+            p = fmtString(p, " ");
+            p = fmtRepeat(p, player->shape[0], 3);
+            for(int j = 0; j < 7; j++)
+            {
+                p = fmtString(p, " ");
+                p = fmtDecimal(p, columns[j], 3, ' ');
+            }
+
             slPrint(temp, slLocate(3,counter++));
             rank++;
         }
     }
 }
 
+// Shows the best score ever recorded for the current game mode on the dedication line
+void displayBestScore(struct options* gameOptions)
+{
+    char temp[40];
+    char* p = NULL;
+    const struct best_score* best = &statsRecord()->best[gameOptions->gameType];
+
+    if(best->valid == 0)
+    {
+        return;
+    }
+
+    p = fmtString(temp, "Best score ");
+    p = fmtDecimal(p, best->score, 3, ' ');
+    p = fmtString(p, " by player ");
+    fmtDecimal(p, best->slot + 1, 1, ' ');
+    slPrint(temp, slLocate(3, 26));
+}
+
 void clearScreen()
 {
     Uint16 i = 0;
 
+    // don't let queued gameplay writes land on top of the next screen
+    textPlaneFlush();
+
     for(i = 7; i < 24; i++)
     {
         slPrint("                                    ", slLocate(2,i));
@@ -1866,34 +1280,39 @@ void clearScreen()
     slPrint("                                    ", slLocate(2,26)); // dedication line
 }
 
-void redrawScreen(struct snake* players, struct food* theFood, struct sudden_death_grid* deathGrid)
+void redrawScreen(struct world* world)
 {
+    struct snakes* snakes = world->snakes;
+    struct food* theFood = &world->food;
     Uint16 i = 0;
     struct location* temp = NULL;
 
     for(i = 0; i < MAX_PLAYERS; i++)
     {
         // redraw only the active players
-        if(players[i].active == 1)
+        if(snakes->active[i] == 1)
         {
-            temp = players[i].head;
+            temp = snakes->head[i];
 
             while(temp != NULL)
             {
-                if(temp->x != OFF_SCREEN && temp->y != OFF_SCREEN)
-                {
-                    slPrint(players[i].shape, slLocate(temp->x, temp->y));
-                }
+                textPlanePut(temp->x, temp->y, g_SnakeGlyphs[i]);
                 temp = temp->next;
             }
         }
     }
 
-    slPrint(theFood->shape, slLocate(theFood->x, theFood->y));
+    for(i = 0; i < theFood->count; i++)
+    {
+        textPlanePut(theFood->items[i].x, theFood->items[i].y, theFood->shape[0]);
+    }
 
+    // a snake that died on the wall was erased on top of it, let those
+    // writes land before the wall is drawn again
+    textPlaneFlush();
     drawGrid();
 
-    redrawSuddenDeathGrid(deathGrid);
+    redrawSuddenDeathGrid(&world->deathGrid);
 }
 
 #define SUDDEN_DEATH_CHAR 'X'
@@ -1911,7 +1330,7 @@ void redrawSuddenDeathGrid(struct sudden_death_grid* suddenDeath)
         {
             if(suddenDeath->grid[x][y] == 'X')
             {
-                slPrint("X", slLocate(x + MIN_X, y + MIN_Y));
+                textPlanePut(x + MIN_X, y + MIN_Y, 'X');
             }
         }
     }
@@ -1919,101 +1338,23 @@ void redrawSuddenDeathGrid(struct sudden_death_grid* suddenDeath)
 
 void titleScreen()
 {
-    slPrint("TTTTTT", slLocate(3,8));
-    slPrint("  TT  ", slLocate(3,9));
-    slPrint("  TT  ", slLocate(3,10));
-    slPrint("  TT  ", slLocate(3,11));
-    slPrint("  TT  ", slLocate(3,12));
-    slPrint("  TT  ", slLocate(3,13));
-
-    slPrint("W     W", slLocate(10,8));
-    slPrint("W     W", slLocate(10,9));
-    slPrint("W  W  W", slLocate(10,10));
-    slPrint("WW W WW", slLocate(10,11));
-    slPrint(" WWWWW ", slLocate(10,12));
-    slPrint(" WW WW ", slLocate(10,13));
-
-    slPrint("EEEE", slLocate(18,8));
-    slPrint("E   ", slLocate(18,9));
-    slPrint("EEEE", slLocate(18,10));
-    slPrint("EEEE", slLocate(18,11));
-    slPrint("E   ", slLocate(18,12));
-    slPrint("EEEE", slLocate(18,13));
-
-    slPrint("L  ", slLocate(23,8));
-    slPrint("L  ", slLocate(23,9));
-    slPrint("L  ", slLocate(23,10));
-    slPrint("L  ", slLocate(23,11));
-    slPrint("L  ", slLocate(23,12));
-    slPrint("LLL", slLocate(23,13));
-
-    slPrint("V   V", slLocate(26,8));
-    slPrint("V   V", slLocate(26,9));
-    slPrint("V   V", slLocate(26,10));
-    slPrint("VV VV", slLocate(26,11));
-    slPrint(" V V ", slLocate(26,12));
-    slPrint(" VVV ", slLocate(26,13));
-
-    slPrint("EEEE", slLocate(32,8));
-    slPrint("E   ", slLocate(32,9));
-    slPrint("EEEE", slLocate(32,10));
-    slPrint("EEEE", slLocate(32,11));
-    slPrint("E   ", slLocate(32,12));
-    slPrint("EEEE", slLocate(32,13));
-
-    slPrint("SSSS", slLocate(4,15));
-    slPrint("S   ", slLocate(4,16));
-    slPrint("S   ", slLocate(4,17));
-    slPrint("SSSS", slLocate(4,18));
-    slPrint("   S", slLocate(4,19));
-    slPrint("   S", slLocate(4,20));
-    slPrint("SSSS", slLocate(4,21));
-
-    slPrint("N   N", slLocate(9,15));
-    slPrint("NN  N", slLocate(9,16));
-    slPrint("N N N", slLocate(9,17));
-    slPrint("N NNN", slLocate(9,18));
-    slPrint("N  NN", slLocate(9,19));
-    slPrint("N   N", slLocate(9,20));
-    slPrint("N   N", slLocate(9,21));
-
-    slPrint("  A  ", slLocate(15,15));
-    slPrint(" AAA ", slLocate(15,16));
-    slPrint("AA AA", slLocate(15,17));
-    slPrint("A   A", slLocate(15,18));
-    slPrint("AAAAA", slLocate(15,19));
-    slPrint("A   A", slLocate(15,20));
-    slPrint("A   A", slLocate(15,21));
-
-    slPrint("K  K", slLocate(21,15));
-    slPrint("K  K", slLocate(21,16));
-    slPrint("K K ", slLocate(21,17));
-    slPrint("KKK ", slLocate(21,18));
-    slPrint("K K ", slLocate(21,19));
-    slPrint("K  K", slLocate(21,20));
-    slPrint("K  K", slLocate(21,21));
-
-    slPrint("EEEE", slLocate(26,15));
-    slPrint("E   ", slLocate(26,16));
-    slPrint("E   ", slLocate(26,17));
-    slPrint("EEEE", slLocate(26,18));
-    slPrint("E   ", slLocate(26,19));
-    slPrint("E   ", slLocate(26,20));
-    slPrint("EEEE", slLocate(26,21));
-
-    slPrint("SSSS", slLocate(31,15));
-    slPrint("S   ", slLocate(31,16));
-    slPrint("S   ", slLocate(31,17));
-    slPrint("SSSS", slLocate(31,18));
-    slPrint("   S", slLocate(31,19));
-    slPrint("   S", slLocate(31,20));
-    slPrint("SSSS", slLocate(31,21));
-
-
-    slPrint("Dedicated to the man with one knee", slLocate(3,26));
-
-    pressStart(NULL, NULL);
+    // heading, playing field, title and dedication in one DMA
+    displayTitleScreen();
+
+    pressStart(NULL);
     clearScreen();
+
+    // other builds have their own arena or fewer pits, swap the field
+    if(TITLE_FIELD_MATCHES == 0)
+    {
+        // rows 5 to 25 hold the title's field with its pits
+        for(int y = 5; y <= 25; y++)
+        {
+            slPrint("                                        ", slLocate(0, y));
+        }
+
+        drawGrid();
+    }
 }
 
 void getTime(jo_datetime* currentTime)
@@ -2044,3 +1385,156 @@ unsigned int getSeconds()
 
     return numSeconds;
 }
+
+// Fills inputs[] with every player's pad for this tick. Without a link the
+// other console's players never press anything.
+void readInputs(struct options* gameOptions, Uint16* inputs)
+{
+    Uint16 local[LOCAL_PLAYERS];
+    int elapsed = getSeconds() - gameOptions->startTime;
+
+    for(int i = 0; i < LOCAL_PLAYERS; i++)
+    {
+        local[i] = Smpc_Peripheral[g_ControllerPorts[i]].data;
+    }
+
+    if(gameOptions->linked == 0)
+    {
+        for(int i = 0; i < MAX_PLAYERS; i++)
+        {
+            inputs[i] = (i < LOCAL_PLAYERS) ? local[i] : LINK_NEUTRAL_PAD;
+        }
+
+        gameOptions->elapsed = elapsed;
+        return;
+    }
+
+    // sampled now, played LINK_INPUT_DELAY ticks from now
+    while(linkSubmit(&g_Link, local, elapsed, (unsigned int)g_World.hash) == 0)
+    {
+        checkForABCStart();
+        slSynch();
+        pumpLink();
+    }
+
+    // usually here already, the slowdown frames gave it time to arrive
+    while(linkReady(&g_Link, g_LinkTick) == 0)
+    {
+        checkForABCStart();
+        slSynch();
+        pumpLink();
+    }
+
+    linkInputs(&g_Link, g_LinkTick, inputs, &gameOptions->elapsed);
+    g_LinkTick++;
+
+    if(g_Link.desynced == 1)
+    {
+        linkOutOfSync();
+    }
+
+    for(int i = 2 * LINK_PLAYERS_PER_CONSOLE; i < MAX_PLAYERS; i++)
+    {
+        inputs[i] = LINK_NEUTRAL_PAD;
+    }
+}
+
+// Connects to the other console over the serial port. The host sends the
+// options picked on its menu and the guest plays with those.
+// Returns 0 if the player gave up waiting.
+int linkConnect(struct options* gameOptions, int side)
+{
+    struct link_transport transport = {0};
+    struct link_start start = {0};
+    int state = LINK_WAITING;
+
+    linkSciTransport(&transport);
+    linkInit(&g_Link, &transport, side);
+
+    if(side == LINK_SIDE_HOST)
+    {
+        start.gameType = gameOptions->gameType;
+        start.maxLives = gameOptions->maxLives;
+        start.maxScore = gameOptions->maxScore;
+        start.maxTime = gameOptions->maxTime;
+        start.slowdown = gameOptions->slowdown;
+        start.seed = getSeconds();
+        linkHost(&g_Link, &start);
+    }
+
+    clearScreen();
+    if(side == LINK_SIDE_HOST)
+    {
+        slPrint("Waiting for a guest console", slLocate(6, 13));
+    }
+    else
+    {
+        slPrint("Waiting for the host console", slLocate(6, 13));
+    }
+    slPrint("Press B to cancel", slLocate(6, 15));
+
+    do
+    {
+        if(jo_is_input_key_down(0, JO_KEY_B))
+        {
+            clearScreen();
+            return 0;
+        }
+
+        slSynch();
+        state = linkPoll(&g_Link);
+
+    }while(state == LINK_WAITING);
+
+    clearScreen();
+
+    if(state != LINK_RUNNING || g_Link.start.gameType < 0 || g_Link.start.gameType >= NUM_GAME_TYPES)
+    {
+        return 0;
+    }
+
+    if(side == LINK_SIDE_GUEST)
+    {
+        gameOptions->gameType = g_Link.start.gameType;
+        gameOptions->maxLives = g_Link.start.maxLives;
+        gameOptions->maxScore = g_Link.start.maxScore;
+        gameOptions->maxTime = g_Link.start.maxTime;
+        gameOptions->slowdown = g_Link.start.slowdown;
+    }
+
+    // both consoles place the food from the same sequence
+    srand(g_Link.start.seed);
+
+    gameOptions->linked = 1;
+    g_LinkTick = 0;
+    return 1;
+}
+
+// moves bytes to and from the other console, once a frame in link play
+void pumpLink()
+{
+    if(linkPoll(&g_Link) == LINK_LOST)
+    {
+        linkLost();
+    }
+}
+
+void linkLost()
+{
+    clearScreen();
+    slPrint("Link lost", slLocate(15, 15));
+    pressStart(NULL);
+    jo_main(); // same as ABC+Start
+}
+
+void linkOutOfSync()
+{
+    char text[32];
+
+    fmtDecimal(fmtString(text, "Out of sync at tick "), (int)g_Link.desyncTick, 1, ' ');
+
+    clearScreen();
+    slPrint(text, slLocate(10, 15));
+    pressStart(NULL);
+    jo_main();
+}
@@ -0,0 +1,130 @@
+/*
+Twelve Snakes - preassembled full screens
+
+Each screen is the whole 40x30 text plane as it looks after the old slPrint()
+sequence and is copied to VRAM in one go by textPlaneBlit(). The playing field
+border glyphs aren't printable so the maps use stand-ins:
+
+    -  horizontal wall (21)     [  top left corner (23)
+    |  vertical wall (22)       ]  top right corner (24)
+                                {  bottom left corner (25)
+                                }  bottom right corner (26)
+*/
+
+#include <jo/jo.h>
+#include "screens.h"
+#include "textplane.h"
+
+static const char g_SSMTFScreenMap[TEXT_ROWS][TEXT_COLUMNS + 1] =
+{
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "             The Sega Saturn            ",
+    "                                        ",
+    "                                        ",
+    "         Multiplayer Task Force         ",
+    "                                        ",
+    "                                        ",
+    "            Proudly Presents            ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+};
+
+static const char g_TitleScreenMap[TEXT_ROWS][TEXT_COLUMNS + 1] =
+{
+    "                                        ",
+    " Twelve Snakes Version 3.0.1 by Slinga  ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+    "        [-]       [-]       [-]         ",
+    " [------} {-------} {-------} {-------] ",
+    " |                                    | ",
+    "[} TTTTTT W     W EEEE L  V   V EEEE  {]",
+    "|    TT   W     W E    L  V   V E      |",
+    "{]   TT   W  W  W EEEE L  V   V EEEE  [}",
+    " |   TT   WW W WW EEEE L  VV VV EEEE  | ",
+    " |   TT    WWWWW  E    L   V V  E     | ",
+    " |   TT    WW WW  EEEE LLL VVV  EEEE  | ",
+    "[}                                    {]",
+    "|   SSSS N   N   A   K  K EEEE SSSS    |",
+    "{]  S    NN  N  AAA  K  K E    S      [}",
+    " |  S    N N N AA AA K K  E    S      | ",
+    " |  SSSS N NNN A   A KKK  EEEE SSSS   | ",
+    " |     S N  NN AAAAA K K  E       S   | ",
+    "[}     S N   N A   A K  K E       S   {]",
+    "|   SSSS N   N A   A K  K EEEE SSSS    |",
+    "{]                                    [}",
+    " |                                    | ",
+    " {------] [-------] [-------] [-------} ",
+    "        {-}       {-}       {-}         ",
+    "   Dedicated to the man with one knee   ",
+    "                                        ",
+    "                                        ",
+    "                                        ",
+};
+
+static char screenGlyph(char mapGlyph)
+{
+    switch(mapGlyph)
+    {
+        case '-':
+            return (char)21;
+        case '|':
+            return (char)22;
+        case '[':
+            return (char)23;
+        case ']':
+            return (char)24;
+        case '{':
+            return (char)25;
+        case '}':
+            return (char)26;
+        default:
+            return mapGlyph;
+    }
+}
+
+static void displayScreenMap(const char map[TEXT_ROWS][TEXT_COLUMNS + 1])
+{
+    static char glyphs[TEXT_ROWS * TEXT_COLUMNS];
+
+    for(int y = 0; y < TEXT_ROWS; y++)
+    {
+        for(int x = 0; x < TEXT_COLUMNS; x++)
+        {
+            glyphs[(y * TEXT_COLUMNS) + x] = screenGlyph(map[y][x]);
+        }
+    }
+
+    textPlaneBlit(glyphs);
+}
+
+void displaySSMTFScreen()
+{
+    displayScreenMap(g_SSMTFScreenMap);
+}
+
+void displayTitleScreen()
+{
+    displayScreenMap(g_TitleScreenMap);
+}
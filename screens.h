@@ -0,0 +1,11 @@
+/*
+Twelve Snakes - preassembled full screens
+*/
+
+#ifndef SCREENS_H
+#define SCREENS_H
+
+void displaySSMTFScreen(); // "The Sega Saturn Multiplayer Task Force Proudly Presents"
+void displayTitleScreen(); // heading, playing field, title and dedication
+
+#endif
@@ -0,0 +1,702 @@
+/*
+Twelve Snakes - a CPU snake that looks a few ticks ahead
+*/
+
+#include "search.h"
+
+#define CELL(x, y) ((unsigned short)(((y) << 6) | (x)))
+#define CELL_X(cell) ((cell) & 63)
+#define CELL_Y(cell) ((cell) >> 6)
+#define CELL_KEY(kind, player, cell) worldHashKey(kind, player, CELL_Y(cell) * BOARD_WIDTH + CELL_X(cell))
+#define RING(index) ((index) & (SEARCH_RING - 1))
+
+// how often the time limit is looked at, in iterations
+#define SEARCH_TIME_CHECK 8
+
+// exploration, as a fraction of a perfect value over 2
+#define SEARCH_EXPLORE_SHIFT 1
+
+static const signed char STEP_X[4] = {0, 0, 1, -1};
+static const signed char STEP_Y[4] = {-1, 1, 0, 0};
+
+const unsigned char SEARCH_TURNS[4][SEARCH_MOVES] =
+{
+    {DIR_LEFT, DIR_UP, DIR_RIGHT}, // going up
+    {DIR_RIGHT, DIR_DOWN, DIR_LEFT}, // going down
+    {DIR_UP, DIR_RIGHT, DIR_DOWN}, // going right
+    {DIR_DOWN, DIR_LEFT, DIR_UP}, // going left
+};
+
+static unsigned int nextRandom(unsigned int* random)
+{
+    *random ^= *random << 13;
+    *random ^= *random >> 17;
+    *random ^= *random << 5;
+
+    return *random;
+}
+
+//
+// The board
+//
+
+void searchLoad(struct search_board* board, const struct world* world)
+{
+    const struct snakes* snakes = world->snakes;
+
+    board->bits = &world->bits;
+    board->hash = world->hash;
+    memcpy(board->bodies, world->bits.bodies, sizeof(board->bodies));
+    memcpy(board->food, world->bits.food, sizeof(board->food));
+    board->depth = 0;
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        int length = 0;
+
+        board->alive[i] = snakes->active[i];
+        board->dir[i] = snakes->dir[i]; // in the hash even when not playing
+        board->head[i] = 0;
+        board->length[i] = 0;
+        if(snakes->active[i] == 0)
+        {
+            continue;
+        }
+
+        for(const struct location* temp = snakes->head[i]; temp != NULL; temp = temp->next)
+        {
+            board->cells[i][length++] = CELL(temp->x, temp->y);
+        }
+
+        board->length[i] = length;
+        board->growth[i] = snakes->pendingGrowth[i];
+        board->size[i] = world->players[i].currLength;
+    }
+}
+
+// the same as hitWall() in world.c, x, y may be off the board
+static int blockedByWall(const struct search_board* board, int x, int y, int dir)
+{
+    if(x < 0 || x >= BOARD_WIDTH || y < 0 || y >= BOARD_HEIGHT || BIT_TEST(board->bits->walls, x, y) != 0)
+    {
+        return 1;
+    }
+
+    if(BIT_TEST(board->bits->pits, x, y) == 0)
+    {
+        return 0;
+    }
+
+    if(x < MIN_X)
+    {
+        return dir != DIR_RIGHT;
+    }
+
+    if(x > MAX_X)
+    {
+        return dir != DIR_LEFT;
+    }
+
+    if(y < MIN_Y)
+    {
+        return dir != DIR_DOWN;
+    }
+
+    return dir != DIR_UP;
+}
+
+static void collideHeads(const struct search_board* board, int player, int other, char* dies, short* eats)
+{
+    if(board->size[player] >= board->size[other] * 2)
+    {
+        dies[other] = 1;
+        eats[player] += board->size[other];
+        return;
+    }
+
+    dies[player] = 1;
+}
+
+static void setSegments(struct search_board* board, int player, int set)
+{
+    // the head isn't on the board, it died getting where it is
+    for(int k = 1; k < board->length[player]; k++)
+    {
+        unsigned short cell = board->cells[player][RING(board->head[player] + k)];
+
+        if(set == 1)
+        {
+            BIT_SET(board->bodies, CELL_X(cell), CELL_Y(cell));
+        }
+        else
+        {
+            BIT_CLEAR(board->bodies, CELL_X(cell), CELL_Y(cell));
+            board->hash ^= CELL_KEY(HASH_BODY, player, cell);
+        }
+    }
+}
+
+//
+// One tick for every snake, in the order worldStep() does it: everyone
+// moves, the collisions are settled from where everyone ended up, the dead
+// are taken off the board and the survivors eat.
+//
+void searchMake(struct search_board* board, const unsigned char* moves)
+{
+    struct search_undo* undo = &board->undo[board->depth++];
+    char dead[MAX_PLAYERS] = {0}; // hit a wall
+    char dies[MAX_PLAYERS] = {0};
+    short eats[MAX_PLAYERS] = {0};
+    int x[MAX_PLAYERS];
+    int y[MAX_PLAYERS];
+
+    undo->hash = board->hash;
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        unsigned short tail = 0;
+
+        undo->moved[i] = board->alive[i];
+        undo->died[i] = 0;
+        undo->eaten[i] = 0;
+        if(board->alive[i] == 0)
+        {
+            continue;
+        }
+
+        undo->dir[i] = board->dir[i];
+        undo->growth[i] = board->growth[i];
+        undo->size[i] = board->size[i];
+
+        board->dir[i] = SEARCH_TURNS[board->dir[i]][moves[i]];
+        board->hash ^= worldHashKey(HASH_DIR, i, undo->dir[i]) ^ worldHashKey(HASH_DIR, i, board->dir[i]);
+        x[i] = CELL_X(board->cells[i][board->head[i]]) + STEP_X[board->dir[i]];
+        y[i] = CELL_Y(board->cells[i][board->head[i]]) + STEP_Y[board->dir[i]];
+
+        // still growing keeps the tail, otherwise the tail leaves the board
+        undo->grew[i] = board->growth[i] > 0;
+        if(undo->grew[i] == 1)
+        {
+            board->growth[i]--;
+            board->length[i]++;
+        }
+        else
+        {
+            tail = board->cells[i][RING(board->head[i] + board->length[i] - 1)];
+            BIT_CLEAR(board->bodies, CELL_X(tail), CELL_Y(tail));
+            board->hash ^= CELL_KEY(HASH_BODY, i, tail);
+        }
+
+        board->head[i] = RING(board->head[i] - 1);
+        board->cells[i][board->head[i]] = CELL(x[i] & 63, y[i] & 63);
+
+        dead[i] = blockedByWall(board, x[i], y[i], board->dir[i]);
+    }
+
+    // bodies, then heads meeting in a cell, each pair from both sides
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(undo->moved[i] == 0 || dead[i] == 1)
+        {
+            continue;
+        }
+
+        if(BIT_TEST(board->bodies, x[i], y[i]) != 0)
+        {
+            int neck = -1;
+
+            for(int j = 0; j < MAX_PLAYERS; j++)
+            {
+                if(j != i && undo->moved[j] == 1 && board->length[j] > 1 && board->cells[j][RING(board->head[j] + 1)] == board->cells[i][board->head[i]])
+                {
+                    neck = j;
+                }
+            }
+
+            if(neck >= 0)
+            {
+                collideHeads(board, i, neck, dies, eats);
+            }
+            else
+            {
+                dies[i] = 1;
+            }
+        }
+
+        for(int j = 0; j < MAX_PLAYERS; j++)
+        {
+            if(j != i && undo->moved[j] == 1 && dead[j] == 0 && x[j] == x[i] && y[j] == y[i])
+            {
+                collideHeads(board, i, j, dies, eats);
+            }
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(undo->moved[i] == 0)
+        {
+            continue;
+        }
+
+        if(dead[i] == 0)
+        {
+            board->growth[i] = board->growth[i] + eats[i] < MAX_GROWTH ? board->growth[i] + eats[i] : MAX_GROWTH;
+            board->size[i] += eats[i];
+
+            if(dies[i] == 0 && BIT_TEST(board->bits->suddenDeath, x[i], y[i]) != 0)
+            {
+                dies[i] = 1;
+            }
+        }
+
+        if(dead[i] == 1 || dies[i] == 1)
+        {
+            undo->died[i] = 1;
+            board->alive[i] = 0;
+            setSegments(board, i, 0);
+        }
+    }
+
+    // after the dead are gone, a head that ate a snake may be on its neck
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(undo->moved[i] == 0 || undo->died[i] == 1)
+        {
+            continue;
+        }
+
+        BIT_SET(board->bodies, x[i], y[i]);
+        board->hash ^= CELL_KEY(HASH_BODY, i, board->cells[i][board->head[i]]);
+
+        if(BIT_TEST(board->food, x[i], y[i]) != 0)
+        {
+            BIT_CLEAR(board->food, x[i], y[i]);
+            undo->eaten[i] = board->cells[i][board->head[i]];
+            board->hash ^= CELL_KEY(HASH_FOOD, 0, undo->eaten[i]);
+            board->growth[i] += board->growth[i] < MAX_GROWTH;
+            board->size[i]++;
+        }
+    }
+}
+
+//
+// The heads come off the board before the dead come back, and both before
+// any tail goes back: a head may be on the neck of a snake it ate or where
+// someone's tail was.
+//
+void searchUnmake(struct search_board* board)
+{
+    struct search_undo* undo = &board->undo[--board->depth];
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        unsigned short head = board->cells[i][board->head[i]];
+
+        if(undo->moved[i] == 0 || undo->died[i] == 1)
+        {
+            continue;
+        }
+
+        BIT_CLEAR(board->bodies, CELL_X(head), CELL_Y(head));
+        if(undo->eaten[i] != 0)
+        {
+            BIT_SET(board->food, CELL_X(head), CELL_Y(head));
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(undo->died[i] == 1)
+        {
+            setSegments(board, i, 1);
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(undo->moved[i] == 0)
+        {
+            continue;
+        }
+
+        board->head[i] = RING(board->head[i] + 1);
+        if(undo->grew[i] == 1)
+        {
+            board->length[i]--;
+        }
+        else
+        {
+            unsigned short tail = board->cells[i][RING(board->head[i] + board->length[i] - 1)];
+
+            BIT_SET(board->bodies, CELL_X(tail), CELL_Y(tail));
+        }
+
+        board->alive[i] = 1;
+        board->dir[i] = undo->dir[i];
+        board->growth[i] = undo->growth[i];
+        board->size[i] = undo->size[i];
+    }
+
+    board->hash = undo->hash;
+}
+
+//
+// The quick policy: food next to the head if there is some, otherwise
+// mostly straight on, turning when something is in the way
+//
+
+static int moveIsSafe(const struct search_board* board, int player, int move, int* food)
+{
+    unsigned short head = board->cells[player][board->head[player]];
+    int dir = SEARCH_TURNS[board->dir[player]][move];
+    int x = CELL_X(head) + STEP_X[dir];
+    int y = CELL_Y(head) + STEP_Y[dir];
+
+    if(blockedByWall(board, x, y, dir) == 1)
+    {
+        return 0;
+    }
+
+    *food = BIT_TEST(board->food, x, y) != 0;
+    return ((board->bodies[y] | board->bits->suddenDeath[y]) & BIT_AT(x)) == 0;
+}
+
+int searchQuickMove(const struct search_board* board, int player, unsigned int* random)
+{
+    int safe[SEARCH_MOVES] = {0};
+    int food[SEARCH_MOVES] = {0};
+    int start = 0;
+
+    for(int move = 0; move < SEARCH_MOVES; move++)
+    {
+        safe[move] = moveIsSafe(board, player, move, &food[move]);
+        if(safe[move] == 1 && food[move] == 1)
+        {
+            return move;
+        }
+    }
+
+    if(safe[SEARCH_STRAIGHT] == 1 && (nextRandom(random) & 7) != 0)
+    {
+        return SEARCH_STRAIGHT;
+    }
+
+    start = nextRandom(random) % SEARCH_MOVES;
+    for(int k = 0; k < SEARCH_MOVES; k++)
+    {
+        if(safe[(start + k) % SEARCH_MOVES] == 1)
+        {
+            return (start + k) % SEARCH_MOVES;
+        }
+    }
+
+    return SEARCH_STRAIGHT;
+}
+
+unsigned char searchQuickControl(const struct search_board* board, int player, unsigned int* random)
+{
+    if(board->alive[player] == 0)
+    {
+        return CONTROL_JOIN;
+    }
+
+    return CONTROL_TURN | SEARCH_TURNS[board->dir[player]][searchQuickMove(board, player, random)];
+}
+
+void searchQuickControls(struct search_board* board, const struct world* world, unsigned char* controls,
+                         unsigned int* random)
+{
+    searchLoad(board, world);
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        controls[i] = searchQuickControl(board, i, random);
+    }
+}
+
+//
+// The tree
+//
+
+void searchInit(struct search* search, struct search_node* nodes, int maxNodes, unsigned int seed)
+{
+    search->nodes = nodes;
+    search->maxNodes = maxNodes < SEARCH_NO_NODE ? maxNodes : SEARCH_NO_NODE;
+    search->table = NULL;
+    search->tableMask = 0;
+    search->random = seed != 0 ? seed : 1;
+    search->rollouts = 0;
+    search->tableHits = 0;
+}
+
+void searchTable(struct search* search, struct search_entry* table, int entries)
+{
+    search->table = entries > 0 ? table : NULL;
+    search->tableMask = entries > 0 ? (unsigned int)entries - 1 : 0;
+}
+
+// the entry for the board ticks from the root, emptied if another board had it
+static struct search_entry* tableEntry(struct search* search, int ticks)
+{
+    unsigned long long key = search->board.hash ^ worldHashKey(HASH_SCORE, -1, ticks);
+    struct search_entry* entry = &search->table[(unsigned int)key & search->tableMask];
+
+    if(entry->hash != key)
+    {
+        entry->hash = key;
+        entry->visits = 0;
+        entry->value = 0;
+    }
+
+    return entry;
+}
+
+static unsigned int squareRoot(unsigned int value)
+{
+    unsigned int root = 0;
+    unsigned int bit = 1u << 30;
+
+    while(bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while(bit != 0)
+    {
+        if(value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+// UCB1 in integers: the mean value plus sqrt(2 ln parent / visits), both
+// out of SEARCH_VALUE_SCALE, with ln taken as 0.69 times the bit length
+static int bestChild(const struct search* search, const struct search_node* node)
+{
+    unsigned int logParent = 32 - __builtin_clz(node->visits | 1);
+    unsigned int best = 0;
+    int bestMove = SEARCH_STRAIGHT;
+
+    for(int move = 0; move < SEARCH_MOVES; move++)
+    {
+        const struct search_node* child = &search->nodes[node->child[move]];
+        unsigned int score = child->value / child->visits;
+
+        score += squareRoot(logParent * 1453000u / child->visits) >> SEARCH_EXPLORE_SHIFT;
+        if(score > best)
+        {
+            best = score;
+            bestMove = move;
+        }
+    }
+
+    return bestMove;
+}
+
+static unsigned short newNode(struct search* search, int* used)
+{
+    struct search_node* node = NULL;
+
+    if(*used >= search->maxNodes)
+    {
+        return SEARCH_NO_NODE;
+    }
+
+    node = &search->nodes[*used];
+    node->visits = 0;
+    node->value = 0;
+    node->child[0] = SEARCH_NO_NODE;
+    node->child[1] = SEARCH_NO_NODE;
+    node->child[2] = SEARCH_NO_NODE;
+
+    return (unsigned short)(*used)++;
+}
+
+// living to the end of the look ahead is worth most, growing on the way a
+// bit more. Dying is worth less the sooner it happens.
+static unsigned int rolloutValue(const struct search_board* board, int player, int startSize, int ticks, int depth)
+{
+    int grown = board->size[player] - startSize;
+
+    if(board->alive[player] == 0)
+    {
+        return (unsigned int)((ticks - 1) * (SEARCH_VALUE_SCALE / 2) / depth);
+    }
+
+    if(grown > 2)
+    {
+        grown = 2;
+    }
+
+    return SEARCH_VALUE_SCALE * 3 / 4 + grown * (SEARCH_VALUE_SCALE / 8);
+}
+
+unsigned char searchControl(struct search* search, int player, const struct search_limits* limits)
+{
+    struct search_board* board = &search->board;
+    unsigned short path[SEARCH_MAX_DEPTH + 1];
+    unsigned char moves[MAX_PLAYERS];
+    int depth = limits->depth < SEARCH_MAX_DEPTH ? limits->depth : SEARCH_MAX_DEPTH;
+    int startSize = board->size[player];
+    int used = 0;
+    int best = SEARCH_STRAIGHT;
+    unsigned int bestVisits = 0;
+    unsigned short root = 0;
+
+    if(board->alive[player] == 0)
+    {
+        return CONTROL_JOIN;
+    }
+
+    // the values depend on who is searching and from where
+    if(search->table != NULL)
+    {
+        memset(search->table, 0, (search->tableMask + 1) * sizeof(struct search_entry));
+    }
+
+    root = newNode(search, &used);
+
+    for(int iteration = 0; iteration < limits->iterations && root != SEARCH_NO_NODE; iteration++)
+    {
+        struct search_entry* entries[SEARCH_MAX_DEPTH];
+        unsigned long long keys[SEARCH_MAX_DEPTH];
+        unsigned short node = root;
+        int pathLength = 0;
+        int recorded = 0;
+        int ticks = 0;
+        int cached = 0;
+        unsigned int value = 0;
+
+        if(limits->outOfTime != NULL && iteration % SEARCH_TIME_CHECK == 0 && iteration > 0 &&
+           limits->outOfTime(limits->context) == 1)
+        {
+            break;
+        }
+
+        path[pathLength++] = root;
+        while(ticks < depth && board->alive[player] == 1)
+        {
+            int move = 0;
+
+            for(int j = 0; j < MAX_PLAYERS; j++)
+            {
+                if(board->alive[j] == 1 && j != player)
+                {
+                    moves[j] = searchQuickMove(board, j, &search->random);
+                }
+            }
+
+            // in the tree: try every move once, then the best by UCB1.
+            // Below it, the quick policy.
+            if(node != SEARCH_NO_NODE)
+            {
+                struct search_node* current = &search->nodes[node];
+
+                for(move = 0; move < SEARCH_MOVES && current->child[move] != SEARCH_NO_NODE; move++)
+                {
+                }
+
+                if(move < SEARCH_MOVES)
+                {
+                    current->child[move] = newNode(search, &used);
+                    node = current->child[move];
+                    if(node != SEARCH_NO_NODE)
+                    {
+                        path[pathLength++] = node;
+                    }
+
+                    // one new node per iteration, the rest is the rollout
+                    node = SEARCH_NO_NODE;
+                }
+                else
+                {
+                    move = bestChild(search, current);
+                    node = current->child[move];
+                    path[pathLength++] = node;
+                }
+            }
+            else
+            {
+                move = searchQuickMove(board, player, &search->random);
+            }
+
+            moves[player] = move;
+            searchMake(board, moves);
+            ticks++;
+
+            // the same board the same number of ticks in has the same
+            // future, it may have been played out often enough already
+            if(search->table != NULL && board->alive[player] == 1)
+            {
+                struct search_entry* entry = tableEntry(search, ticks);
+
+                if(entry->visits >= SEARCH_TABLE_TRUST)
+                {
+                    value = entry->value / entry->visits;
+                    cached = 1;
+                    search->tableHits++;
+                    break;
+                }
+
+                entries[recorded] = entry;
+                keys[recorded++] = entry->hash;
+            }
+        }
+
+        if(cached == 0)
+        {
+            value = rolloutValue(board, player, startSize, ticks, depth);
+        }
+
+        // every board on the way had this outcome, unless a later one
+        // took its entry
+        for(int k = 0; k < recorded; k++)
+        {
+            if(entries[k]->hash == keys[k])
+            {
+                entries[k]->visits++;
+                entries[k]->value += value;
+            }
+        }
+        for(int k = 0; k < pathLength; k++)
+        {
+            search->nodes[path[k]].visits++;
+            search->nodes[path[k]].value += value;
+        }
+
+        while(ticks-- > 0)
+        {
+            searchUnmake(board);
+        }
+
+        search->rollouts++;
+    }
+
+    for(int move = 0; move < SEARCH_MOVES && root != SEARCH_NO_NODE; move++)
+    {
+        unsigned short child = search->nodes[root].child[move];
+
+        if(child != SEARCH_NO_NODE && search->nodes[child].visits > bestVisits)
+        {
+            bestVisits = search->nodes[child].visits;
+            best = move;
+        }
+    }
+
+    if(bestVisits == 0)
+    {
+        best = searchQuickMove(board, player, &search->random);
+    }
+
+    return CONTROL_JOIN | CONTROL_TURN | SEARCH_TURNS[board->dir[player]][best];
+}
@@ -0,0 +1,139 @@
+/*
+Twelve Snakes - a CPU snake that looks a few ticks ahead
+
+Picks a move for one snake with Monte Carlo tree search. The tree is over
+the snake's own moves, turn left, keep going or turn right. Every other
+snake moves at the same time, picked fresh each iteration by a quick policy
+that avoids whatever is right in front of it, so the tree learns which
+moves hold up against what the others might do rather than against one
+guess. Below the tree the snake plays the quick policy too, down to the
+depth limit.
+
+Ticks are played on a compact copy of the board, loaded from the world once
+per decision: one bit per cell for bodies and food, each snake's segments
+in a ring of cells, and the world's walls, pits and sudden death masks.
+searchMake() plays one tick with the rules of drawSnake(), worldDetect()
+and drawFood() and searchUnmake() takes it back, so an iteration never
+copies the board. Food that gets eaten isn't replaced, where it lands next
+is up to rand().
+
+The board carries the world's hash along, updated with the same keys for
+every cell, food and direction a tick changes, so two boards with the same
+snakes on them hash the same. An optional transposition table keyed by it
+and the ticks from the root remembers what iterations through each board
+came to. Once a board has been through a few, an iteration that gets to it
+again takes their average and stops there. The other snakes mostly go
+straight, so the same boards come up often.
+*/
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "world.h"
+
+#define SEARCH_MAX_DEPTH 16
+#define SEARCH_RING 2048 // segments a snake can have, more than the board has cells
+#define SEARCH_NO_NODE 0xFFFF
+
+#if BOARD_WIDTH * BOARD_HEIGHT > SEARCH_RING
+#error "a snake as long as the board has cells has to fit in the ring"
+#endif
+
+// moves relative to the way the snake is going
+#define SEARCH_LEFT     0
+#define SEARCH_STRAIGHT 1
+#define SEARCH_RIGHT    2
+#define SEARCH_MOVES    3
+
+// what one searchMake() changed, for searchUnmake()
+struct search_undo
+{
+    unsigned char moved[MAX_PLAYERS]; // was alive and took a step
+    unsigned char died[MAX_PLAYERS];
+    unsigned char grew[MAX_PLAYERS]; // kept its tail
+    unsigned char dir[MAX_PLAYERS];
+    short growth[MAX_PLAYERS];
+    short size[MAX_PLAYERS];
+    unsigned short eaten[MAX_PLAYERS]; // food cell under the head, 0 if none
+    unsigned long long hash; // the board's before the tick
+};
+
+struct search_board
+{
+    const struct bitboard* bits; // walls, pits and sudden death, as the world has them
+    bitrow bodies[BOARD_HEIGHT]; // every segment on the board
+    bitrow food[BOARD_HEIGHT];
+
+    unsigned short cells[MAX_PLAYERS][SEARCH_RING]; // y * 64 + x, head first from head[]
+    unsigned short head[MAX_PLAYERS]; // ring index of the head
+    unsigned short length[MAX_PLAYERS]; // segments in the ring
+    short growth[MAX_PLAYERS]; // segments still to grow, pendingGrowth
+    short size[MAX_PLAYERS]; // currLength, what eating another snake compares
+    unsigned char dir[MAX_PLAYERS];
+    unsigned char alive[MAX_PLAYERS];
+
+    unsigned long long hash; // world->hash as the ticks made since changed it
+    int depth; // ticks made and not yet unmade
+    struct search_undo undo[SEARCH_MAX_DEPTH];
+};
+
+struct search_node
+{
+    unsigned int visits;
+    unsigned int value; // summed values, SEARCH_VALUE_SCALE is a perfect one
+    unsigned short child[SEARCH_MOVES];
+};
+
+#define SEARCH_VALUE_SCALE 1024
+#define SEARCH_TABLE_TRUST 4 // play-outs of a board before the table's average is used instead
+
+struct search_entry
+{
+    unsigned long long hash; // of the board and the ticks it is from the root
+    unsigned int visits;
+    unsigned int value;
+};
+
+struct search_limits
+{
+    int iterations; // iterations to run, also capped by the node pool
+    int depth; // ticks each iteration looks ahead, up to SEARCH_MAX_DEPTH
+    int (*outOfTime)(void* context); // checked every few iterations, may be NULL
+    void* context;
+};
+
+struct search
+{
+    struct search_board board;
+    struct search_node* nodes;
+    int maxNodes; // at most SEARCH_NO_NODE
+    struct search_entry* table; // NULL for none
+    unsigned int tableMask; // entries - 1
+    unsigned int random; // xorshift state
+    unsigned int rollouts; // iterations run since the search was set up
+    unsigned int tableHits; // of them, the ones the table answered
+};
+
+void searchInit(struct search* search, struct search_node* nodes, int maxNodes, unsigned int seed);
+void searchTable(struct search* search, struct search_entry* table, int entries); // a power of two, cleared every decision
+void searchLoad(struct search_board* board, const struct world* world); // copy of the board as it is now
+
+void searchMake(struct search_board* board, const unsigned char* moves); // a SEARCH_* move for every snake
+void searchUnmake(struct search_board* board);
+
+// the absolute DIR_* of a SEARCH_* move, by the DIR_* the snake is heading
+extern const unsigned char SEARCH_TURNS[4][SEARCH_MOVES];
+
+// the quick policy the other snakes play, also a cheap bot on its own
+int searchQuickMove(const struct search_board* board, int player, unsigned int* random);
+unsigned char searchQuickControl(const struct search_board* board, int player, unsigned int* random); // as a CONTROL_* byte, joins when dead
+
+// loads board from world and fills in every player's quick control, the bots
+// the host tools record and watch
+void searchQuickControls(struct search_board* board, const struct world* world, unsigned char* controls,
+                         unsigned int* random);
+
+// the CONTROL_* byte for player after searching from the board searchLoad() left
+unsigned char searchControl(struct search* search, int player, const struct search_limits* limits);
+
+#endif
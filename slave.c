@@ -0,0 +1,124 @@
+/*
+Twelve Snakes - work on the slave SH-2
+*/
+
+#include <jo/jo.h>
+#include "slave.h"
+#include "world.h"
+
+// the same memory seen without the cache, and the address whose write
+// purges the cache line holding it
+#define CACHE_THROUGH(address) ((unsigned long)(address) | 0x20000000)
+#define CACHE_PURGE(address) ((unsigned long)(address) | 0x40000000)
+#define CACHE_LINE 16
+
+struct slave_call
+{
+    slaveJob job;
+    void* arg;
+    int done;
+    int stop; // the master wants the result
+};
+
+static struct slave_call g_SlaveCall = {0};
+
+// the call as both CPUs have to see it
+#define SLAVE_CALL ((volatile struct slave_call*)CACHE_THROUGH(&g_SlaveCall))
+
+struct slave_detect
+{
+    struct world* world;
+    struct collisions* out;
+};
+
+static struct slave_detect g_SlaveDetect = {0};
+
+void slaveCachePurge(const void* start, unsigned int size)
+{
+    unsigned long line = (unsigned long)start & ~(CACHE_LINE - 1);
+    unsigned long end = (unsigned long)start + size;
+
+    for(; line < end; line += CACHE_LINE)
+    {
+        *(volatile unsigned long*)CACHE_PURGE(line) = 0;
+    }
+}
+
+// runs on the slave
+static void slaveMain(void* unused)
+{
+    volatile struct slave_call* call = SLAVE_CALL;
+
+    (void)unused;
+
+    // whatever this CPU cached during the last job may have changed since
+    slCashPurge();
+
+    call->job(call->arg);
+    call->done = 1;
+}
+
+void slaveStart(slaveJob job, void* arg)
+{
+    volatile struct slave_call* call = SLAVE_CALL;
+
+    call->job = job;
+    call->arg = arg;
+    call->done = 0;
+    call->stop = 0;
+
+    slSlaveFunc(slaveMain, NULL);
+}
+
+void slaveWait()
+{
+    volatile struct slave_call* call = SLAVE_CALL;
+
+    while(call->done == 0)
+    {
+    }
+}
+
+void slaveStop()
+{
+    volatile struct slave_call* call = SLAVE_CALL;
+
+    call->stop = 1;
+}
+
+int slaveStopping()
+{
+    volatile struct slave_call* call = SLAVE_CALL;
+
+    return call->stop;
+}
+
+//
+// Collisions
+//
+
+static void detectJob(void* arg)
+{
+    struct slave_detect* detect = (struct slave_detect*)arg;
+
+    worldDetect(detect->world, detect->out);
+}
+
+void slaveStartDetect(struct world* world, struct collisions* out)
+{
+    // the slave reads this after purging its cache
+    g_SlaveDetect.world = world;
+    g_SlaveDetect.out = out;
+
+    slaveStart(detectJob, &g_SlaveDetect);
+}
+
+void slaveWaitDetect(struct world* world, struct collisions* out)
+{
+    (void)world;
+
+    slaveWait();
+
+    // the master still has last tick's copy in its cache
+    slaveCachePurge(out, sizeof(*out));
+}
@@ -0,0 +1,38 @@
+/*
+Twelve Snakes - work on the slave SH-2
+
+The Saturn has two SH-2s and SGL leaves the slave idle unless it is given
+something to do. The master hands it a job with slaveStart() and picks up the
+result with slaveWait(). Until then the master leaves alone everything the
+job reads or writes.
+
+The two CPUs don't see each other's caches. Both caches write through, so
+what one CPU writes is in memory straight away, but the other may still have
+the old contents cached. The slave purges its whole cache before each job
+and the master purges the lines of whatever it reads back. The handoff flag
+is read and written through the cache-through mirror of work RAM.
+
+With SLAVE_CPU set to 0 in the makefile the game runs everything on the
+master, to compare the two in an emulator. The benchmark screen times both
+and checks that they agree.
+*/
+
+#ifndef SLAVE_H
+#define SLAVE_H
+
+struct world;
+struct collisions;
+
+typedef void (*slaveJob)(void* arg);
+
+void slaveStart(slaveJob job, void* arg); // runs job(arg) on the slave, one job at a time
+void slaveWait(); // until the last job has finished
+void slaveStop(); // asks the running job to finish early, before slaveWait()
+int slaveStopping(); // for jobs on the slave, 1 once the master has asked
+void slaveCachePurge(const void* start, unsigned int size); // drops this CPU's cached copy of the memory
+
+// the world's startDetect and waitDetect, worldDetect() on the slave
+void slaveStartDetect(struct world* world, struct collisions* out);
+void slaveWaitDetect(struct world* world, struct collisions* out);
+
+#endif
@@ -0,0 +1,235 @@
+/*
+Twelve Snakes - lifetime stats and best scores kept in backup RAM
+*/
+
+#include <stddef.h>
+#include <jo/jo.h>
+#include "events.h"
+#include "stats.h"
+
+static struct stats_record g_Stats = {0};
+static struct event_reader g_StatsReader = {0};
+static unsigned int g_StatsMissed = 0; // of g_StatsReader.missed, already in the record
+static int g_StatsLoaded = 0;
+static int g_StatsDirty = 0;
+
+// a version 2 record is the same up to the missed events
+#define STATS_V2_SIZE (offsetof(struct stats_record, eventsMissed) + sizeof(unsigned int))
+
+// over the size - 4 bytes before the checksum at the end
+static unsigned int statsChecksum(const struct stats_record* record, unsigned int size)
+{
+    const unsigned int* words = (const unsigned int*)record;
+    unsigned int numWords = (size - sizeof(record->checksum)) / sizeof(unsigned int);
+    unsigned int sum = STATS_MAGIC;
+
+    for(unsigned int i = 0; i < numWords; i++)
+    {
+        sum = ((sum << 5) | (sum >> 27)) ^ words[i];
+    }
+
+    return sum;
+}
+
+static void statsReset()
+{
+    memset(&g_Stats, 0, sizeof(g_Stats));
+    g_Stats.magic = STATS_MAGIC;
+    g_Stats.version = STATS_VERSION;
+    g_Stats.size = sizeof(struct stats_record);
+}
+
+void statsLoad()
+{
+    unsigned int length = 0;
+    struct stats_record* saved = NULL;
+
+    if(g_StatsLoaded == 1)
+    {
+        return;
+    }
+    g_StatsLoaded = 1;
+
+    statsReset();
+
+    if(jo_backup_mount(JoInternalMemoryBackup) == false)
+    {
+        return;
+    }
+
+    // a single read of a fixed size file, anything else is discarded
+    saved = (struct stats_record*)jo_backup_load_file_contents(JoInternalMemoryBackup, STATS_FILENAME, &length);
+    if(saved == NULL)
+    {
+        return;
+    }
+
+    if(length == sizeof(struct stats_record) &&
+       saved->magic == STATS_MAGIC &&
+       saved->version == STATS_VERSION &&
+       saved->size == sizeof(struct stats_record) &&
+       saved->checksum == statsChecksum(saved, sizeof(struct stats_record)))
+    {
+        memcpy(&g_Stats, saved, sizeof(g_Stats));
+    }
+    else if(length == STATS_V2_SIZE &&
+            saved->magic == STATS_MAGIC &&
+            saved->version == 2 &&
+            saved->size == STATS_V2_SIZE &&
+            ((const unsigned int*)saved)[STATS_V2_SIZE / sizeof(unsigned int) - 1] == statsChecksum(saved, STATS_V2_SIZE))
+    {
+        // nothing was counted as missed then
+        memcpy(&g_Stats, saved, STATS_V2_SIZE - sizeof(unsigned int));
+        g_StatsDirty = 1;
+    }
+
+    jo_free(saved);
+}
+
+void statsSave()
+{
+    if(g_StatsDirty == 0)
+    {
+        return;
+    }
+
+    g_Stats.checksum = statsChecksum(&g_Stats, sizeof(struct stats_record));
+    if(jo_backup_save_file_contents(JoInternalMemoryBackup, STATS_FILENAME, STATS_COMMENT,
+                                    &g_Stats, sizeof(g_Stats)) == true)
+    {
+        g_StatsDirty = 0;
+    }
+}
+
+void statsBeginMatch()
+{
+    eventReaderInit(&g_StatsReader);
+    g_StatsMissed = 0;
+}
+
+int statsFold(int maxEvents)
+{
+    struct game_event event;
+
+    for(int i = 0; i < maxEvents; i++)
+    {
+        int read = eventRead(&g_StatsReader, &event);
+
+        // the ring lapped the reader, those events can't be counted any more
+        if(g_StatsReader.missed != g_StatsMissed)
+        {
+            g_Stats.eventsMissed += g_StatsReader.missed - g_StatsMissed;
+            g_StatsMissed = g_StatsReader.missed;
+            g_StatsDirty = 1;
+        }
+
+        if(read == 0)
+        {
+            return 0;
+        }
+
+        if(event.player >= MAX_PLAYERS)
+        {
+            continue;
+        }
+
+        switch(event.type)
+        {
+            case EVENT_APPLE:
+                g_Stats.slots[event.player].numApples++;
+                break;
+
+            case EVENT_KILL:
+                g_Stats.slots[event.player].numKills++;
+                break;
+
+            case EVENT_DEATH:
+                g_Stats.slots[event.player].numDeaths++;
+                break;
+
+            case EVENT_EATEN:
+                g_Stats.slots[event.player].numPlayersEaten++;
+                break;
+
+            default:
+                continue;
+        }
+
+        g_StatsDirty = 1;
+    }
+
+    return 1;
+}
+
+void statsUpdate()
+{
+    int more = 1;
+
+    while(more == 1)
+    {
+        more = statsFold(EVENT_RING_SIZE);
+    }
+}
+
+void statsRecordMatch(struct snake* players, struct options* gameOptions, int matchEnded)
+{
+    struct best_score* best = &g_Stats.best[gameOptions->gameType];
+    int winner = -1;
+
+    statsUpdate();
+
+    // scores are kept up to date as they change
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(players[i].everActive == 0)
+        {
+            continue;
+        }
+
+        if(players[i].maxLength > g_Stats.slots[i].maxLength)
+        {
+            g_Stats.slots[i].maxLength = (unsigned short)players[i].maxLength;
+            g_StatsDirty = 1;
+        }
+
+        if(winner == -1 || players[i].score > players[winner].score)
+        {
+            winner = i;
+        }
+
+        if(matchEnded == 1)
+        {
+            g_Stats.slots[i].gamesPlayed++;
+            g_StatsDirty = 1;
+        }
+    }
+
+    if(matchEnded == 1 && g_StatsMissed > 0)
+    {
+        g_Stats.incompleteMatches++;
+        g_StatsDirty = 1;
+    }
+
+    if(winner == -1)
+    {
+        return;
+    }
+
+    if(best->valid == 0 || players[winner].score > best->score)
+    {
+        best->score = (short)players[winner].score;
+        best->slot = (unsigned char)winner;
+        best->valid = 1;
+        g_StatsDirty = 1;
+    }
+
+    if(matchEnded == 1)
+    {
+        g_Stats.slots[winner].gamesWon++;
+    }
+}
+
+const struct stats_record* statsRecord()
+{
+    return &g_Stats;
+}
@@ -0,0 +1,65 @@
+/*
+Twelve Snakes - lifetime stats and best scores kept in backup RAM
+
+The record is one fixed size file. It is read once at boot and only written
+from the score screen or when a game ends, never from the game loop, so
+backup RAM access can't stall gameplay. Counters are folded into the copy in
+work RAM as they happen to be needed (clearing the score keeps what was played
+so far) and statsSave() writes it back when something changed.
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "game.h"
+
+#define STATS_MAGIC 0x54534E4B // "TSNK"
+#define STATS_VERSION 3 // 2: slots for 24 players, 3: missed events
+#define STATS_FILENAME "TWELVESNAKE"
+#define STATS_COMMENT "Stats"
+
+struct slot_stats
+{
+    unsigned int numApples;
+    unsigned int numKills;
+    unsigned int numDeaths;
+    unsigned int numPlayersEaten;
+    unsigned short maxLength;
+    unsigned short gamesPlayed;
+    unsigned short gamesWon;
+    unsigned short reserved;
+};
+
+struct best_score
+{
+    short score;
+    unsigned char slot; // player index that set it
+    unsigned char valid;
+};
+
+struct stats_record
+{
+    unsigned int magic;
+    unsigned short version;
+    unsigned short size;
+    struct slot_stats slots[MAX_PLAYERS];
+    struct best_score best[NUM_GAME_TYPES];
+
+    // events the ring dropped before they were folded in, the counters above
+    // are short by this many, and the matches that lost any
+    unsigned int eventsMissed;
+    unsigned short incompleteMatches;
+    unsigned short reserved;
+
+    unsigned int checksum;
+};
+
+void statsLoad(); // once at boot
+void statsSave(); // score screen or end of game only
+void statsBeginMatch();
+void statsUpdate(); // fold the match events since the last call into the record
+int statsFold(int maxEvents); // folds up to maxEvents of them, returns 1 if there may be more
+void statsRecordMatch(struct snake* players, struct options* gameOptions, int matchEnded);
+const struct stats_record* statsRecord();
+
+#endif
@@ -0,0 +1,192 @@
+/*
+Twelve Snakes - direct access to the SGL text plane
+*/
+
+#include <jo/jo.h>
+#include "textplane.h"
+
+// widest layout we stage in work RAM: 64 cells per row of 2-word pattern names
+#define TEXT_PLANE_MAX_ROW_BYTES (64 * 4)
+
+// queued cell writes per flush. A full redraw of twelve long snakes can exceed
+// this, the queue is then flushed early rather than dropping writes.
+#define TEXT_QUEUE_SIZE 1024
+
+struct text_plane
+{
+    Uint8* origin; // VRAM address of cell (0, 0)
+    unsigned int cellBytes; // 2 or 4
+    unsigned int rowBytes;
+    Uint32 glyphBase; // pattern name of glyph 0
+    Uint32 glyphStride; // pattern name step between consecutive glyphs
+    int usable; // calibration succeeded and the layout fits the staging buffer
+};
+
+struct text_cell_write
+{
+    Uint16 offset; // byte offset of the cell from the plane's origin
+    Uint16 glyph;
+};
+
+static struct text_plane g_TextPlane = {0};
+static Uint32 g_GlyphCells[256]; // pattern name for every glyph
+static Uint32 g_TextStaging[(TEXT_ROWS * TEXT_PLANE_MAX_ROW_BYTES) / sizeof(Uint32)];
+static struct text_cell_write g_TextQueue[TEXT_QUEUE_SIZE];
+static int g_TextQueueCount = 0;
+
+static Uint32 readCell(Uint8* cell)
+{
+    if(g_TextPlane.cellBytes == 4)
+    {
+        return *(volatile Uint32*)cell;
+    }
+
+    return *(volatile Uint16*)cell;
+}
+
+static Uint32 glyphCell(char glyph)
+{
+    return g_GlyphCells[(unsigned char)glyph];
+}
+
+void textPlaneInit()
+{
+    Uint32 cellA = 0;
+    Uint32 cellB = 0;
+
+    g_TextPlane.origin = (Uint8*)slLocate(0, 0);
+    g_TextPlane.cellBytes = (Uint8*)slLocate(1, 0) - g_TextPlane.origin;
+    g_TextPlane.rowBytes = (Uint8*)slLocate(0, 1) - g_TextPlane.origin;
+    g_TextPlane.usable = 0;
+    g_TextQueueCount = 0;
+
+    if(g_TextPlane.cellBytes != 2 && g_TextPlane.cellBytes != 4)
+    {
+        return;
+    }
+
+    // learn the glyph numbering from two neighbouring characters
+    slPrint("A", g_TextPlane.origin);
+    cellA = readCell(g_TextPlane.origin);
+    slPrint("B", g_TextPlane.origin);
+    cellB = readCell(g_TextPlane.origin);
+    slPrint(" ", g_TextPlane.origin);
+
+    g_TextPlane.glyphStride = cellB - cellA;
+    g_TextPlane.glyphBase = cellA - ('A' * g_TextPlane.glyphStride);
+
+    for(unsigned int i = 0; i < 256; i++)
+    {
+        g_GlyphCells[i] = g_TextPlane.glyphBase + (i * g_TextPlane.glyphStride);
+    }
+
+    if(g_TextPlane.glyphStride != 0 &&
+       g_TextPlane.rowBytes >= TEXT_COLUMNS * g_TextPlane.cellBytes &&
+       g_TextPlane.rowBytes <= TEXT_PLANE_MAX_ROW_BYTES)
+    {
+        g_TextPlane.usable = 1;
+    }
+}
+
+void textPlaneBlit(const char* glyphs)
+{
+    Uint32 blank = glyphCell(' ');
+    unsigned int rowCells = g_TextPlane.rowBytes / g_TextPlane.cellBytes;
+
+    // queued writes are older than the new screen
+    textPlaneFlush();
+
+    if(g_TextPlane.usable == 0)
+    {
+        // unknown layout, fall back to printing a row at a time
+        char row[TEXT_COLUMNS + 1];
+
+        for(int y = 0; y < TEXT_ROWS; y++)
+        {
+            for(int x = 0; x < TEXT_COLUMNS; x++)
+            {
+                row[x] = glyphs[(y * TEXT_COLUMNS) + x];
+            }
+            row[TEXT_COLUMNS] = '\0';
+            slPrint(row, slLocate(0, y));
+        }
+        return;
+    }
+
+    // build the pattern name table, the off screen columns are blanked
+    for(int y = 0; y < TEXT_ROWS; y++)
+    {
+        const char* src = &glyphs[y * TEXT_COLUMNS];
+
+        if(g_TextPlane.cellBytes == 4)
+        {
+            Uint32* dst = &g_TextStaging[y * rowCells];
+
+            for(unsigned int x = 0; x < rowCells; x++)
+            {
+                dst[x] = (x < TEXT_COLUMNS) ? glyphCell(src[x]) : blank;
+            }
+        }
+        else
+        {
+            Uint16* dst = &((Uint16*)g_TextStaging)[y * rowCells];
+
+            for(unsigned int x = 0; x < rowCells; x++)
+            {
+                dst[x] = (Uint16)((x < TEXT_COLUMNS) ? glyphCell(src[x]) : blank);
+            }
+        }
+    }
+
+    // the SH-2 cache is write-through so the staging buffer is already in
+    // work RAM. Wait for the copy so later slPrint()s can't be overwritten.
+    slDMACopy(g_TextStaging, g_TextPlane.origin, TEXT_ROWS * g_TextPlane.rowBytes);
+    slDMAWait();
+}
+
+void textPlanePut(int x, int y, char glyph)
+{
+    struct text_cell_write* write = NULL;
+
+    if(g_TextPlane.usable == 0)
+    {
+        char temp[2] = {glyph, '\0'};
+
+        slPrint(temp, slLocate(x, y));
+        return;
+    }
+
+    if(g_TextQueueCount == TEXT_QUEUE_SIZE)
+    {
+        textPlaneFlush();
+    }
+
+    write = &g_TextQueue[g_TextQueueCount++];
+    write->offset = (Uint16)((y * g_TextPlane.rowBytes) + (x * g_TextPlane.cellBytes));
+    write->glyph = (unsigned char)glyph;
+}
+
+void textPlaneFlush()
+{
+    Uint8* origin = g_TextPlane.origin;
+    int count = g_TextQueueCount;
+
+    // writes are applied in the order they were queued so a tail erased and
+    // a head drawn on the same cell in one frame still ends up as the head
+    if(g_TextPlane.cellBytes == 4)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            *(volatile Uint32*)(origin + g_TextQueue[i].offset) = g_GlyphCells[g_TextQueue[i].glyph];
+        }
+    }
+    else
+    {
+        for(int i = 0; i < count; i++)
+        {
+            *(volatile Uint16*)(origin + g_TextQueue[i].offset) = (Uint16)g_GlyphCells[g_TextQueue[i].glyph];
+        }
+    }
+
+    g_TextQueueCount = 0;
+}
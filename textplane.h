@@ -0,0 +1,29 @@
+/*
+Twelve Snakes - direct access to the SGL text plane
+
+slPrint() computes a VRAM address and walks a string for every call. For whole
+screens we build the pattern name table in work RAM instead and copy it to VRAM
+with one DMA transfer. Per frame cell updates are gathered into a list and
+written back together.
+
+SGL owns the text plane's layout, so rather than hard coding it
+textPlaneInit() prints a couple of glyphs through slPrint() and reads the cells
+back to learn the cell size, row pitch and glyph numbering.
+*/
+
+#ifndef TEXTPLANE_H
+#define TEXTPLANE_H
+
+#define TEXT_COLUMNS 40
+#define TEXT_ROWS 30
+
+void textPlaneInit(); // call after slInitSystem()
+void textPlaneBlit(const char* glyphs); // TEXT_ROWS rows of TEXT_COLUMNS glyphs
+
+// Gameplay rendering queues single cell writes and textPlaneFlush() applies
+// them all in one tight loop. Call it right after slSynch() so the writes land
+// in the vertical blank, and before any slPrint() that must not be overwritten.
+void textPlanePut(int x, int y, char glyph);
+void textPlaneFlush();
+
+#endif
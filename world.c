@@ -0,0 +1,1361 @@
+/*
+Twelve Snakes - the rules of a match
+*/
+
+#include "events.h"
+#include "world.h"
+
+#if PITS_PER_SIDE < 1
+#error PITS_PER_SIDE must be at least 1
+#endif
+
+// joengine has MIN() and MAX(), the host doesn't
+#define MIN_OF(a, b) ((a) < (b) ? (a) : (b))
+#define MAX_OF(a, b) ((a) > (b) ? (a) : (b))
+
+// the original twelve, the linked console's twelve, then what's left in the
+// font that doesn't look like food, sudden death or the walls
+static const char SNAKE_GLYPHS[] =
+{
+    (char)14,  // block
+    (char)35,  // pound sign
+    (char)23,  // gaurav's gamma
+    (char)127, // checkerboard
+    (char)92,  // looks like a V
+    (char)38,  // percent sign
+    (char)64,  // copyright symbol
+    (char)56,  // number eight
+    (char)37,  // percent sign
+    (char)48,  // zero
+    (char)81,  // letter Q
+    (char)149, // evil snake!
+    '$', '+', '=', '?', 'H', 'M', 'O', 'W', 'Z', 'K', 'N', 'U',
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'I', 'J', 'L', 'P', 'R', 'S', 'T', 'V', 'Y',
+    'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'k', 'm', 'n', 'o', 'p', 'q', 'r', 's',
+    'u', 'v', 'w', 'x', 'y', 'z', '1', '2', '3', '4', '5', '6', '7', '9', '@', '&',
+};
+#define NUM_SNAKE_GLYPHS ((int)sizeof(SNAKE_GLYPHS))
+
+const int SCORE_SOURCES[NUM_GAME_TYPES] =
+{
+    SCORE_APPLES | SCORE_KILLS | SCORE_DEATHS, // Free For All
+    SCORE_APPLES | SCORE_KILLS | SCORE_DEATHS, // Score Attack
+    SCORE_DEATHS,                              // Battle Royale
+    SCORE_LENGTH,                              // Survivor
+    SCORE_MAX_LENGTH,                          // King of the Hill
+};
+
+const struct pit_cell PIT_SHAPES[4][PIT_CELLS] =
+{
+    // DIR_UP, in the bottom wall
+    {{-1, 0, 24}, {-1, 1, 25}, {0, 1, 21}, {0, 0, ' '}, {1, 1, 26}, {1, 0, 23}},
+    // DIR_DOWN, in the top wall
+    {{-1, 0, 26}, {-1, -1, 23}, {0, -1, 21}, {0, 0, ' '}, {1, -1, 24}, {1, 0, 25}},
+    // DIR_RIGHT, in the left wall
+    {{0, -1, 26}, {-1, -1, 23}, {-1, 0, 22}, {0, 0, ' '}, {-1, 1, 25}, {0, 1, 24}},
+    // DIR_LEFT, in the right wall
+    {{0, -1, 25}, {1, -1, 24}, {1, 0, 22}, {0, 0, ' '}, {1, 1, 26}, {0, 1, 23}},
+};
+
+static struct spawn_point g_SpawnTable[MAX_PLAYERS];
+static char g_GlyphTable[MAX_PLAYERS];
+
+const struct spawn_point* const g_Spawns = g_SpawnTable;
+const char* const g_SnakeGlyphs = g_GlyphTable;
+
+//
+// Spawn and glyph tables
+//
+
+// Slot k of count centered on first..last, pitch cells apart or closer if
+// they don't fit
+static int slotPosition(int first, int last, int count, int k, int pitch)
+{
+    int length = last - first + 1;
+    int center = first + (length - 1) / 2;
+
+    if(count > 1 && pitch * (count - 1) > length - 1)
+    {
+        pitch = (length - 1) / (count - 1);
+    }
+
+    return center + ((2 * k - (count - 1)) * pitch) / 2;
+}
+
+// the slot opposite position, slot count - 1 - k for slot k
+static int slotMirror(int first, int last, int position)
+{
+    return 2 * (first + (last - first) / 2) - position;
+}
+
+// adds a spawn point and the one turned half way round the arena from it,
+// on the opposite wall at the opposite end
+static int addSpawnPair(int player, int x, int y, int dir, int pit)
+{
+    struct spawn_point* spawn = NULL;
+
+    for(int i = 0; i < 2 && player < MAX_PLAYERS; i++)
+    {
+        spawn = &g_SpawnTable[player++];
+        spawn->x = (unsigned char)x;
+        spawn->y = (unsigned char)y;
+        spawn->dir = (unsigned char)dir;
+        spawn->pit = (unsigned char)pit;
+
+        if(dir == DIR_RIGHT || dir == DIR_LEFT)
+        {
+            x = MIN_X + MAX_X - x;
+            y = slotMirror(MIN_Y, MAX_Y, y);
+        }
+        else
+        {
+            x = slotMirror(MIN_X, MAX_X, x);
+            y = MIN_Y + MAX_Y - y;
+        }
+        dir ^= 1; // DIR_UP <-> DIR_DOWN, DIR_RIGHT <-> DIR_LEFT
+    }
+
+    return player;
+}
+
+//
+// Players take the spawn points ring by ring. Ring 0 is the pits in the
+// walls, ring d is d cells inside them. Odd rings have one slot less per wall
+// and sit between the slots of the even ones, so a snake doesn't start in the
+// lane of the one behind it. In each ring the left and right walls fill
+// first, ends before the middle, then the bottom and top from the right end,
+// which with twelve players is the Saturn's original layout. With more players
+// than rings they start over at ring 1 and the runway check sorts out who
+// goes first.
+//
+void worldInit()
+{
+    int maxDepth = MIN_OF(ARENA_WIDTH, ARENA_HEIGHT) / 2;
+    int player = 0;
+    int ring = 0;
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        g_GlyphTable[i] = SNAKE_GLYPHS[i % NUM_SNAKE_GLYPHS];
+    }
+
+    while(player < MAX_PLAYERS)
+    {
+        int depth = ring;
+        int count = 0;
+
+        if(ring > maxDepth)
+        {
+            depth = 1 + ((ring - 1) % maxDepth);
+        }
+
+        count = PITS_PER_SIDE - (depth & 1);
+
+        for(int j = 0; j < count && player < MAX_PLAYERS; j++)
+        {
+            // ends first, then working in to the middle
+            int k = (j & 1) ? count - 1 - (j / 2) : j / 2;
+            int y = slotPosition(MIN_Y, MAX_Y, count, k, SPAWN_PITCH_Y);
+
+            player = addSpawnPair(player, MIN_X - 1 + depth, y, DIR_RIGHT, depth == 0);
+        }
+
+        for(int j = 0; j < count && player < MAX_PLAYERS; j++)
+        {
+            int k = (j & 1) ? j / 2 : count - 1 - (j / 2);
+            int x = slotPosition(MIN_X, MAX_X, count, k, SPAWN_PITCH_X);
+
+            player = addSpawnPair(player, x, MAX_Y + 1 - depth, DIR_UP, depth == 0);
+        }
+
+        ring++;
+    }
+}
+
+//
+// Drawing and the board
+//
+
+static void put(struct world* world, int x, int y, char glyph)
+{
+    if(world->put != NULL)
+    {
+        world->put(x, y, glyph);
+    }
+}
+
+// where the rules emit
+static struct event_ring* eventSink(struct world* world)
+{
+    return world->events != NULL ? world->events : &g_Events;
+}
+
+static void emit(struct world* world, int type, int player, int other, int x, int y)
+{
+    eventRingEmit(eventSink(world), type, player, other, x, y);
+}
+
+static int onBoard(int x, int y)
+{
+    return x >= 0 && x < BOARD_WIDTH && y >= 0 && y < BOARD_HEIGHT;
+}
+
+#define CELL_KEY(kind, player, x, y) worldHashKey(kind, player, (y) * BOARD_WIDTH + (x))
+
+// a head that ate the snake whose neck it ran into takes the cell over
+static void boardClaim(struct world* world, int x, int y, int owner)
+{
+    if(world->board[y][x] != BOARD_EMPTY)
+    {
+        world->hash ^= CELL_KEY(HASH_BODY, world->board[y][x] - 1, x, y);
+    }
+
+    world->board[y][x] = owner + 1;
+    BIT_SET(world->bits.bodies, x, y);
+    world->hash ^= CELL_KEY(HASH_BODY, owner, x, y);
+}
+
+// frees a cell on the board if the player still owns it. A head that died
+// in someone else's body never owned its cell.
+static void boardRelease(struct world* world, int x, int y, int owner)
+{
+    if(onBoard(x, y) == 0)
+    {
+        return;
+    }
+
+    if(world->board[y][x] == owner + 1)
+    {
+        world->board[y][x] = BOARD_EMPTY;
+        BIT_CLEAR(world->bits.bodies, x, y);
+        world->hash ^= CELL_KEY(HASH_BODY, owner, x, y);
+    }
+}
+
+static void eraseSnake(struct world* world, struct location* snakeHead, int owner)
+{
+    struct location* next = NULL;
+
+    while(snakeHead != NULL)
+    {
+        next = snakeHead->next;
+
+        put(world, snakeHead->x, snakeHead->y, ' ');
+        boardRelease(world, snakeHead->x, snakeHead->y, owner);
+        free(snakeHead);
+
+        snakeHead = next;
+    }
+}
+
+static void setDir(struct world* world, int player, int dir)
+{
+    world->hash ^= worldHashKey(HASH_DIR, player, world->snakes->dir[player]) ^ worldHashKey(HASH_DIR, player, dir);
+    world->snakes->dir[player] = (unsigned char)dir;
+}
+
+//
+// The state hash
+//
+
+// splitmix64's finaliser over kind, player and value, any two inputs give
+// unrelated keys
+unsigned long long worldHashKey(int kind, int player, int value)
+{
+    unsigned long long key = ((unsigned long long)kind << 56) ^ ((unsigned long long)(player & 0xFFFF) << 32) ^
+                             (unsigned int)value;
+
+    key += 0x9E3779B97F4A7C15ull;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+
+    return key ^ (key >> 31);
+}
+
+unsigned long long worldRehash(const struct world* world)
+{
+    unsigned long long hash = 0;
+
+    for(int y = 0; y < BOARD_HEIGHT; y++)
+    {
+        for(int x = 0; x < BOARD_WIDTH; x++)
+        {
+            if(world->board[y][x] != BOARD_EMPTY)
+            {
+                hash ^= CELL_KEY(HASH_BODY, world->board[y][x] - 1, x, y);
+            }
+
+            if(BIT_TEST(world->bits.food, x, y) != 0)
+            {
+                hash ^= CELL_KEY(HASH_FOOD, 0, x, y);
+            }
+
+            if(BIT_TEST(world->bits.suddenDeath, x, y) != 0)
+            {
+                hash ^= CELL_KEY(HASH_SUDDEN_DEATH, 0, x, y);
+            }
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        hash ^= worldHashKey(HASH_DIR, i, world->snakes->dir[i]);
+        hash ^= worldHashKey(HASH_SCORE, i, world->players[i].score);
+    }
+
+    return hash;
+}
+
+//
+// Scores
+//
+
+static void setScore(struct world* world, int player, int score)
+{
+    world->hash ^= worldHashKey(HASH_SCORE, player, world->players[player].score) ^ worldHashKey(HASH_SCORE, player, score);
+    world->players[player].score = score;
+}
+
+static void addToCounter(int* counter, int amount)
+{
+    *counter = MIN_OF(*counter + amount, MAX_SCORE);
+    *counter = MAX_OF(*counter, MIN_SCORE);
+}
+
+// Call after changing any of a player's counters with the ones that changed.
+// The score is only recalculated if the game mode's score is made of them.
+static void scoreChanged(struct world* world, struct snake* player, int sources)
+{
+    struct options* gameOptions = &world->options;
+    int gameType = gameOptions->gameType;
+    int score = player->score;
+
+    if((SCORE_SOURCES[gameType] & sources) == 0)
+    {
+        return;
+    }
+
+    if(gameType == GAME_FREE_FOR_ALL || gameType == GAME_SCORE_ATTACK)
+    {
+        score = player->numApples + player->numKills - player->numDeaths;
+        score = MIN_OF(score, MAX_SCORE);
+        score = MAX_OF(score, MIN_SCORE);
+    }
+    else if(gameType == GAME_BATTLE_ROYALE)
+    {
+        score = gameOptions->maxLives - player->numDeaths;
+    }
+    else if(gameType == GAME_SURVIVOR)
+    {
+        score = player->currLength;
+    }
+    else if(gameType == GAME_KING_OF_THE_HILL)
+    {
+        score = player->maxLength;
+    }
+
+    if(score != player->score)
+    {
+        setScore(world, (int)(player - world->players), score);
+        world->scoreChanged = 1;
+    }
+}
+
+// Growth is paid off one segment per move by drawSnake(), so eating a
+// whole snake costs the same as eating an apple
+static void growSnake(struct world* world, int player, int amount)
+{
+    world->snakes->pendingGrowth[player] = MIN_OF(world->snakes->pendingGrowth[player] + amount, MAX_GROWTH);
+
+    addToCounter(&world->players[player].currLength, amount);
+    scoreChanged(world, &world->players[player], SCORE_LENGTH);
+}
+
+void worldClearScore(struct world* world)
+{
+    struct snake* players = world->players;
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        players[i].numApples = 0;
+        players[i].numDeaths = 0;
+        players[i].numPlayersEaten = 0;
+        players[i].numKills = 0;
+        players[i].currLength = 0;
+        players[i].maxLength = 0;
+        setScore(world, i, 0);
+
+        scoreChanged(world, &players[i], SCORE_ALL);
+    }
+
+    world->scoreChanged = 1;
+}
+
+//
+// Joining
+//
+
+int isAllowedToSpawn(struct world* world, struct snake* somePlayer)
+{
+    struct options* gameOptions = &world->options;
+
+    //
+    // Do not let the player spawn if:
+    // - they are playing a game type with lives and have run out
+    // - they didn't spawn in the first 30s a
+    //
+
+    switch(gameOptions->gameType)
+    {
+        case GAME_FREE_FOR_ALL:
+        case GAME_SURVIVOR:
+        case GAME_KING_OF_THE_HILL:
+        case GAME_SCORE_ATTACK:
+            // FFA, Survivor, and KOTH, SA always allow spawning
+            return 1;
+            break;
+
+        case GAME_BATTLE_ROYALE:
+
+            if(gameOptions->suddenDeath == 1)
+            {
+                // don't allow spawning in sudden death
+                return 0;
+            }
+
+            // don't allow spawning if the player is out of lives
+            if(somePlayer->numDeaths >= gameOptions->maxLives)
+            {
+                return 0;
+            }
+
+            return 1;
+            break;
+    }
+
+    return 0;
+}
+
+// returns 1 if the spawn point and the cells in front of it are empty
+static int spawnIsClear(struct world* world, const struct spawn_point* spawn)
+{
+    static const signed char STEP_X[4] = {0, 0, 1, -1};
+    static const signed char STEP_Y[4] = {-1, 1, 0, 0};
+    int x = spawn->x;
+    int y = spawn->y;
+
+    for(int i = 0; i <= SPAWN_RUNWAY; i++)
+    {
+        if(onBoard(x, y) == 0 || BIT_TEST(world->bits.bodies, x, y) != 0)
+        {
+            return 0;
+        }
+
+        x += STEP_X[spawn->dir];
+        y += STEP_Y[spawn->dir];
+    }
+
+    return 1;
+}
+
+static void initializePlayer(struct world* world, int player)
+{
+    struct snakes* snakes = world->snakes;
+    struct snake* somePlayer = &world->players[player];
+    const struct spawn_point* spawn = &g_Spawns[player];
+    struct location* head = NULL;
+
+    if(snakes->active[player] == 1 || isAllowedToSpawn(world, somePlayer) == 0)
+    {
+        return;
+    }
+
+    // someone is in the way, the player gets another go next tick
+    if(spawnIsClear(world, spawn) == 0)
+    {
+        return;
+    }
+
+    somePlayer->shape[0] = g_SnakeGlyphs[player];
+    somePlayer->shape[1] = '\0';
+
+    // the snake starts as its head, the other two segments grow in
+    // over the first two moves
+    head = (struct location*)malloc(sizeof(struct location));
+    head->next = NULL;
+    head->x = spawn->x;
+    head->y = spawn->y;
+    snakes->head[player] = head;
+    snakes->tail[player] = head;
+    snakes->pendingGrowth[player] = 2;
+    setDir(world, player, spawn->dir);
+
+    somePlayer->currLength = 3;
+    if(somePlayer->currLength > somePlayer->maxLength)
+    {
+        somePlayer->maxLength = somePlayer->currLength;
+    }
+
+    snakes->active[player] = 1;
+    snakes->dying[player] = 0;
+    somePlayer->everActive = 1;
+
+    scoreChanged(world, somePlayer, SCORE_LENGTH | SCORE_MAX_LENGTH);
+    world->scoreChanged = 1; // a new player shows up in the ranking
+
+    // Draw the starting position of the snake
+    put(world, spawn->x, spawn->y, g_SnakeGlyphs[player]);
+    boardClaim(world, spawn->x, spawn->y, player);
+    emit(world, EVENT_SPAWN, player, EVENT_NO_PLAYER, spawn->x, spawn->y);
+}
+
+//
+// Moving
+//
+
+static void drawSnake(struct world* world, int player, unsigned char control)
+{
+    struct snakes* snakes = world->snakes;
+    struct location* head = snakes->head[player];
+    struct location* tail = snakes->tail[player];
+    struct location* temp = NULL;
+    struct location* newHead = NULL;
+    int dir = snakes->dir[player];
+    int newX = 0;
+    int newY = 0;
+
+    // turn unless that would reverse into yourself
+    if((control & CONTROL_TURN) != 0 && (control & CONTROL_DIR) != (dir ^ 1))
+    {
+        dir = control & CONTROL_DIR;
+        setDir(world, player, dir);
+    }
+
+    // Calc snake's new position
+    newX = head->x;
+    newY = head->y;
+
+    if(dir == DIR_UP)
+    {
+        // up
+        newY--;
+    }
+    else if(dir == DIR_DOWN)
+    {
+        // down
+        newY++;
+    }
+    else if(dir == DIR_RIGHT)
+    {
+        // right
+        newX++;
+    }
+    else if(dir == DIR_LEFT)
+    {
+        // left
+        newX--;
+    }
+
+    if(snakes->pendingGrowth[player] > 0)
+    {
+        // still growing, the tail stays put and the head is a new segment
+        newHead = (struct location*)malloc(sizeof(struct location));
+        newHead->next = head;
+        snakes->pendingGrowth[player]--;
+    }
+    else if(head == tail)
+    {
+        // a single segment just moves
+        newHead = head;
+        put(world, newHead->x, newHead->y, ' ');
+        boardRelease(world, newHead->x, newHead->y, player);
+    }
+    else
+    {
+        // the old tail moves to the front to become the new head
+        temp = head;
+
+        // Temp will be second to last node
+        while(temp->next != tail)
+        {
+            temp = temp->next;
+        }
+
+        // Erase the old tail
+        newHead = tail;
+        put(world, newHead->x, newHead->y, ' ');
+        boardRelease(world, newHead->x, newHead->y, player);
+
+        temp->next = NULL;
+        snakes->tail[player] = temp;
+        newHead->next = head;
+    }
+
+    newHead->x = newX;
+    newHead->y = newY;
+    snakes->head[player] = newHead;
+
+    // draw new snake position
+    // draws only the new head
+    put(world, newX, newY, g_SnakeGlyphs[player]);
+}
+
+//
+// Collisions
+//
+
+// returns 1 if a head moving in dir went into a wall
+static int hitWall(struct world* world, struct location* head, int dir)
+{
+    int x = head->x;
+    int y = head->y;
+
+    // off the board entirely, only possible after leaving a pit the wrong way
+    if(onBoard(x, y) == 0 || BIT_TEST(world->bits.walls, x, y) != 0)
+    {
+        return 1;
+    }
+
+    // pits can only be left into the arena
+    if(BIT_TEST(world->bits.pits, x, y) != 0)
+    {
+        if(x < MIN_X)
+        {
+            return dir != DIR_RIGHT;
+        }
+
+        if(x > MAX_X)
+        {
+            return dir != DIR_LEFT;
+        }
+
+        if(y < MIN_Y)
+        {
+            return dir != DIR_DOWN;
+        }
+
+        return dir != DIR_UP;
+    }
+
+    return 0;
+}
+
+// returns 1 if x, y is the segment right behind the head
+static int isNeck(struct location* head, int x, int y)
+{
+    struct location* neck = head->next;
+
+    return neck != NULL && neck->x == x && neck->y == y;
+}
+
+// Other player killed you, reward him
+static void creditKill(struct world* world, int killer, int victim)
+{
+    struct location* head = world->snakes->head[victim];
+
+    addToCounter(&world->players[killer].numKills, 1);
+    scoreChanged(world, &world->players[killer], SCORE_KILLS);
+    emit(world, EVENT_KILL, killer, victim, head->x, head->y);
+}
+
+// player's head met other's head. If player is at least twice as big it eats
+// the other snake, otherwise player dies. Called once from each side, so two
+// snakes of similar size both die. What is eaten is added up in eats and
+// only grown once every pair is settled, so lengths don't change meanwhile.
+static void collideHeads(struct world* world, int player, int other, char* dies, int* eats)
+{
+    int length = world->players[player].currLength;
+    int otherLength = world->players[other].currLength;
+    struct location* head = world->snakes->head[player];
+
+    if(length >= otherLength * 2)
+    {
+        dies[other] = 1;
+        eats[player] += otherLength;
+        addToCounter(&world->players[player].numPlayersEaten, 1);
+        emit(world, EVENT_EATEN, player, other, head->x, head->y);
+        return;
+    }
+
+    dies[player] = 1;
+    creditKill(world, other, player);
+}
+
+//
+// Checks every head at once after all players have moved. Bodies are looked
+// up on the board, which has every segment except the heads that just moved,
+// and the new heads are bucketed by cell so heads meeting each other are
+// found without walking anyone's body. Only the per tick arrays in
+// world->snakes are read, plus the segment behind another snake's head when
+// a head lands on a body.
+//
+// Given the HEAD_* flags of a batch check, only the heads outside the arena
+// are tested against the walls and pits and only the heads that meet another
+// are bucketed. The rest can't hit a wall or share a cell, so out comes out
+// the same.
+//
+static void detectHeads(struct world* world, struct collisions* out, const unsigned char* flags)
+{
+    struct snakes* snakes = world->snakes;
+    int x = 0;
+    int y = 0;
+    int i = 0;
+    int j = 0;
+
+    memset(out, 0, sizeof(*out));
+
+    // bucket the heads that are still inside the walls
+    UNROLL_PLAYERS
+    for(i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 0)
+        {
+            continue;
+        }
+
+        if((flags == NULL || (flags[i] & HEAD_OUTSIDE) != 0) && hitWall(world, snakes->head[i], snakes->dir[i]) == 1)
+        {
+            out->wall[i] = 1;
+            continue;
+        }
+
+        out->firstHead[i] = i + 1;
+        if(flags == NULL || (flags[i] & HEAD_MEETS) != 0)
+        {
+            x = snakes->head[i]->x;
+            y = snakes->head[i]->y;
+            out->nextHead[i] = world->headAt[y][x];
+            world->headAt[y][x] = i + 1;
+        }
+    }
+
+    UNROLL_PLAYERS
+    for(i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 0 || out->wall[i] == 1)
+        {
+            continue;
+        }
+
+        x = snakes->head[i]->x;
+        y = snakes->head[i]->y;
+
+        // bodies, your own included. Running into the segment behind
+        // another snake's head is a head-on collision.
+        if(BIT_TEST(world->bits.bodies, x, y) != 0)
+        {
+            j = world->board[y][x] - 1;
+            out->body[i] = j + 1;
+            out->neck[i] = j != i && isNeck(snakes->head[j], x, y);
+        }
+
+        if(flags == NULL || (flags[i] & HEAD_MEETS) != 0)
+        {
+            out->firstHead[i] = world->headAt[y][x];
+        }
+    }
+
+    UNROLL_PLAYERS
+    for(i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 1 && out->wall[i] == 0 && (flags == NULL || (flags[i] & HEAD_MEETS) != 0))
+        {
+            world->headAt[snakes->head[i]->y][snakes->head[i]->x] = 0;
+        }
+    }
+}
+
+void worldDetect(struct world* world, struct collisions* out)
+{
+    detectHeads(world, out, NULL);
+}
+
+void worldDetectChecked(struct world* world, struct collisions* out, const unsigned char* flags)
+{
+    detectHeads(world, out, flags);
+}
+
+//
+// Settles what worldDetect() found. Each pair of snakes that touch is
+// settled on its own from the lengths before anyone ate this tick, so the
+// outcome doesn't depend on player order.
+//
+static void applyCollisions(struct world* world, const struct collisions* found)
+{
+    struct snakes* snakes = world->snakes;
+    char dies[MAX_PLAYERS] = {0};
+    int eats[MAX_PLAYERS] = {0};
+    int x = 0;
+    int y = 0;
+    int i = 0;
+    int j = 0;
+
+    UNROLL_PLAYERS
+    for(i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 1 && found->wall[i] == 1)
+        {
+            snakes->dying[i] = 1;
+        }
+    }
+
+    UNROLL_PLAYERS
+    for(i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 0 || snakes->dying[i] == 1)
+        {
+            continue;
+        }
+
+        if(found->body[i] != BOARD_EMPTY)
+        {
+            j = found->body[i] - 1;
+            if(found->neck[i] == 1)
+            {
+                collideHeads(world, i, j, dies, eats);
+            }
+            else
+            {
+                dies[i] = 1;
+                if(j != i)
+                {
+                    creditKill(world, j, i);
+                }
+            }
+        }
+
+        // heads that moved into the same cell
+        for(j = found->firstHead[i] - 1; j >= 0; j = found->nextHead[j] - 1)
+        {
+            if(j != i)
+            {
+                collideHeads(world, i, j, dies, eats);
+            }
+        }
+    }
+
+    // survivors' heads join the board
+    UNROLL_PLAYERS
+    for(i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 0 || snakes->dying[i] == 1)
+        {
+            continue;
+        }
+
+        x = snakes->head[i]->x;
+        y = snakes->head[i]->y;
+
+        // consume the snakes it ate
+        if(eats[i] > 0)
+        {
+            growSnake(world, i, eats[i]);
+        }
+
+        if(dies[i] == 1)
+        {
+            snakes->dying[i] = 1;
+        }
+        else
+        {
+            boardClaim(world, x, y, i);
+        }
+    }
+}
+
+static void killPlayer(struct world* world, int player)
+{
+    struct snakes* snakes = world->snakes;
+    struct snake* somePlayer = &world->players[player];
+
+    emit(world, EVENT_DEATH, player, EVENT_NO_PLAYER, snakes->head[player]->x, snakes->head[player]->y);
+
+    // erase Snake
+    eraseSnake(world, snakes->head[player], player);
+    snakes->head[player] = NULL;
+    snakes->tail[player] = NULL;
+    snakes->pendingGrowth[player] = 0;
+
+    snakes->active[player] = 0;
+    snakes->dying[player] = 0;
+    setDir(world, player, 0);
+
+    // You died, so increase your deaths
+    addToCounter(&somePlayer->numDeaths, 1);
+    somePlayer->currLength = 0;
+
+    scoreChanged(world, somePlayer, SCORE_DEATHS | SCORE_LENGTH);
+}
+
+//
+// Sudden death
+//
+
+static void changeSuddenDeathDir(struct sudden_death_grid* deathGrid)
+{
+    switch(deathGrid->dir)
+    {
+        case DIR_DOWN:
+            deathGrid->dir = DIR_RIGHT;
+            break;
+        case DIR_UP:
+            deathGrid->dir = DIR_LEFT;
+            break;
+        case DIR_LEFT:
+            deathGrid->dir = DIR_DOWN;
+            break;
+        case DIR_RIGHT:
+            deathGrid->dir = DIR_UP;
+            break;
+    }
+}
+
+static void drawSuddenDeathGrid(struct world* world)
+{
+    struct sudden_death_grid* deathGrid = &world->deathGrid;
+    int newX = 0;
+    int newY = 0;
+
+    // check if this is the first time we are calling this
+    if(deathGrid->count == 0)
+    {
+        deathGrid->dir = DIR_DOWN;
+        deathGrid->lastX = 0;
+        deathGrid->lastY = -1;
+    }
+
+    switch(deathGrid->dir)
+    {
+        case DIR_DOWN:
+            newX = deathGrid->lastX;
+            newY = deathGrid->lastY + 1;
+            break;
+        case DIR_UP:
+            newX = deathGrid->lastX;
+            newY = deathGrid->lastY - 1;
+            break;
+        case DIR_LEFT:
+            newX = deathGrid->lastX - 1;
+            newY = deathGrid->lastY;
+            break;
+        case DIR_RIGHT:
+            newX = deathGrid->lastX + 1;
+            newY = deathGrid->lastY;
+            break;
+    }
+
+    if(newX < 0 || newX > MAX_X - MIN_X)
+    {
+        changeSuddenDeathDir(deathGrid);
+        return;
+    }
+
+    if(newY < 0 || newY > MAX_Y - MIN_Y)
+    {
+        changeSuddenDeathDir(deathGrid);
+        return;
+    }
+
+    if(deathGrid->grid[newX][newY] == 'X')
+    {
+        // grid is occupied, try again
+        changeSuddenDeathDir(deathGrid);
+        return;
+    }
+
+    deathGrid->grid[newX][newY] = 'X';
+    BIT_SET(world->bits.suddenDeath, newX + MIN_X, newY + MIN_Y);
+    world->hash ^= CELL_KEY(HASH_SUDDEN_DEATH, 0, newX + MIN_X, newY + MIN_Y);
+
+    deathGrid->lastX = newX;
+    deathGrid->lastY = newY;
+
+    put(world, deathGrid->lastX + MIN_X, deathGrid->lastY + MIN_Y, 'X');
+    emit(world, EVENT_SUDDEN_DEATH_CELL, EVENT_NO_PLAYER, EVENT_NO_PLAYER, deathGrid->lastX + MIN_X, deathGrid->lastY + MIN_Y);
+    deathGrid->count++;
+}
+
+static void checkForSuddenDeathCollisions(struct world* world)
+{
+    struct options* gameOptions = &world->options;
+
+    if(gameOptions->gameType != GAME_BATTLE_ROYALE || gameOptions->suddenDeath != 1)
+    {
+        return;
+    }
+
+    UNROLL_PLAYERS
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        struct snakes* snakes = world->snakes;
+
+        if(snakes->active[i] == 0 || snakes->dying[i] == 1)
+        {
+            continue;
+        }
+
+        // only arena cells are closed, so snakes still in a pit are safe
+        if(BIT_TEST(world->bits.suddenDeath, snakes->head[i]->x, snakes->head[i]->y) != 0)
+        {
+            snakes->dying[i] = 1;
+        }
+    }
+}
+
+//
+// Food
+//
+
+// returns a 1 if x, y is a "safe" place for food
+static int safeFood(struct world* world, int x, int y)
+{
+    // snakes and food already on the field
+    return ((world->bits.bodies[y] | world->bits.food[y]) & BIT_AT(x)) == 0;
+}
+
+// the world's own xorshift if it has one, so matches stepped side by side
+// don't take each other's numbers
+static int nextRandom(struct world* world)
+{
+    unsigned int state = 0;
+
+    if(world->random == NULL)
+    {
+        return rand();
+    }
+
+    state = *world->random;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    *world->random = state;
+
+    return (int)(state >> 1);
+}
+
+// adds an item in a random safe cell
+static void placeFood(struct world* world)
+{
+    struct food* theFood = &world->food;
+    struct food_item* item = &theFood->items[theFood->count];
+
+    do{
+        item->x = (nextRandom(world)%(MAX_X - MIN_X + 1)) + MIN_X;
+        item->y = (nextRandom(world)%(MAX_Y - MIN_Y + 1)) + MIN_Y;
+    }while(safeFood(world, item->x, item->y) != 1);
+
+    theFood->cell[item->y][item->x] = theFood->count;
+    theFood->count++;
+    BIT_SET(world->bits.food, item->x, item->y);
+    world->hash ^= CELL_KEY(HASH_FOOD, 0, item->x, item->y);
+
+    put(world, item->x, item->y, theFood->shape[0]);
+}
+
+// takes an item off the field, the last item fills its slot
+static void removeFood(struct world* world, int item)
+{
+    struct food* theFood = &world->food;
+    struct food_item* eaten = &theFood->items[item];
+
+    theFood->cell[eaten->y][eaten->x] = FOOD_NONE;
+    BIT_CLEAR(world->bits.food, eaten->x, eaten->y);
+    world->hash ^= CELL_KEY(HASH_FOOD, 0, eaten->x, eaten->y);
+    theFood->count--;
+
+    if(item != theFood->count)
+    {
+        *eaten = theFood->items[theFood->count];
+        theFood->cell[eaten->y][eaten->x] = item;
+    }
+}
+
+static void initializeFood(struct world* world, char theShape)
+{
+    struct food* theFood = &world->food;
+
+    // Shape of the food
+    theFood->shape[0] = theShape;
+    theFood->shape[1] = '\0';
+
+    while(theFood->count > 0)
+    {
+        removeFood(world, theFood->count - 1);
+    }
+    memset(theFood->cell, FOOD_NONE, sizeof(theFood->cell));
+    memset(world->bits.food, 0, sizeof(world->bits.food));
+
+    // more is added as players join
+    placeFood(world);
+}
+
+//
+// Feeds every snake whose head is on food, then tops the field back up to
+// one item for the first player and one more for every PLAYERS_PER_FOOD
+// after that. Food eaten this tick is replaced in that one pass.
+//
+static void drawFood(struct world* world)
+{
+    struct snakes* snakes = world->snakes;
+    struct snake* players = world->players;
+    struct food* theFood = &world->food;
+    struct location* temp = NULL;
+    int numActive = 0;
+    int target = 0;
+    int item = 0;
+    int i = 0;
+
+    UNROLL_PLAYERS
+    for(i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 1)
+        {
+            numActive++;
+            temp = snakes->head[i];
+
+            // check if there was a collision
+            item = theFood->cell[temp->y][temp->x];
+            if(item != FOOD_NONE)
+            {
+                emit(world, EVENT_APPLE, i, EVENT_NO_PLAYER, temp->x, temp->y);
+                removeFood(world, item);
+
+                // Add a new segment, make that segment the tail
+                growSnake(world, i, 1);
+
+                // You ate the apple, increase your score
+                addToCounter(&players[i].numApples, 1);
+
+                if(players[i].currLength > players[i].maxLength)
+                {
+                    players[i].maxLength = players[i].currLength;
+                }
+
+                scoreChanged(world, &players[i], SCORE_APPLES | SCORE_MAX_LENGTH);
+            }
+        }
+    }
+
+    target = 1;
+    if(numActive > 1)
+    {
+        target += (numActive - 1) / PLAYERS_PER_FOOD;
+    }
+    if(target > MAX_FOOD)
+    {
+        target = MAX_FOOD;
+    }
+
+    // items left over after players leave stay until they're eaten
+    while(theFood->count < target)
+    {
+        placeFood(world);
+    }
+}
+
+//
+// Matches
+//
+
+void worldReset(struct world* world)
+{
+    struct snakes* snakes = world->snakes != NULL ? world->snakes : &world->ownSnakes;
+    void (*savedPut)(int x, int y, char glyph) = world->put;
+    void (*savedStart)(struct world* world, struct collisions* out) = world->startDetect;
+    void (*savedWait)(struct world* world, struct collisions* out) = world->waitDetect;
+    struct event_ring* savedEvents = world->events;
+    unsigned int* savedRandom = world->random;
+
+    // snakes left over from the last match
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 1)
+        {
+            eraseSnake(world, snakes->head[i], i);
+        }
+    }
+
+    memset(world, 0, sizeof(*world));
+    memset(snakes, 0, sizeof(*snakes));
+    world->snakes = snakes;
+    world->put = savedPut;
+    world->startDetect = savedStart;
+    world->waitDetect = savedWait;
+    world->events = savedEvents;
+    world->random = savedRandom;
+    world->hash = worldRehash(world);
+
+    bitboardInit(&world->bits);
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(g_Spawns[i].pit == 1)
+        {
+            bitboardAddPit(&world->bits, g_Spawns[i].x, g_Spawns[i].y);
+        }
+    }
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        world->players[i].ID = i;
+    }
+}
+
+void worldStart(struct world* world)
+{
+    worldClearScore(world); // scores depend on the game mode
+    initializeFood(world, '*');
+}
+
+void worldMove(struct world* world, const unsigned char* controls)
+{
+    struct snakes* snakes = world->snakes;
+
+    eventRingSetTick(eventSink(world), world->options.tick);
+
+    // join, then move
+    UNROLL_PLAYERS
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if((controls[i] & CONTROL_JOIN) != 0 && snakes->active[i] == 0)
+        {
+            initializePlayer(world, i);
+        }
+
+        if(snakes->active[i] == 1)
+        {
+            drawSnake(world, i, controls[i]);
+        }
+    }
+}
+
+// the rest of the tick once the heads are checked
+static int settle(struct world* world)
+{
+    struct snakes* snakes = world->snakes;
+    int died = 0;
+    int i = 0;
+
+    applyCollisions(world, &world->collisions);
+
+    if(world->options.suddenDeath == 1)
+    {
+        checkForSuddenDeathCollisions(world);
+    }
+
+    //
+    // Kill snakes that are marked for death
+    //
+    UNROLL_PLAYERS
+    for(i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(snakes->active[i] == 1 && snakes->dying[i] == 1)
+        {
+            killPlayer(world, i);
+            died = 1;
+        }
+    }
+
+    drawFood(world);
+
+    world->options.tick++;
+    return died;
+}
+
+int worldSettle(struct world* world)
+{
+    if(world->options.suddenDeath == 1)
+    {
+        drawSuddenDeathGrid(world);
+    }
+
+    return settle(world);
+}
+
+int worldStep(struct world* world, const unsigned char* controls)
+{
+    worldMove(world, controls);
+
+    //
+    // After all players have moved, check for collisions. Sudden death
+    // doesn't touch anything worldDetect() reads, so it's drawn meanwhile.
+    //
+    if(world->startDetect != NULL)
+    {
+        world->startDetect(world, &world->collisions);
+    }
+    else
+    {
+        worldDetect(world, &world->collisions);
+    }
+
+    if(world->options.suddenDeath == 1)
+    {
+        drawSuddenDeathGrid(world);
+    }
+
+    if(world->waitDetect != NULL)
+    {
+        world->waitDetect(world, &world->collisions);
+    }
+
+    return settle(world);
+}
+
+int worldPlayersRemaining(struct world* world)
+{
+    struct snake* players = world->players;
+    int count = 0;
+
+    UNROLL_PLAYERS
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        // if the player is alive currently, count them
+        if(world->snakes->active[i] == 1)
+        {
+            count++;
+            continue;
+        }
+
+        // if the player was ever active, but still has lives count them as alive
+        if(players[i].everActive == 1 && isAllowedToSpawn(world, &players[i]) == 1)
+        {
+            count++;
+            continue;
+        }
+    }
+
+    return count;
+}
+
+int worldLeader(struct world* world)
+{
+    struct snake* players = world->players;
+    int leader = EVENT_NO_PLAYER;
+
+    for(int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if(players[i].everActive == 0)
+        {
+            continue;
+        }
+
+        if(leader == EVENT_NO_PLAYER || players[i].score > players[leader].score)
+        {
+            leader = i;
+        }
+    }
+
+    return leader;
+}
+
+int worldReachable(struct world* world, int player)
+{
+    struct location* head = world->snakes->head[player];
+
+    if(world->snakes->active[player] == 0)
+    {
+        return 0;
+    }
+
+    return bitboardReachable(&world->bits, head->x, head->y);
+}
@@ -0,0 +1,170 @@
+/*
+Twelve Snakes - the rules of a match
+
+Everything that happens on the playing field: joining, moving, collisions,
+food, sudden death and the scores they feed. jo_main() turns pads into
+controls and runs one worldStep() per tick; the Linux tools in host/ run the
+same code without a Saturn.
+
+Nothing in here touches the screen. Cells are drawn through the world's put
+callback, headless builds leave it NULL.
+
+Spawn points and glyphs are generated from MAX_PLAYERS and the arena bounds
+in game.h. Spawn points go in rings around the arena: the first ring is the
+pits in the walls, the next ones just inside the walls and further in, so
+any player count gets a place to start.
+*/
+
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "bitboard.h"
+#include "game.h"
+
+struct event_ring;
+
+// counters a game mode's score is made of, see scoreChanged()
+#define SCORE_APPLES     0x01
+#define SCORE_KILLS      0x02
+#define SCORE_DEATHS     0x04
+#define SCORE_LENGTH     0x08
+#define SCORE_MAX_LENGTH 0x10
+#define SCORE_ALL        0x1F
+
+// what checking the heads of a batch of matches at once tells
+// worldDetectChecked() about each head, see host/headcheck.h
+#define HEAD_OUTSIDE 0x01 // outside the arena walls, maybe in a pit
+#define HEAD_MEETS   0x02 // another head is in the same cell
+#define HEAD_ON_FOOD 0x04 // drawFood() still looks the cell up itself
+
+// one control byte per player per tick
+#define CONTROL_DIR  0x03 // DIR_* to turn to if CONTROL_TURN is set
+#define CONTROL_TURN 0x04
+#define CONTROL_JOIN 0x08
+#define CONTROL_NONE 0x00
+
+// what the state hash is made of, see worldHashKey()
+#define HASH_BODY         0 // value is the cell, y * BOARD_WIDTH + x
+#define HASH_FOOD         1 // value is the cell, player is ignored
+#define HASH_SUDDEN_DEATH 2 // value is the cell, player is ignored
+#define HASH_DIR          3 // value is the DIR_*
+#define HASH_SCORE        4 // value is the score
+
+#define PITS_PER_SIDE 3
+#define SPAWN_PITCH_X 10 // the score bar is in 10 column blocks, the pits go between them
+#define SPAWN_PITCH_Y 6
+#define SPAWN_RUNWAY 3 // cells in front of a spawn point that have to be free
+
+struct spawn_point
+{
+    unsigned char x;
+    unsigned char y;
+    unsigned char dir;
+    unsigned char pit; // in the wall, drawGrid() draws a pit around it
+};
+
+// the cells around a pit, by the direction snakes leave it in
+#define PIT_CELLS 6
+
+struct pit_cell
+{
+    signed char dx;
+    signed char dy;
+    char glyph; // the wall glyphs drawGrid() uses, 21 to 26
+};
+
+// The state of every snake that each tick reads, one array per field indexed
+// by player. A loop over all the players only pulls in the fields it tests,
+// not the scores in struct snake.
+struct snakes
+{
+    struct location* head[MAX_PLAYERS];
+    struct location* tail[MAX_PLAYERS];
+    int pendingGrowth[MAX_PLAYERS]; // segments still to grow, one per move, up to MAX_GROWTH
+    unsigned char dir[MAX_PLAYERS]; // current direction snake is moving in
+    unsigned char active[MAX_PLAYERS]; // Is this player playing or not
+    unsigned char dying[MAX_PLAYERS]; // Is player marked for death?
+};
+
+// What every head moved into this tick, found by worldDetect() before
+// worldStep() settles who dies, eats or gets the kill
+struct collisions
+{
+    unsigned char wall[MAX_PLAYERS]; // hit a wall or left a pit the wrong way
+    unsigned char body[MAX_PLAYERS]; // owner + 1 of the body cell it moved into, BOARD_EMPTY if none
+    unsigned char neck[MAX_PLAYERS]; // that cell was the segment right behind the owner's head
+    unsigned char firstHead[MAX_PLAYERS]; // first player + 1 with a head in the same cell
+    unsigned char nextHead[MAX_PLAYERS]; // next player + 1 with a head in the same cell
+};
+
+struct world
+{
+    // worldReset() points this at ownSnakes unless it already points
+    // somewhere else, so a batch of matches can keep the state of all of
+    // their snakes together, see host/gym.h
+    struct snakes* snakes;
+    struct snakes ownSnakes;
+    struct snake players[MAX_PLAYERS];
+    struct food food;
+    struct options options;
+    struct sudden_death_grid deathGrid;
+    struct bitboard bits; // what is in each cell
+    unsigned char board[BOARD_HEIGHT][BOARD_WIDTH]; // owner of every body segment, see BOARD_EMPTY
+    unsigned char headAt[BOARD_HEIGHT][BOARD_WIDTH]; // first head in each cell while worldDetect() runs
+    int scoreChanged; // a score or the set of players changed, the score bar clears it
+    unsigned long long hash; // of the bodies, food, sudden death, directions and scores, see worldRehash()
+
+    struct collisions collisions; // this tick's, see worldDetect()
+
+    void (*put)(int x, int y, char glyph); // draws a cell, NULL when headless
+    struct event_ring* events; // where the rules emit, NULL for g_Events
+    unsigned int* random; // xorshift state food is placed with, NULL for rand()
+
+    // run worldDetect() on another CPU, the slave SH-2 on the Saturn.
+    // worldStep() starts it, draws sudden death and then waits for it.
+    // NULL runs it inline.
+    void (*startDetect)(struct world* world, struct collisions* out);
+    void (*waitDetect)(struct world* world, struct collisions* out);
+};
+
+extern const int SCORE_SOURCES[NUM_GAME_TYPES];
+extern const struct spawn_point* const g_Spawns; // MAX_PLAYERS of them
+extern const char* const g_SnakeGlyphs; // MAX_PLAYERS of them
+extern const struct pit_cell PIT_SHAPES[4][PIT_CELLS]; // by DIR_*
+
+void worldInit(); // builds the spawn and glyph tables, once at boot
+void worldReset(struct world* world); // new match, before the options are picked
+void worldStart(struct world* world); // after the options are picked
+int worldStep(struct world* world, const unsigned char* controls); // one tick, returns 1 if a snake died
+
+// worldStep() in three parts, for stepping a batch of matches with the heads
+// of all of them checked in between (host/gym.c): worldMove(), then
+// worldDetectChecked() or worldDetect() into world->collisions, then
+// worldSettle(), which returns what worldStep() does.
+void worldMove(struct world* world, const unsigned char* controls);
+int worldSettle(struct world* world);
+
+// Fills out from the board after the snakes moved. Reads the heads, the
+// segments behind them, the wall, pit and body masks and the owner board and
+// writes nothing but out and headAt, which it leaves empty again.
+void worldDetect(struct world* world, struct collisions* out);
+
+// worldDetect() for heads already checked together with other matches' heads,
+// flags has one HEAD_* per player and only the flagged heads get looked at
+// further. Gives the same out as worldDetect() if the flags are right.
+void worldDetectChecked(struct world* world, struct collisions* out, const unsigned char* flags);
+
+// Zobrist keys, made on the fly rather than kept in a table. The world's
+// hash is the XOR of the keys of everything in it and is kept up to date a
+// changed cell, direction or score at a time. Two worlds that played the
+// same ticks have the same hash.
+unsigned long long worldHashKey(int kind, int player, int value);
+unsigned long long worldRehash(const struct world* world); // from scratch, what world->hash should be
+
+void worldClearScore(struct world* world);
+int worldPlayersRemaining(struct world* world);
+int worldLeader(struct world* world); // EVENT_NO_PLAYER if nobody played
+int worldReachable(struct world* world, int player); // cells the snake can still get to, 0 if it isn't playing
+int isAllowedToSpawn(struct world* world, struct snake* somePlayer);
+
+#endif